@@ -7,7 +7,8 @@
 %  spatial_sigma: sigma of the Gaussian spatial weight
 %  tonal_sigma:   sigma of the Gaussian tonal weight
 %  truncation:    at how many sigma to truncate the Gaussians
-%  method:        one of 'full', 'xysep', 'uvsep', 'arc', 'pwlinear'
+%  method:        one of 'full', 'xysep', 'uvsep', 'arc', 'pwlinear', 'grid',
+%                 'lattice'
 %  boundary_condition: Defines how the boundary of the image is handled.
 %                      See HELP BOUNDARY_CONDITION
 %
@@ -28,6 +29,14 @@
 %  'pwlinear' uses a piece-wise linear approximation to the bilateral
 %  filter, is fast for larger spatial sigmas (Durand and Dorsey).
 %
+%  'grid' uses the bilateral grid, a subsampled space with an extra
+%  dimension for intensity, its cost decreases with increasing sigmas
+%  (Paris and Durand).
+%
+%  'lattice' uses the permutohedral lattice, and computes the tonal
+%  distance over all channels jointly. Use this for color images, it
+%  doesn't produce false colors (Adams et al.).
+%
 %  'uvsep' and 'arc' haven't been implemented yet.
 %
 % LITERATURE:
@@ -37,6 +46,10 @@
 %    Conference on Multimedia and Expo, 2005.
 %  F. Durand and J. Dorsey, "Fast bilateral filtering for the display of high-dynamic-range images,"
 %    ACM Transactions on Graphics 21(3), 2002.
+%  S. Paris and F. Durand, "A fast approximation of the bilateral filter using a signal processing approach,"
+%    International Journal of Computer Vision 81(1):24-52, 2009.
+%  A. Adams, J. Baek and M.A. Davis, "Fast high-dimensional filtering using the permutohedral lattice,"
+%    Computer Graphics Forum 29(2):753-762, 2010.
 %
 % SEE ALSO:
 %  arcf, pmd
@@ -24,6 +24,9 @@
 %       element, leading to a width-based size distribution.
 %     - 'length':    uses path openings or closings, leading to a length-based
 %       size distribution.
+%     - 'area':      uses area openings or closings, leading to an area-based
+%       size distribution. A scale corresponds to the area of a disk with
+%       that diameter. All scales are computed at once, this is fast.
 %  polarity: 'closing' or 'opening'. 'dark' and 'light' are supported for
 %     backwards compatibility. 'closing' analyzes dark objects on a light
 %     background, 'opening' analyzes light objects on a dark background.
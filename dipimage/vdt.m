@@ -6,7 +6,7 @@
 % PARAMETERS:
 %  edgeCondition: the value of pixels outside the image bounds,
 %      can be 'background' or 'object', or equivalently 0 or 1.
-%  method: 'fast', 'ties', 'true', 'brute force'
+%  method: 'separable', 'fast', 'ties', 'true', 'brute force'
 %
 % DEFAULTS:
 %  edgeCondition = 'object'
@@ -676,6 +676,8 @@ inline ImageArray MonogenicSignalAnalysis(
 /// a subset of points, with all possible pairs along all image axes; the actual number of pairs
 /// is approximate. In general, the grid method needs a lot more probes to be precise, but
 /// it is faster for a given number of probes because it uses sequential memory access.
+/// Both methods distribute the probes over multiple threads. The random sampling method always uses the
+/// same random points, independently of the number of threads.
 ///
 /// `options` can contain one or more of the following strings:
 /// - `"covariance"`: Compute covariance instead of correlation.
@@ -774,7 +776,8 @@ DIP_EXPORT Distribution Semivariogram(
 /// with each integer value encoding a phase (note that 0 is included here).
 ///
 /// Optionally a `mask` image can be provided to select which pixels in `object`
-/// should be used for the estimation.
+/// should be used for the estimation. Chords end at the mask boundary, the parts of the lines
+/// outside the mask are not counted.
 ///
 /// `probes` specifies how many random lines should be drawn to estimate the distribution.
 /// `length` specifies the maximum chord length in pixels.
@@ -847,6 +850,10 @@ DIP_EXPORT Distribution DistanceDistribution(
 ///  - `"isotropic"`: An isotropic SE leads to a size distribution dictated by the width of objects.
 ///  - `"length"`: A line SE leads to a size distribution dictated by the length of objects. We use (constrained)
 ///    path openings or closings (see Luengo, 2010).
+///  - `"area"`: Area openings or closings lead to a size distribution dictated by the area (volume in 3D) of
+///    objects, irrespective of their shape. A scale `s` corresponds to the area of a disk (ball) with diameter `s`.
+///    All scales are computed at once from the max-tree (min-tree for closings) of the image, which is much faster
+///    than the other types when many scales are requested. Objects are connected using a connectivity of 1.
 ///
 /// The `polarity` flag determines whether it is white objects on a black background (`"opening"`) or black objects
 /// on a white background (`"closing"`) that are being analyzed.
@@ -868,6 +875,7 @@ DIP_EXPORT Distribution DistanceDistribution(
 ///        of the measurement, but is a little bit more expensive (see Luengo, 2010). This option causes the use
 ///        of normal path openings or closings.
 ///      - `"robust"`: applies path openings or closings in such a way that they are less sensitive to noise.
+///  - For `"area"` granulometries, no options are allowed.
 ///
 /// `scales` defaults to a series of 12 values geometrically spaced by `sqrt(2)`, and starting at `sqrt(2)`. `scales`
 /// are in pixels, the image's pixel size is not taken into account.
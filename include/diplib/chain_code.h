@@ -880,7 +880,11 @@ using ChainCodeArray = std::vector< ChainCode >;
 /// only part of it is found. The chain code traces the outer perimeter of the object, holes are ignored.
 ///
 /// `objectIDs` is a list with object IDs present in the labeled image. If an empty array is given, all objects in
-/// the image are used.
+/// the image are used. The output array has one element per element in `objectIDs`, in the same order. Elements
+/// for object IDs not present in the image (and for repeated IDs) are empty chain codes.
+///
+/// The start pixels for all objects are found in a single, multi-threaded pass over the image, after which the
+/// objects are traced in parallel.
 ChainCodeArray DIP_EXPORT GetImageChainCodes(
       Image const& labels,                   ///< Labeled image, unsigned integer type
       UnsignedArray const& objectIDs = {},   ///< A list of object IDs to get chain codes for
@@ -212,6 +212,9 @@ class DIP_NO_EXPORT ColorSpaceManager {
       /// but the result is cast to 8-bit unsigned integers when written to the output image. Some color spaces,
       /// such as RGB and CMYK are defined to use the [0,255] range of 8-bit unsigned integers. Other color spaces
       /// such as Lab and XYZ are not. For those color spaces, casting to an integer will destroy the data.
+      ///
+      /// If enabled through `UseLookupTable`, 8-bit images with three channels (such as RGB or nlRGB) are
+      /// converted through an interpolated look-up table instead.
       DIP_EXPORT void Convert( Image const& in, Image& out, String const& colorSpaceName = "" ) const;
       Image Convert( Image const& in, String const& colorSpaceName = "" ) const {
          Image out;
@@ -259,11 +262,34 @@ class DIP_NO_EXPORT ColorSpaceManager {
          SetWhitePoint( triplet );
       }
 
+      /// \brief Enables or disables the use of a look-up table when converting 8-bit, 3-channel images.
+      ///
+      /// When enabled, `Convert` computes the conversion for input images of type `dip::DT_UINT8` with
+      /// three channels only on a regular grid of 52&times;52&times;52 input values (every 5th gray level
+      /// along each channel), and trilinearly interpolates in this table for each pixel. The output is then
+      /// always of type `dip::DT_SFLOAT`. The cost of the conversion becomes independent of the length of the
+      /// conversion path, which makes, for example, converting a video frame from sRGB to Lab several times
+      /// faster. The table is built anew at each call to `Convert`, so it is not used for images that have
+      /// fewer pixels than the grid has nodes. It is also not used when converting to a color space with
+      /// a hue angle ("HSI", "HCV", "HSV" and "LCH"), as the hue cannot be interpolated across its
+      /// discontinuity. Color spaces defined through `Define` are assumed not to have such a discontinuity.
+      ///
+      /// The result is an approximation to the exact conversion. For sRGB to Lab, the maximum error over all
+      /// 256&times;256&times;256 input colors is 0.19 units (in a\*). By default, the look-up table is not used.
+      ///
+      /// This setting applies to this `%ColorSpaceManager` object only. In PyDIP there is a single, module-wide
+      /// object, so `dip.ColorSpaceManager.UseLookupTable` changes the behavior of all color conversions in the
+      /// process, including those in `dip.ImageDisplay`.
+      void UseLookupTable( bool enable = true ) {
+         useLookupTable_ = enable;
+      }
+
    private:
 
       struct ColorSpace {
          String name;
          dip::uint nChannels;
+         bool hasHue = false; // Set for color spaces with an angle channel, which cannot be interpolated
          std::map< dip::uint, ColorSpaceConverterPointer > edges;  // The key is the target color space index
          ColorSpace( String const& name, dip::uint chans ) :
                name( name ), nChannels( chans ) {}
@@ -271,6 +297,7 @@ class DIP_NO_EXPORT ColorSpaceManager {
 
       std::map< String, dip::uint > names_;
       std::vector< ColorSpace > colorSpaces_;
+      bool useLookupTable_ = false;
 
       dip::uint Index( String const& name ) const {
          auto it = names_.find( name );
@@ -60,6 +60,9 @@ namespace dip {
 ///
 /// `range` must be empty, or have exactly two elements representing the minimum and maximum radius to
 /// be considered. If empty, the minimum radius is 0, and the maximum is the length of the image diagonal.
+///
+/// The votes are distributed over multiple threads, each accumulating into its own copy of the parameter
+/// space. These copies are summed at the end.
 DIP_EXPORT void HoughTransformCircleCenters(
       Image const& in,
       Image const& gv,
@@ -148,6 +151,12 @@ using RadonCircleParametersArray = std::vector< RadonCircleParameters >;
 /// - `"subpixel projection"`: Idem, but the argmax is computed with sub-pixel precision. It computes 3 slices along
 ///   *r* at the time, and looks for local maxima along the *r* axis by fitting a parabola to the the 3 samples.
 ///
+/// The two projection modes compute the parameter space one *r* slice at the time, keeping only the running
+/// maximum and argmax. Their memory usage thus does not depend on the number of radii probed, whereas the
+/// `"full"` mode requires memory proportional to `radii.Size()` times the size of `in`. Use one of the
+/// projection modes when probing a large range of radii. Note that these modes find a single circle for
+/// each origin.
+///
 /// The parameter `options` can contain the following values:
 /// - `"normalize"`: Normalizes the integral over the template for each *r*, so that larger circles don't have a
 ///   larger maximum. This prevents a bias towards larger circles.
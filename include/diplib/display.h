@@ -21,6 +21,8 @@
 #ifndef DIP_DISPLAY_H
 #define DIP_DISPLAY_H
 
+#include <map>
+
 #include "diplib.h"
 #include "diplib/color.h"
 
@@ -51,6 +53,10 @@ namespace dip {
 /// to RGB, and RGB output image is produced. For other tensor images, an RGB image is also produced, the user
 /// can select which tensor element is shown in each of the three color channels.
 ///
+/// Projections and intensity limits are cached: returning to a projection mode and direction, or to a slice,
+/// that was shown before does not require these to be recomputed. Because the object shares the pixel data
+/// with the image given to the constructor, `InputChanged` must be called if those pixel values are modified.
+///
 /// See the `dipimage/private/imagedisplay.cpp` file implementing the MATLAB interface to this class, and the
 /// `dipimage/dipshow.m` function, for an example of how this can be used.
 class DIP_NO_EXPORT ImageDisplay {
@@ -178,6 +184,11 @@ class DIP_NO_EXPORT ImageDisplay {
          return output_;
       }
 
+      /// \brief Notifies the object that the pixel values of the input image have been modified.
+      ///
+      /// Discards all cached projections and intensity limits, the next call to `Output` will recompute them.
+      DIP_EXPORT void InputChanged();
+
       /// \brief Puts a single pixel through the same mapping the image will go through to become `Output`.
       DIP_EXPORT Image::Pixel MapSinglePixel( Image::Pixel const& input );
 
@@ -570,6 +581,15 @@ class DIP_NO_EXPORT ImageDisplay {
       std::array< LimitsLists, 4 > sliceLimits_;  // Limits to use when !globalStretch_
       std::array< LimitsLists, 4 > globalLimits_; // Limits to use when globalStretch_
 
+      // Caches, so that going back to a previously shown projection or slice doesn't recompute anything:
+      //    projectionCache_[ { mode, dim1, dim2 } ] -> the projection computed by `UpdateSlice` (before permuting
+      //                                              dimensions), for the MAX and MEAN projection modes.
+      //    sliceLimitsCache_[ SliceKey() ] -> the `sliceLimits_` computed for that slice.
+      // The caches are only emptied by `InputChanged`, as the input image cannot be replaced.
+      using SliceKeyType = std::vector< dip::sint >;
+      std::map< std::array< dip::uint, 3 >, Image > projectionCache_;
+      std::map< SliceKeyType, std::array< LimitsLists, 4 >> sliceLimitsCache_;
+
       bool IsComplex() { return image_.DataType().IsComplex(); }
       bool IsBinary() { return image_.DataType().IsBinary(); }
       bool IsInteger() { return image_.DataType().IsInteger(); }
@@ -580,6 +600,10 @@ class DIP_NO_EXPORT ImageDisplay {
 
       DIP_NO_EXPORT void InvalidateSliceLimits();
 
+      // Identifies the contents of `rgbSlice_`: the projection mode and direction, the tensor elements shown,
+      // and for the SLICE mode also the coordinates along the orthogonal dimensions.
+      DIP_NO_EXPORT SliceKeyType SliceKey() const;
+
       DIP_EXPORT void UpdateSlice();
       DIP_NO_EXPORT void UpdateRgbSlice();
       DIP_EXPORT void UpdateOutput();
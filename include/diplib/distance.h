@@ -73,7 +73,7 @@ namespace dip {
 ///    the separable algorithm is always fastest.
 ///
 ///    Individual vector components of the Euclidean distance transform can be obtained with
-///    `dip::VectorDistanceTransform`.
+///    `dip::VectorDistanceTransform`, which also implements the separable algorithm.
 ///
 ///  - A brute force algorithm that scales quadratically with the number of pixels. The results are always exact.
 ///    Use only with small images to determine a ground-truth result. For 2D and 3D inputs only.
@@ -113,7 +113,12 @@ inline Image EuclideanDistanceTransform(
 /// The norm of `out` is identical to the result of `dip::EuclideanDistanceTransform`.
 ///
 /// See `dip::EuclideanDistanceTransform` for detailed information about the parameters. Valid `method` strings are
-/// `"fast"`, `"ties"`, `"true"` and `"brute force"`. That is, `"separable"` or `"square"` are not allowed.
+/// `"separable"`, `"fast"`, `"ties"`, `"true"` and `"brute force"`. That is, `"square"` is not allowed.
+///
+/// The `"separable"` method follows the same algorithm as the `"separable"` method in
+/// `dip::EuclideanDistanceTransform`, but each pixel carries the vector to the nearest background pixel found
+/// so far, rather than only the square distance. It produces exact results, is parallelized, and works for
+/// images of any dimensionality. The other methods work with 2D and 3D images only.
 ///
 /// `in` should not have any dimension larger than 1e7 pixels, otherwise the vector components will underflow.
 DIP_EXPORT void VectorDistanceTransform(
@@ -148,10 +153,13 @@ inline Image VectorDistanceTransform(
 /// in the output, depending on whether `bin` was set or not. If `mask` is not forged, paths are not constrained.
 /// If `mask` is forged, it must be of the same sizes as `bin` and `grey`, and be binary and scalar.
 ///
-/// This function uses one of two algorithms: the fast marching algorithm (Sethian, 1996), or a simpler propagation
-/// algorithm that uses a chamfer metric (after work by Verwer and Strasters). `metric` is used only in the latter
-/// case. `mode` selects the algorithm used and what output is produced:
+/// This function uses one of three algorithms: the fast marching algorithm (Sethian, 1996), the fast sweeping
+/// algorithm (Zhao, 2005), or a simpler propagation algorithm that uses a chamfer metric (after work by Verwer and
+/// Strasters). `metric` is used only in the latter case. `mode` selects the algorithm used and what output is
+/// produced:
 ///  - `"fast marching"` uses the fast marching algorithm. This is the default.
+///  - `"fast sweeping"` uses the fast sweeping algorithm, which solves the same equations as the fast marching
+///    algorithm, and yields the same result.
 ///  - `"chamfer"` uses the chamfer metric algorithm.
 ///  - `"length"` also uses the chamfer metric algorithm, but outputs the length of the optimal path, rather
 ///    than the integral along the path.
@@ -175,9 +183,19 @@ inline Image VectorDistanceTransform(
 /// The chamfer metric algorithm is a little faster than the fast marching algorithm,
 /// with smaller neighborhoods being faster than larger neighborhoods.
 ///
+/// The fast marching and chamfer metric algorithms propagate distances from the background in order of increasing
+/// distance, and cannot be parallelized. The fast sweeping algorithm instead repeatedly sweeps the image in each
+/// of the diagonal directions, until the distances no longer change. Each sweep processes the image one diagonal
+/// hyperplane at the time, the pixels in one hyperplane are computed in parallel (Detrixhe et al., 2013).
+/// The number of sweeps needed grows with the number of turns in the optimal paths, so this algorithm is most
+/// effective for large images where paths are not too convoluted, and when many threads are available.
+///
 /// **Literature**
 ///  - J.A. Sethian, "A fast marching level set method for monotonically advancing fronts", Proceedings of the
 ///    National Academy of Sciences 93(4):1591-1595, 1996.
+///  - H. Zhao, "A fast sweeping method for Eikonal equations", Mathematics of Computation 74(250):603-627, 2005.
+///  - M. Detrixhe, F. Gibou and C. Min, "A parallel fast sweeping method for the Eikonal equation", Journal of
+///    Computational Physics 237:46-55, 2013.
 ///  - B.J.H. Verwer, P.W. Verbeek and S.T. Dekker, "An efficient uniform cost algorithm applied to distance
 ///    transforms", IEEE Transactions on Pattern Analysis and Machine Intelligence 11(4):425-429, 1989.
 ///  - P.W. Verbeek and B.J.H. Verwer, "Shading from shape, the eikonal equation solved by grey-weighted distance
@@ -224,20 +242,26 @@ inline Image GreyWeightedDistanceTransform(
 ///
 /// This function is currently implemented in terms of `dip::GreyWeightedDistanceTransform`, see that function for
 /// literature and implementation details. It uses the fast marching algorithm to produce a reasonable approximation
-/// of Euclidean distances.
+/// of Euclidean distances. Set `mode` to `"fast sweeping"` to use the fast sweeping algorithm instead, which
+/// produces the same result but can use multiple threads.
 inline void GeodesicDistanceTransform(
       Image const& marker,
       Image const& condition,
-      Image& out
+      Image& out,
+      String const& mode = S::FASTMARCHING
 ) {
-   GreyWeightedDistanceTransform( {}, marker, condition, out, {}, S::FASTMARCHING );
+   if(( mode != S::FASTMARCHING ) && ( mode != S::FASTSWEEPING )) {
+      DIP_THROW_INVALID_FLAG( mode );
+   }
+   GreyWeightedDistanceTransform( {}, marker, condition, out, {}, mode );
 }
 inline Image GeodesicDistanceTransform(
       Image const& marker,
-      Image const& condition
+      Image const& condition,
+      String const& mode = S::FASTMARCHING
 ) {
    Image out;
-   GeodesicDistanceTransform( marker, condition, out );
+   GeodesicDistanceTransform( marker, condition, out, mode );
    return out;
 }
 
@@ -21,6 +21,8 @@
 #ifndef DIP_FILE_IO_H
 #define DIP_FILE_IO_H
 
+#include <functional>
+
 #include "diplib.h"
 
 
@@ -70,6 +72,16 @@ struct FileInformation {
 /// interface set it might also be impossible to dictate what the strides will look like. In these cases,
 /// the flag is ignored.
 ///
+/// If `mode` is `"mmap"`, the data file is mapped into memory, and `out` is created around the mapped data
+/// without copying it. `out` then has strides matching those in the file, and reading is nearly
+/// instantaneous, independently of the file size; pixel data is loaded from disk only as it is accessed,
+/// and the pages are shared with the operating system's file cache. If `roi` or `channels` select a subset
+/// of the data, `out` is a view (with strides possibly larger than 1) into the mapped file. The mapping
+/// is copy-on-write: `out` can be modified, but those changes are not written to the file. The file is
+/// unmapped when the last image that shares its data segment is destroyed. This mode is only possible for
+/// uncompressed files with the native byte order of the machine; in all other cases the
+/// flag is ignored. If `out` is protected or has an external interface set, the data is copied into it.
+///
 /// Information about the file and all metadata are returned in the `FileInformation` output argument.
 // TODO: read sensor information also into the history strings
 DIP_EXPORT FileInformation ImageReadICS(
@@ -158,6 +170,19 @@ DIP_EXPORT bool ImageIsICS( String const& filename );
 ///    these two pieces into a single '.ics' file. `"v2"` is the default.
 ///  - '"uncompressed"` or '"gzip"`: Determine whether to compress the pixel data or not. `"gzip"` is the default.
 ///  - `"fast"`: Writes data in the order in which they are in memory, which is faster.
+///  - `"index"`: When compressing, also writes a chunk index file (see below). It is an error to combine
+///    this option with `"uncompressed"`, or to use it when DIPlib was compiled without zlib.
+///
+/// The `"gzip"` compression is performed on multiple threads: the pixel data are split
+/// into chunks of about 4 MiB (never splitting an image line), which are deflated independently and
+/// concatenated into a single gzip stream that can be read by any gzip or ICS reader. The output does not
+/// depend on the number of threads used. Because each chunk is compressed independently, decompression
+/// can start at the beginning of any chunk. With the `"index"` option, the locations of the chunks are
+/// written to a file with the name of the data file with ".idx" appended (i.e. "name.ics.idx" or
+/// "name.ids.idx"). This binary file contains the number of chunks, followed by two values for each chunk:
+/// the offset into the data file where its compressed (raw deflate) data starts, and the offset into the
+/// uncompressed pixel data that it corresponds to. All values are 64-bit unsigned integers in
+/// little-endian byte order.
 ///
 /// Note that the `"fast"` option yields a file with permuted dimensions. The software reading the file must be
 /// aware of the possibility of permuted dimensions, and check the "order" tag in the file. If the image has
@@ -170,6 +195,113 @@ DIP_EXPORT void ImageWriteICS(
       StringSet const& options = {}
 );
 
+/// \brief Creates an uncompressed ICS file, to be filled tile by tile using `dip::ImageWriteICSTile`.
+///
+/// `image` does not need to be forged, its sizes, tensor shape, data type, pixel size and color space
+/// are written to the ICS header. The pixel data are not written, the file is created without allocating
+/// memory for the image, so it can be larger than the available memory.
+///
+/// The header is written to `filename` (the ".ics" extension will be added if it's not there), and the pixel
+/// data to a separate file with the ".ids" extension (the header refers to this file by name, so the
+/// two files must be kept together, use an absolute path if the file is to be read from a different working
+/// directory). The data are stored in the native byte order. The pixel data are initially zero. Overwrites
+/// any other files with the same names.
+///
+/// See `dip::ImageWriteICS` for the meaning of `history` and `significantBits`.
+///
+/// \see dip::ImageWriteICSTile, dip::ImageFilterICSTiles
+DIP_EXPORT void ImageCreateICS(
+      Image const& image,
+      String const& filename,
+      StringArray const& history = {},
+      dip::uint significantBits = 0
+);
+
+/// \brief Writes `tile` to the ICS file `filename`, such that its first pixel is at `origin`.
+///
+/// The file must exist, and be uncompressed with the native byte order, such as created by `dip::ImageCreateICS`
+/// or `dip::ImageWriteICS` with the `"uncompressed"` option. `tile` must have the same dimensionality and number
+/// of tensor elements as the image in the file, and must fit within it when placed at `origin`. The data type
+/// of `tile` is converted to that of the file if necessary.
+///
+/// \see dip::ImageCreateICS, dip::ImageFilterICSTiles
+DIP_EXPORT void ImageWriteICSTile(
+      Image const& tile,
+      String const& filename,
+      UnsignedArray const& origin
+);
+
+/// \brief A function that processes one tile in `dip::ImageFilterICSTiles`. It should write
+/// to its second argument an image of the same sizes as its first argument.
+using TileFilterFunction = std::function< void( Image const&, Image& ) >;
+
+/// \brief A function that is called for each tile in `dip::ImageForEachICSTile`. Its arguments
+/// are the tile, and the coordinates of its first pixel in the full image.
+using TileFunction = std::function< void( Image const&, UnsignedArray const& ) >;
+
+/// \brief Applies `filter` to the image in the ICS file `inFilename` one tile at a time, writing the result
+/// to the ICS file `outFilename`. Use this to process images that don't fit in memory.
+///
+/// The image is divided into tiles of size `tileSizes` (the tiles at the right and bottom edge of the image
+/// might be smaller). For each tile, the region of the input image covering the tile plus `halo` pixels
+/// on each side (but clipped to the image domain) is read, and passed to `filter`. The part of the output that
+/// corresponds to the tile is written to `outFilename`, as `dip::ImageWriteICSTile` would. The output file is kept
+/// open while processing, and tiles are written in runs of pixels that are contiguous on file; tiles that span the
+/// full image width are thus written most efficiently. `halo` must be at least
+/// as large as the boundary that the filter needs (for example the half size of a kernel, or the value returned
+/// by `dip::Kernel::Boundary`); in that case the result is identical to that of applying the filter to the
+/// whole image at once, including the boundary condition at the image edges. Any filter that produces each output
+/// pixel from a finite neighborhood can be applied in this way, including any filter implemented through
+/// `dip::Framework::Scan`, `dip::Framework::Separable` or `dip::Framework::Full`.
+///
+/// If `tileSizes` or `halo` have a single value, it is used for all dimensions.
+///
+/// The output file is created with `dip::ImageCreateICS`, using the data type, tensor shape and color space
+/// of the output of `filter` for the first tile, and the pixel size of the input file. `filter` should produce
+/// the same type of output for all tiles.
+///
+/// ```cpp
+///     dip::ImageFilterICSTiles( "in.ics", "out.ics", []( dip::Image const& in, dip::Image& out ) {
+///        dip::Gauss( in, out, { 5 } );
+///     }, { 512 }, { 16 } );
+/// ```
+///
+/// \see dip::ImageForEachICSTile, dip::ImageCreateICS, dip::ImageWriteICSTile
+DIP_EXPORT void ImageFilterICSTiles(
+      String const& inFilename,
+      String const& outFilename,
+      TileFilterFunction const& filter,
+      UnsignedArray tileSizes = { 512 },
+      UnsignedArray halo = { 0 }
+);
+
+/// \brief Calls `function` for each tile of the image in the ICS file `filename`. Use this to compute
+/// reductions (sum, maximum, histogram, etc.) over images that don't fit in memory.
+///
+/// The image is divided into tiles of size `tileSizes` (the tiles at the right and bottom edge of the image
+/// might be smaller). If `tileSizes` has a single value, it is used for all dimensions. Each tile is read and
+/// passed to `function`, together with the coordinates of its first pixel in the file. The tiles do not
+/// overlap, so each pixel is seen exactly once. For example:
+///
+/// ```cpp
+///     dip::dfloat sum = 0;
+///     dip::dfloat maximum = std::numeric_limits< dip::dfloat >::lowest();
+///     dip::Histogram::Configuration config( 0.0, 256.0, 256 );
+///     dip::Histogram histogram( config ); // an empty histogram, we'll add the histograms of each tile
+///     dip::ImageForEachICSTile( "in.ics", [ & ]( dip::Image const& tile, dip::UnsignedArray const& ) {
+///        sum += dip::Sum( tile ).As< dip::dfloat >();
+///        maximum = std::max( maximum, dip::Maximum( tile ).As< dip::dfloat >() );
+///        histogram += dip::Histogram( tile, {}, config );
+///     } );
+/// ```
+///
+/// \see dip::ImageFilterICSTiles
+DIP_EXPORT void ImageForEachICSTile(
+      String const& filename,
+      TileFunction const& function,
+      UnsignedArray tileSizes = { 512 }
+);
+
 
 /// \brief Reads an image from the TIFF file `filename` and puts it in `out`.
 ///
@@ -298,11 +430,26 @@ DIP_EXPORT bool ImageIsTIFF( String const& filename );
 ///    by compliant TIFF readers. Even small amounts of noise can cause this method to yield larger files than `"none"`.
 ///  - `"JPEG"`: uses **lossy** JPEG compression. `jpegLevel` determines the amount of compression applied. `jpegLevel`
 ///    is an integer between 1 and 100, with increasing numbers yielding larger files and fewer compression artifacts.
+///
+/// `options` specifies how the TIFF file is written, and can contain one or several of these strings:
+///  - `"BigTIFF"`: writes a BigTIFF file, which uses 64-bit offsets and can thus be larger than 4 GiB. Not all
+///    TIFF readers recognize this format. A BigTIFF file is always written if the image is too large for a
+///    regular TIFF file.
+///  - `"tiled"`: writes the pixel data in tiles of 256x256 pixels, rather than in strips. An exception is thrown
+///    for binary images, because `dip::ImageReadTIFF` cannot read tiled binary images; convert these to
+///    `dip::DT_UINT8` first.
+///  - `"pyramid"`: writes a tiled image (as `"tiled"`) followed by reduced-resolution versions of it, each
+///    half the size of the previous one, until the image fits in a single tile. These are stored in SubIFDs
+///    of the main image (as in OME-TIFF), marked as reduced-resolution images. Readers that are not aware of
+///    the pyramid (including `dip::ImageReadTIFF`) see only the full-resolution image. The reduced-resolution
+///    images are computed with `dip::Resampling`, averaging blocks of 2x2 pixels. As with `"tiled"`, binary
+///    images are not supported.
 DIP_EXPORT void ImageWriteTIFF(
       Image const& image,
       String const& filename,
       String const& compression = "",
-      dip::uint jpegLevel = 80
+      dip::uint jpegLevel = 80,
+      StringSet const& options = {}
 );
 
 
@@ -311,16 +458,53 @@ DIP_EXPORT void ImageWriteTIFF(
 /// The function tries to open `filename` as given first, and if that fails, it appends ".jpg" and ".jpeg" to the
 /// name and tries again.
 ///
+/// `scale` can be set to 2, 4 or 8 to read a reduced-resolution version of the image. The reduction is
+/// done while decoding, using a smaller inverse DCT, and is therefore much cheaper than reading the full image
+/// and subsampling it. The pixel size of `out` is scaled accordingly.
+///
+/// `roi` can be set to read in a subset of the pixels in the 2D image. It refers to the image after
+/// reduction by `scale`. If only one array element is given, it is used for both dimensions. An empty
+/// array indicates that all pixels should be read. Decoding stops after the last image line in the ROI.
+///
 /// The pixels per inch value in the JPEG file will be used to set the pixel size of `out`.
 DIP_EXPORT FileInformation ImageReadJPEG(
       Image& out,
-      String const& filename
+      String const& filename,
+      dip::uint scale = 1,
+      RangeArray const& roi = {}
 );
 inline Image ImageReadJPEG(
-      String const& filename
+      String const& filename,
+      dip::uint scale = 1,
+      RangeArray const& roi = {}
+) {
+   Image out;
+   ImageReadJPEG( out, filename, scale, roi );
+   return out;
+}
+
+/// \brief Reads a set of JPEG images as a single 3D image.
+///
+/// `filenames` contains the paths to the JPEG files, which are concatenated along the 3rd dimension in the
+/// order given. `scale` and `roi` are as in `dip::ImageReadJPEG`, and are applied to each of the files.
+/// All files must have the same sizes and number of channels.
+///
+/// The files are decoded in parallel, each directly into its plane of `out`. If `out` already has the right
+/// sizes and data type, its data segment is reused, so that a stack can be allocated once and used to read
+/// many batches of images.
+DIP_EXPORT void ImageReadJPEGSeries(
+      Image& out,
+      StringArray const& filenames,
+      dip::uint scale = 1,
+      RangeArray const& roi = {}
+);
+inline Image ImageReadJPEGSeries(
+      StringArray const& filenames,
+      dip::uint scale = 1,
+      RangeArray const& roi = {}
 ) {
    Image out;
-   ImageReadJPEG( out, filename );
+   ImageReadJPEGSeries( out, filenames, scale, roi );
    return out;
 }
 
@@ -183,6 +183,7 @@ constexpr char const* SQUARE = "square";
 
 // Grey-weighted distance transforms
 constexpr char const* FASTMARCHING = "fast marching";
+constexpr char const* FASTSWEEPING = "fast sweeping";
 //constexpr char const* CHAMFER = "chamfer";
 //constexpr char const* LENGTH = "length";
 
@@ -285,6 +286,11 @@ constexpr char const* COUNTERCLOCKWISE = "counter-clockwise";
 constexpr char const* INTERLEAVED_CLOCKWISE = "interleaved clockwise";
 constexpr char const* INTERLEAVED_COUNTERCLOCKWISE = "interleaved counter-clockwise";
 
+// TIFF writing options
+constexpr char const* BIGTIFF = "BigTIFF";
+constexpr char const* TILED = "tiled";
+constexpr char const* PYRAMID = "pyramid";
+
 } // namespace S
 
 } // namespace dip
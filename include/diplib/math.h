@@ -421,6 +421,11 @@ inline Image Rank( Image const& in ) {
 /// `out` is a vector image containing the eigenvalues. If `in` is symmetric and
 /// real-valued, then `out` is real-valued, otherwise, `out` is complex-valued.
 /// The eigenvalues are sorted by magnitude, in descending order.
+///
+/// For real-valued, symmetric 2x2 and 3x3 matrices, a closed-form solution is used, which is much faster
+/// than the iterative algorithm used in the general case. The input is read in its native precision (single
+/// or double), computations are always in double precision. When two eigenvalues are nearly equal, the
+/// closed-form solution has an error of the order of 10<sup>-8</sup> times the largest eigenvalue magnitude.
 DIP_EXPORT void Eigenvalues( Image const& in, Image& out );
 inline Image Eigenvalues( Image const& in ) {
    Image out;
@@ -718,6 +718,14 @@ class DIP_CLASS_EXPORT Base {
       /// process for one image.
       virtual void Cleanup() {};
 
+      /// \brief Returns `true` if the feature's `%Measure` method can be called concurrently for different objects.
+      ///
+      /// This is used only for chain-code--based, polygon-based and convex-hull--based features. Features that
+      /// return `false` (the default) are measured sequentially, after the thread-safe features have been measured
+      /// in parallel. A feature should override this function to return `true` only if its `%Measure` method
+      /// does not modify the feature object's state.
+      virtual bool IsThreadSafe() const { return false; }
+
       virtual ~Base() = default;
 };
 
@@ -764,7 +772,9 @@ class DIP_CLASS_EXPORT ChainCodeBased : public Base {
    public:
       explicit ChainCodeBased( Information const& information ) : Base( information, Type::CHAINCODE_BASED ) {};
 
-      /// \brief Called once for each object
+      /// \brief Called once for each object.
+      /// This function is called in parallel for different objects only if `dip::Feature::Base::IsThreadSafe`
+      /// returns `true`.
       virtual void Measure( ChainCode const& chainCode, Measurement::ValueIterator output ) = 0;
 };
 
@@ -773,7 +783,9 @@ class DIP_CLASS_EXPORT PolygonBased : public Base {
    public:
       explicit PolygonBased( Information const& information ) : Base( information, Type::POLYGON_BASED ) {};
 
-      /// \brief Called once for each object
+      /// \brief Called once for each object.
+      /// This function is called in parallel for different objects only if `dip::Feature::Base::IsThreadSafe`
+      /// returns `true`.
       virtual void Measure( Polygon const& polygon, Measurement::ValueIterator output ) = 0;
 };
 
@@ -782,7 +794,9 @@ class DIP_CLASS_EXPORT ConvexHullBased : public Base {
    public:
       explicit ConvexHullBased( Information const& information ) : Base( information, Type::CONVEXHULL_BASED ) {};
 
-      /// \brief Called once for each object
+      /// \brief Called once for each object.
+      /// This function is called in parallel for different objects only if `dip::Feature::Base::IsThreadSafe`
+      /// returns `true`.
       virtual void Measure( ConvexHull const& convexHull, Measurement::ValueIterator output ) = 0;
 };
 
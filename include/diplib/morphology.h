@@ -22,6 +22,7 @@
 #define DIP_MORPHOLOGY_H
 
 #include "diplib.h"
+#include "diplib/random.h"
 
 
 /// \file
@@ -1011,6 +1012,12 @@ inline Image SeededWatershed(
 /// of iterations, but typically `dip::DT_UINT8`), or of type `dip::DT_SFLOAT` if the exact stochastic watershed
 /// is computed.
 ///
+/// The iterations are computed in parallel (see `dip::SetNumberOfThreads`). Each iteration uses its own random
+/// stream, obtained by advancing a copy of `random` by a fixed, large number of steps per iteration, and the
+/// counts are accumulated with integer arithmetic. Therefore, given a `random` in a given state, the result is
+/// identical independently of the number of threads used. After the call, `random` has been advanced past all
+/// streams used. The overload without the `random` parameter uses a default-initialized `dip::Random`.
+///
 /// **Literature**
 /// - J. Angulo and D. Jeulin, "Stochastic watershed segmentation", Proceedings of the 8th International Symposium on
 ///   Mathematical Morphology, Instituto Nacional de Pesquisas Espaciais (INPE), São José dos Campos, pp. 265–276, 2007.
@@ -1039,6 +1046,27 @@ inline Image StochasticWatershed(
    StochasticWatershed( in, out, nSeeds, nIterations, noise, seeds );
    return out;
 }
+DIP_EXPORT void StochasticWatershed(
+      Image const& in,
+      Image& out,
+      Random& random,
+      dip::uint nSeeds = 100,
+      dip::uint nIterations = 50,
+      dfloat noise = 0,
+      String const& seeds = S::HEXAGONAL
+);
+inline Image StochasticWatershed(
+      Image const& in,
+      Random& random,
+      dip::uint nSeeds = 100,
+      dip::uint nIterations = 50,
+      dfloat noise = 0,
+      String const& seeds = S::HEXAGONAL
+) {
+   Image out;
+   StochasticWatershed( in, out, random, nSeeds, nIterations, noise, seeds );
+   return out;
+}
 
 /// \brief Marks significant local minima.
 ///
@@ -1436,12 +1464,184 @@ inline Image AreaClosing(
    return out;
 }
 
+/// \brief A max-tree or min-tree of a grey-value image, used to compute connected attribute filters.
+///
+/// In a max-tree, each node represents a connected component of a level set { x | f(x) >= t }, and has as
+/// parent the smallest component at a lower threshold that contains it. A min-tree is the max-tree of the
+/// inverted image, its level sets are { x | f(x) <= t }. Each pixel belongs to the node of the smallest component
+/// that contains it. The leaf nodes are the regional maxima (minima). Pixels are connected according to
+/// `connectivity`, see \ref connectivity for information on the connectivity parameter.
+///
+/// The tree is built once, in O(n log n) time, using the union-find algorithm by Berger et al. (2007). After
+/// that, node attributes (`dip::ComponentTree::Attribute`), attribute filters (`dip::ComponentTree::Filter`)
+/// and extinction values (`dip::ComponentTree::ExtinctionValues`) are all computed in O(n) time, without
+/// revisiting the image. This makes it efficient to apply the same filter with many different thresholds:
+///
+/// ```cpp
+///     dip::ComponentTree tree( img );
+///     auto area = tree.Attribute( "area" );
+///     for( dip::dfloat threshold : { 10, 20, 50, 100 } ) {
+///        dip::Image out = tree.Filter( area, threshold );
+///        // ...
+///     }
+/// ```
+///
+/// When `polarity` is `"opening"`, the max-tree is built, and filters remove bright structures. When it is
+/// `"closing"`, the min-tree is built, and filters remove dark structures.
+///
+/// `in` must be scalar and real-valued or binary.
+///
+/// **Literature**
+///  - C. Berger, T. Geraud, R. Levillain, N. Widynski, A. Baillard and E. Bertin, "Effective component tree
+///    computation with application to pattern recognition in astronomical imaging", IEEE International
+///    Conference on %Image Processing 4:41-44, 2007.
+///  - P. Salembier, A. Oliveras and L. Garrido, "Antiextensive connected operators for image and sequence
+///    processing", IEEE Transactions on %Image Processing 7(4):555-570, 1998.
+///  - M.A. Vachier and F. Meyer, "Extinction value: a new measurement of persistence", IEEE Workshop on
+///    Nonlinear Signal and %Image Processing, pp. 254-257, 1995.
+///
+/// \see dip::AttributeOpening, dip::AreaOpening
+class DIP_NO_EXPORT ComponentTree {
+   public:
+      /// \brief A node in the tree.
+      struct Node {
+         dip::uint parent;    ///< Index to the parent node; the root node is its own parent
+         dfloat level;        ///< Grey value of the node
+         dip::uint area;      ///< Number of pixels in the component (node plus all its descendants)
+      };
+
+      /// \brief Builds the max-tree (if `polarity` is `"opening"`) or the min-tree (if `"closing"`) of `in`.
+      DIP_EXPORT explicit ComponentTree( Image const& in, dip::uint connectivity = 0, String const& polarity = S::OPENING );
+
+      /// \brief The nodes of the tree, sorted such that each node comes before its parent. The root node is the last one.
+      std::vector< Node > const& Nodes() const { return nodes_; }
+
+      /// \brief The number of nodes in the tree.
+      dip::uint NumberOfNodes() const { return nodes_.size(); }
+
+      /// \brief The index of the root node.
+      dip::uint Root() const { return nodes_.size() - 1; }
+
+      /// \brief The index of the node each pixel belongs to, indexed by the linear index of the pixel
+      /// (see \ref pointers).
+      std::vector< dip::uint > const& PixelNodes() const { return pixelNodes_; }
+
+      /// \brief The sizes of the image the tree was built from.
+      UnsignedArray const& Sizes() const { return sizes_; }
+
+      /// \brief True if this is a max-tree, false for a min-tree.
+      bool IsMaxTree() const { return maxTree_; }
+
+      /// \brief Computes an attribute for each of the nodes. The output is indexed by node index.
+      ///
+      /// `attribute` is one of:
+      ///  - `"area"`: the number of pixels in the component.
+      ///  - `"volume"`: the sum of the differences between the grey values of the pixels in the component and
+      ///    the level of its parent node.
+      ///  - `"height"`: the difference between the most extreme grey value in the component and the level of
+      ///    its parent node. The extinction values for this attribute are known as the dynamics.
+      ///  - `"bounding box"`: the length of the longest side of the component's bounding box.
+      ///  - `"elongation"`: the square root of the ratio of the largest to the smallest eigenvalue of the
+      ///    covariance matrix of the pixel coordinates, where each pixel is considered a unit square (cube).
+      ///    It is 1 for isotropic shapes, and the length for a one-pixel-wide line.
+      ///
+      /// All attributes but `"elongation"` are increasing, that is, a node has an attribute value not larger
+      /// than that of its parent.
+      DIP_EXPORT std::vector< dfloat > Attribute( String const& attribute ) const;
+
+      /// \brief Computes an attribute opening (or closing for a min-tree).
+      ///
+      /// All components for which `attribute` is smaller than `threshold` are removed, their pixels are set
+      /// to the level of the closest ancestor that is not removed. `attribute` is indexed by node index,
+      /// and is typically the output of `dip::ComponentTree::Attribute`. For non-increasing attributes,
+      /// a component is preserved if it, or any of its descendants, satisfies the criterion (the "max" rule).
+      ///
+      /// The output image has the data type, sizes and pixel size of the image the tree was built from.
+      DIP_EXPORT void Filter( std::vector< dfloat > const& attribute, dfloat threshold, Image& out ) const;
+      Image Filter( std::vector< dfloat > const& attribute, dfloat threshold ) const {
+         Image out;
+         Filter( attribute, threshold, out );
+         return out;
+      }
+
+      /// \brief Computes the extinction values of all regional maxima (minima for a min-tree).
+      ///
+      /// When lowering a threshold, regional maxima merge. At each merge, the branch with the largest
+      /// attribute value survives, the others go extinct. The extinction value of a regional maximum is the
+      /// largest attribute value of its branch before it went extinct. The maximum that survives up to the
+      /// root gets the attribute value of the root.
+      ///
+      /// `attribute` is indexed by node index, and is typically the output of `dip::ComponentTree::Attribute`.
+      /// The output image is of type `dip::DT_DFLOAT`, with the extinction values written to the pixels of
+      /// the regional maxima (minima), and 0 elsewhere.
+      DIP_EXPORT void ExtinctionValues( std::vector< dfloat > const& attribute, Image& out ) const;
+      Image ExtinctionValues( std::vector< dfloat > const& attribute ) const {
+         Image out;
+         ExtinctionValues( attribute, out );
+         return out;
+      }
+
+   private:
+      std::vector< Node > nodes_;
+      std::vector< dip::uint > pixelNodes_;
+      UnsignedArray sizes_;
+      PixelSize pixelSize_;
+      DataType dataType_;
+      bool maxTree_;
+
+      // Returns the attribute with the "max" rule applied: each node gets the maximum value over its subtree.
+      std::vector< dfloat > MaxRule( std::vector< dfloat > const& attribute ) const;
+};
+
+/// \brief Computes a connected attribute opening or closing
+///
+/// Removes all bright (`polarity` is `"opening"`) or dark (`"closing"`) connected structures for which
+/// the given attribute is smaller than `threshold`. See `dip::ComponentTree::Attribute` for the attributes
+/// that can be used. With `attribute` set to `"area"`, the result is identical to that of `dip::AreaOpening`
+/// without a mask, using the same `connectivity`.
+///
+/// This function builds a `dip::ComponentTree` and calls its `Filter` method. To apply the filter with
+/// several thresholds, it is more efficient to build the tree once and filter it repeatedly.
+///
+/// `connectivity` determines what a connected component is. See \ref connectivity for information on the
+/// connectivity parameter.
+///
+/// \see dip::ComponentTree, dip::AreaOpening
+inline void AttributeOpening(
+      Image const& in,
+      Image& out,
+      String const& attribute,
+      dfloat threshold,
+      dip::uint connectivity = 0,
+      String const& polarity = S::OPENING
+) {
+   ComponentTree tree( in, connectivity, polarity );
+   tree.Filter( tree.Attribute( attribute ), threshold, out );
+}
+inline Image AttributeOpening(
+      Image const& in,
+      String const& attribute,
+      dfloat threshold,
+      dip::uint connectivity = 0,
+      String const& polarity = S::OPENING
+) {
+   Image out;
+   AttributeOpening( in, out, attribute, threshold, connectivity, polarity );
+   return out;
+}
+
 /// \brief Applies a path opening in all possible directions
 ///
 /// `length` is the length of the path. All `filterParam` arguments to `dip::DirectedPathOpening` that yield a
 /// length of `length` pixels and represent unique directions are generated, and the directed path opening is computed
 /// for each of them. The supremum (when `polarity` is `"opening"`) or infimum (when it is `"closing"`) is
 /// computed over all results. See `dip::DirectedPathOpening` for a description of the algorithm and the parameters.
+///
+/// The directions are processed in parallel, each thread uses its own set of temporary images: a copy of `in`,
+/// a binary image, two 16-bit images (four if `mode` contains `"constrained"`), and an image of the same type
+/// as `in` for its partial result. For example, for an 8-bit image and the unconstrained mode, each thread needs
+/// about 7 bytes per pixel. To bound the memory usage for large images, the number of threads is reduced such
+/// that these temporary images take up at most 1 GiB.
 DIP_EXPORT void PathOpening(
       Image const& in,
       Image const& mask,
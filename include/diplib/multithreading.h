@@ -30,6 +30,7 @@
 // We don't have OpenMP, these are OpenMP function stubs to avoid conditional compilation elsewhere.
 inline int omp_get_thread_num() { return 0; }
 inline int omp_get_max_threads() { return 1; }
+inline int omp_in_parallel() { return 0; }
 #endif
 
 
@@ -66,6 +67,10 @@ DIP_EXPORT void SetNumberOfThreads( dip::uint nThreads );
 /// Returns the value given in the last call to `dip::SetNumberOfThreads`, or the default maximum value if that
 /// function was never called.
 ///
+/// When called from within an active OpenMP parallel region (for example when a DIPlib function is called from
+/// a loop that is already parallelized, either by the user or by DIPlib itself), this function returns 1. DIPlib
+/// does not use nested parallelism.
+///
 /// If DIPlib was compiled without OpenMP support, this function always returns 1.
 DIP_EXPORT dip::uint GetNumberOfThreads();
 
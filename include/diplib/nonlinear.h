@@ -775,6 +775,103 @@ inline Image SeparableBilateralFilter(
    return out;
 }
 
+/// \brief Bilateral grid filter, a fast approximation with a cost independent of the spatial sigma
+///
+/// The bilateral filter is a non-linear edge-preserving smoothing filter. It locally averages input pixels,
+/// weighting them with both the spatial distance to the origin as well as the intensity difference with the
+/// pixel at the origin. The weights are Gaussian, and therefore there are two sigmas as parameters. The
+/// spatial sigma can be defined differently for each image dimension in `spatialSigma`. `tonalSigma` determines
+/// what similar intensities are.
+///
+/// This version of the filter uses the bilateral grid as described by Paris and Durand: the image is
+/// represented in a space with one additional dimension for the intensity, subsampled by the sigmas. The
+/// bilateral filter then is a Gaussian filter with a sigma of one grid cell in this space, followed by linear
+/// interpolation at the location of each pixel. The computational cost thus decreases with increasing sigmas.
+/// `truncation` determines the size of the Gaussian kernel applied to the grid. The grid is padded with zeros,
+/// there is no boundary condition.
+///
+/// The intensity axis of the grid has at most 256 bins. If the range of values in `in` and `estimate` is larger
+/// than 256 times `tonalSigma`, the intensity axis is sampled more coarsely than `tonalSigma`. This bounds the
+/// size of the grid, at the cost of a coarser tonal resolution: intensities closer together than about 1/256th
+/// of the range are not distinguished. Use a different method for a small `tonalSigma` relative to the range.
+/// All pixel values must be finite.
+///
+/// If `in` is not scalar, each tensor element will be filtered independently. For color images, this leads to
+/// false colors at edges. `in` must be real-valued.
+///
+/// The optional image `estimate`, if forged, is used as the tonal center when computing the kernel at each pixel.
+/// That is, each point in the kernel is computed based on the distance of the corresponding pixel value in `in`
+/// to the value of the pixel at the origin of the kernel in `estimate`. If not forged, `in` is used for `estimate`.
+/// `estimate` must be real-valued and have the same sizes and number of tensor elements as `in`.
+///
+/// **Literature**
+/// - S. Paris and F. Durand, "A fast approximation of the bilateral filter using a signal processing approach",
+///   International Journal of Computer Vision 81(1):24-52, 2009.
+DIP_EXPORT void GridBilateralFilter(
+      Image const& in,
+      Image const& estimate,
+      Image& out,
+      FloatArray spatialSigmas = { 2.0 },
+      dfloat tonalSigma = 30.0,
+      dfloat truncation = 2.0
+);
+inline Image GridBilateralFilter(
+      Image const& in,
+      Image const& estimate = {},
+      FloatArray const& spatialSigmas = { 2.0 },
+      dfloat tonalSigma = 30.0,
+      dfloat truncation = 2.0
+) {
+   Image out;
+   GridBilateralFilter( in, estimate, out, spatialSigmas, tonalSigma, truncation );
+   return out;
+}
+
+/// \brief Permutohedral lattice bilateral filter, a fast approximation for tensor (color) images
+///
+/// The bilateral filter is a non-linear edge-preserving smoothing filter. It locally averages input pixels,
+/// weighting them with both the spatial distance to the origin as well as the intensity difference with the
+/// pixel at the origin. The weights are Gaussian, and therefore there are two sigmas as parameters. The
+/// spatial sigma can be defined differently for each image dimension in `spatialSigma`, and must be positive.
+/// `tonalSigma` determines what similar intensities are.
+///
+/// This version of the filter uses the permutohedral lattice as described by Adams, Baek and Davis. Each pixel
+/// is a point in a space of dimensionality equal to the image dimensionality plus the number of tensor elements,
+/// which is sparsely sampled by a lattice of simplices. Only the lattice points close to a pixel are stored, and
+/// the cost of the filter is independent of the spatial sigma and linear in the dimensionality of this space.
+///
+/// Contrary to the other bilateral filter implementations, tensor elements are not filtered independently:
+/// the tonal distance between pixels is the Euclidean distance between their tensor values. Therefore, this
+/// filter does not produce false colors at edges in color images. All tensor elements are weighted
+/// equally, so the color space should be chosen such that Euclidean distances are meaningful (e.g. Lab).
+/// `in` must be real-valued.
+///
+/// The optional image `estimate`, if forged, is used as the tonal center when computing the kernel at each pixel.
+/// That is, each point in the kernel is computed based on the distance of the corresponding pixel value in `in`
+/// to the value of the pixel at the origin of the kernel in `estimate`. If not forged, `in` is used for `estimate`.
+/// `estimate` must be real-valued and have the same sizes and number of tensor elements as `in`.
+///
+/// **Literature**
+/// - A. Adams, J. Baek and M.A. Davis, "Fast high-dimensional filtering using the permutohedral lattice",
+///   Computer Graphics Forum 29(2):753-762, 2010.
+DIP_EXPORT void LatticeBilateralFilter(
+      Image const& in,
+      Image const& estimate,
+      Image& out,
+      FloatArray spatialSigmas = { 2.0 },
+      dfloat tonalSigma = 30.0
+);
+inline Image LatticeBilateralFilter(
+      Image const& in,
+      Image const& estimate = {},
+      FloatArray const& spatialSigmas = { 2.0 },
+      dfloat tonalSigma = 30.0
+) {
+   Image out;
+   LatticeBilateralFilter( in, estimate, out, spatialSigmas, tonalSigma );
+   return out;
+}
+
 /// \brief Bilateral filter, convenience function that allows selecting an implementation
 ///
 /// The `method` can be set to one of the following:
@@ -782,10 +879,13 @@ inline Image SeparableBilateralFilter(
 /// - `"xysep"` (default): xy-separable approximation, calls `dip::SeparableBilateralFilter`.
 /// - `"pwlinear"`: piecewise linear approximation (quantized), calls `dip::QuantizedBilateralFilter`.
 ///   The bins are automatically computed.
+/// - `"grid"`: bilateral grid approximation, calls `dip::GridBilateralFilter`. `boundaryCondition` is ignored.
+/// - `"lattice"`: permutohedral lattice approximation, calls `dip::LatticeBilateralFilter`. `truncation` and
+///   `boundaryCondition` are ignored. This is the only method that filters the tensor elements jointly.
+///
+/// For large spatial sigmas, `"grid"` and `"lattice"` are the fastest methods.
 ///
 /// See the linked functions for details on the other parameters.
-// TODO: Implement Paris and Durand (2006): http://people.csail.mit.edu/sparis/bf/
-// https://people.csail.mit.edu/sparis/publi/2009/ijcv/Paris_09_Fast_Approximation.pdf
 // TODO: Implement cross-bilateral filter
 // TODO: Implement bilateral filters correctly for tensor images (how to define distance? Simple answer: weigh all tensor elements equally. Is there a reason to do it differently?)
 DIP_EXPORT void BilateralFilter(
@@ -22,6 +22,7 @@
 #define DIP_SEGMENTATION_H
 
 #include "diplib.h"
+#include "diplib/random.h"
 
 
 /// \file
@@ -65,6 +66,25 @@ inline Image KMeansClustering(
    return out;
 }
 
+/// \brief Like above, using the given random number generator to initialize the clusters.
+///
+/// Given a `dip::Random` object in an identical state before calling this function, the output is identical.
+DIP_EXPORT CoordinateArray KMeansClustering(
+      Image const& in,
+      Image& out,
+      Random& random,
+      dip::uint nClusters = 2
+);
+inline Image KMeansClustering(
+      Image const& in,
+      Random& random,
+      dip::uint nClusters = 2
+) {
+   Image out;
+   KMeansClustering( in, out, random, nClusters );
+   return out;
+}
+
 /// \brief Spatially partitions an image into `nClusters` partitions iteratively, minimizing the variance
 /// of the partitions.
 ///
@@ -509,6 +509,9 @@ DIP__DEFINE_PROJECTION_FUNCTIONS( MinimumAbs )
 ///
 /// If `mask` is forged, only those pixels selected by the mask image are used.
 ///
+/// For 8-bit and 16-bit integer images, the percentile is found through a histogram of the sample values
+/// (a radix select), which takes linear time. For other data types, the samples are copied and partially sorted.
+///
 /// An alias is defined such that `dip::Percentile( img.At( mask ))` is the same as `dip::Percentile( img, mask )`.
 ///
 /// \see dip::PositionPercentile
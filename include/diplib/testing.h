@@ -22,6 +22,8 @@
 #define DIP_TESTING_H
 
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <ctime>
 #include <iomanip>
 
@@ -315,6 +317,60 @@ inline std::ostream& operator<<(
    return os;
 }
 
+/// \brief Names files in a temporary directory, and deletes these files when destroyed.
+///
+/// Tests that need to write files use this to avoid leaving them in the current working directory.
+/// The directory is taken from the `TMPDIR`, `TMP` or `TEMP` environment variables, in that order,
+/// and is `/tmp` if none of these is set. Every file written must be named through `Name`, including
+/// files created implicitly, such as the data file that goes with an ICS header:
+/// ```cpp
+///     dip::testing::TemporaryFiles files;
+///     dip::ImageWriteICS( image, files.Name( "test.ics" ), {}, 0, { "v1" } );
+///     files.Name( "test.ids" );
+///     image = dip::ImageReadICS( files.Name( "test.ics" ));
+/// ```
+class DIP_NO_EXPORT TemporaryFiles {
+   public:
+
+      /// \brief Determines the temporary directory.
+      TemporaryFiles() {
+         for( char const* var : { "TMPDIR", "TMP", "TEMP" } ) {
+            char const* dir = std::getenv( var );
+            if( dir && *dir ) {
+               directory_ = dir;
+               break;
+            }
+         }
+         if( directory_.empty() ) {
+            directory_ = "/tmp";
+         }
+         directory_ += "/dip_test_";
+      }
+
+      TemporaryFiles( TemporaryFiles const& ) = delete;
+      TemporaryFiles& operator=( TemporaryFiles const& ) = delete;
+
+      /// \brief Returns the path to the file `name` in the temporary directory, and records it for deletion.
+      String Name( String const& name ) {
+         String path = directory_ + name;
+         if( std::find( names_.begin(), names_.end(), path ) == names_.end() ) {
+            names_.push_back( path );
+         }
+         return path;
+      }
+
+      /// \brief Deletes all named files that exist.
+      ~TemporaryFiles() {
+         for( auto const& name : names_ ) {
+            std::remove( name.c_str() );
+         }
+      }
+
+   private:
+      String directory_;
+      StringArray names_;
+};
+
 /// \}
 
 } // namespace testing
@@ -43,6 +43,13 @@ constexpr char const* bioformatsInterface = "org/diplib/BioFormatsInterface";
 /// - `"org/diplib/BioFormatsInterface"`: The openmicroscopy.org Bio-Formats package (default).
 ///
 /// Information about the file and all metadata are returned in the `FileInformation` output argument.
+///
+/// If `out` is forged, and has the sizes, number of tensor elements and data type of the image in the file,
+/// its data segment is reused. If its strides also match the layout that `interface` writes, the data are
+/// written directly into `out`; otherwise they are read into a temporary buffer and copied into `out`. If
+/// `out` is protected and does not match, an exception is thrown. Otherwise `out` is reforged.
+///
+/// Samples are converted to the native byte order.
 DIP_EXPORT FileInformation ImageReadJavaIO(
       Image& out,
       String const& filename,
@@ -57,6 +64,55 @@ inline Image ImageReadJavaIO(
    return out;
 }
 
+/// \brief Reads a subset of the image in a file `filename` recognized by a Java `interface` and puts it in `out`.
+///
+/// Only the requested data are read from the file, making it possible to read a few planes, or a small
+/// region, from a very large data set.
+///
+/// `series` selects which of the series (or images) in the file to read. Within the series, each image plane
+/// is a 2D image, which all together are stacked along the third dimension of `out`. `imageNumbers` is a
+/// range which indicates which of these planes to read. Planes are ordered as given by the file format.
+/// If the range indicates a single plane, `out` is a 2D image.
+///
+/// To select planes by their Z, C and T indices, use the `history` field of the `FileInformation` output
+/// argument. It contains the strings `"DimensionOrder\t<order>"`, `"SizeZ\t<n>"`, `"SizeC\t<n>"` and
+/// `"SizeT\t<n>"`, as reported by Bio-Formats. The order is a string such as `"XYZCT"`, where the dimension
+/// after "XY" varies fastest along the plane index. For example, for `"XYZCT"` the plane index is
+/// `z + SizeZ * ( c + SizeC * t )`, and all Z planes for channel `c` and time point `t` are read with
+/// `imageNumbers` set to `{ SizeZ * ( c + SizeC * t ), SizeZ * ( c + SizeC * t + 1 ) - 1 }`. The channels
+/// of RGB planes are not counted in `SizeC`, they are in the tensor dimension of `out`.
+///
+/// `roi` can be set to read in a subset of the pixels in each plane. If only one array element is given,
+/// it is used for both dimensions. An empty array indicates that all pixels should be read.
+///
+/// Each plane is read in one call into a buffer that is reused for all planes, and copied from there
+/// directly into the pixel data of `out`. The pixel data of `out` are allocated by the normal means,
+/// so an external interface set in `out` can be used to control where the data are written.
+/// If `out` is forged, it is treated as in the function above.
+/// Samples are converted to the native byte order.
+///
+/// `interface` is as for the function above. The `numberOfImages` field of the `FileInformation` output
+/// argument is set to the number of planes in the series.
+DIP_EXPORT FileInformation ImageReadJavaIO(
+      Image& out,
+      String const& filename,
+      Range const& imageNumbers,
+      RangeArray const& roi = {},
+      dip::uint series = 0,
+      String const& interface = bioformatsInterface
+);
+inline Image ImageReadJavaIO(
+      String const& filename,
+      Range const& imageNumbers,
+      RangeArray const& roi = {},
+      dip::uint series = 0,
+      String const& interface = bioformatsInterface
+) {
+   Image out;
+   ImageReadJavaIO( out, filename, imageNumbers, roi, series, interface );
+   return out;
+}
+
 /// \}
 
 } // namespace javaio
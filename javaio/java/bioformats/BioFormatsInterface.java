@@ -20,6 +20,7 @@
 package org.diplib;
 
 import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.Arrays;
 
 import loci.formats.ImageReader;
@@ -84,24 +85,7 @@ public class BioFormatsInterface {
          }
       }
       
-      switch ( reader.getPixelType() ) {
-         case FormatTools.INT8:   image.SetDataType( "INT8" );
-                                  break;
-         case FormatTools.UINT8:  image.SetDataType( "UINT8" );
-                                  break;
-         case FormatTools.INT16:  image.SetDataType( "INT16" );
-                                  break;
-         case FormatTools.UINT16: image.SetDataType( "UINT16" );
-                                  break;
-         case FormatTools.INT32:  image.SetDataType( "INT32" );
-                                  break;
-         case FormatTools.UINT32: image.SetDataType( "UINT32" );
-                                  break;
-         case FormatTools.FLOAT:  image.SetDataType( "SFLOAT" );
-                                  break;
-         case FormatTools.DOUBLE: image.SetDataType( "DFLOAT" );
-                                  break;
-      }
+      SetDataType( image, reader.getPixelType() );
       
       image.SetPixelSize( pixelSize );
       
@@ -113,8 +97,15 @@ public class BioFormatsInterface {
       image.Forge();
       ByteBuffer buf = image.Origin();
       
-      for (int ii=0; ii < reader.getImageCount(); ii++)
-        buf.put( reader.openBytes( ii ) );
+      int bytes = FormatTools.getBytesPerPixel( reader.getPixelType() );
+      boolean swap = NeedsByteSwap( reader, bytes );
+      for (int ii=0; ii < reader.getImageCount(); ii++) {
+        byte[] plane = reader.openBytes( ii );
+        if ( swap ) {
+           SwapBytes( plane, bytes );
+        }
+        buf.put( plane );
+      }
         
       FileInformation info = new FileInformation();
       info.name = file;
@@ -135,6 +126,184 @@ public class BioFormatsInterface {
       return info;
    }
 
+   /// Reads the planes `ranges[6..8]` from series `series`, and the region `ranges[0..5]` within each plane.
+   ///
+   /// `ranges` contains the start, stop and step for x, y and the plane index, in that order. Negative
+   /// start and stop values count from the end, as in `dip::Range`. Each plane is read with a single call
+   /// to Bio-Formats, into a buffer that is reused for all planes, and copied into the image's memory.
+   public static FileInformation ReadROI( String file, long pointer, int series, long[] ranges ) throws Exception {
+      DebugTools.setRootLevel("warn") ;
+   
+      final Image image = new Image( pointer );
+      final ImageReader reader = new ImageReader();
+      
+      ServiceFactory factory = new ServiceFactory();
+      OMEXMLService service = factory.getInstance( OMEXMLService.class );
+      IMetadata meta = service.createOMEXMLMetadata();
+
+      reader.setMetadataStore( meta );
+      reader.setId( file );
+      
+      try {
+         if ( series < 0 || series >= reader.getSeriesCount() ) {
+            throw new IllegalArgumentException( "Series index out of range" );
+         }
+         reader.setSeries( series );
+         
+         // { offset, step, count } for each dimension
+         long[] x = FixRange( ranges[ 0 ], ranges[ 1 ], ranges[ 2 ], reader.getSizeX() );
+         long[] y = FixRange( ranges[ 3 ], ranges[ 4 ], ranges[ 5 ], reader.getSizeY() );
+         long[] p = FixRange( ranges[ 6 ], ranges[ 7 ], ranges[ 8 ], reader.getImageCount() );
+         int channels = reader.getRGBChannelCount();
+         int bytes = FormatTools.getBytesPerPixel( reader.getPixelType() );
+         boolean interleaved = reader.isInterleaved();
+         
+         // The image is laid out exactly like the data we get from the reader, one plane after the other
+         long planeSize = x[ 2 ] * y[ 2 ] * channels;
+         long[] sizes = { x[ 2 ], y[ 2 ], p[ 2 ] };
+         long[] strides;
+         if ( interleaved ) {
+            strides = new long[] { channels, x[ 2 ] * channels, planeSize };
+            image.SetTensorStride( 1 );
+         } else {
+            strides = new long[] { 1, x[ 2 ], planeSize };
+            image.SetTensorStride( x[ 2 ] * y[ 2 ] );
+         }
+         PhysicalQuantity[] pixelSize = { GetPhysicalQuantity( meta.getPixelsPhysicalSizeX( series ) ),
+                                          GetPhysicalQuantity( meta.getPixelsPhysicalSizeY( series ) ),
+                                          GetPhysicalQuantity( meta.getPixelsPhysicalSizeZ( series ) ) };
+         int nDims = p[ 2 ] == 1 ? 2 : 3;
+         image.SetSizes( Arrays.copyOfRange( sizes, 0, nDims ) );
+         image.SetStrides( Arrays.copyOfRange( strides, 0, nDims ) );
+         image.SetTensorSizes( channels );
+         SetDataType( image, reader.getPixelType() );
+         image.SetPixelSize( Arrays.copyOfRange( pixelSize, 0, nDims ) );
+         
+         // Assume that 3-channel images are RGB
+         if ( channels == 3 ) {
+            image.SetColorSpace( "RGB" );
+         }
+         
+         image.Forge();
+         ByteBuffer buf = image.Origin();
+         
+         // The region spanned by the ROI is read in one go, and subsampled here if necessary
+         int spanX = (int)(( x[ 2 ] - 1 ) * x[ 1 ] + 1 );
+         int spanY = (int)(( y[ 2 ] - 1 ) * y[ 1 ] + 1 );
+         long spanSize = (long) spanX * spanY * channels * bytes;
+         if ( spanSize > Integer.MAX_VALUE ) {
+            throw new IllegalArgumentException( "Region of interest too large to read in one plane" );
+         }
+         byte[] span = new byte[ (int) spanSize ];
+         boolean subsample = x[ 1 ] > 1 || y[ 1 ] > 1;
+         byte[] plane = subsample ? new byte[ (int)( planeSize * bytes ) ] : span;
+         boolean swap = NeedsByteSwap( reader, bytes );
+         
+         for ( long ii = 0; ii < p[ 2 ]; ++ii ) {
+            int no = (int)( p[ 0 ] + ii * p[ 1 ] );
+            reader.openBytes( no, span, (int) x[ 0 ], (int) y[ 0 ], spanX, spanY );
+            if ( subsample ) {
+               Subsample( span, plane, spanX, spanY, x, y, channels, bytes, interleaved );
+            }
+            if ( swap ) {
+               SwapBytes( plane, bytes );
+            }
+            buf.put( plane );
+         }
+         
+         FileInformation info = new FileInformation();
+         info.name = file;
+         info.fileType = reader.getFormat();
+         info.dataType = image.DataType();
+         info.significantBits = meta.getPixelsSignificantBits( series ).getValue();
+         info.sizes = image.Sizes();
+         info.tensorElements = channels;
+         info.colorSpace = image.ColorSpace();
+         info.pixelSize = image.PixelSize();
+         info.numberOfImages = reader.getImageCount();
+         // How the planes are organized, so that the caller can compute plane indices for given Z, C and T
+         info.history = new String[] { "DimensionOrder\t" + reader.getDimensionOrder(),
+                                       "SizeZ\t" + reader.getSizeZ(),
+                                       "SizeC\t" + reader.getEffectiveSizeC(),
+                                       "SizeT\t" + reader.getSizeT() };
+         
+         return info;
+      } finally {
+         reader.close();
+      }
+   }
+
+   protected static void SetDataType( Image image, int pixelType ) {
+      switch ( pixelType ) {
+         case FormatTools.INT8:   image.SetDataType( "INT8" );
+                                  break;
+         case FormatTools.UINT8:  image.SetDataType( "UINT8" );
+                                  break;
+         case FormatTools.INT16:  image.SetDataType( "INT16" );
+                                  break;
+         case FormatTools.UINT16: image.SetDataType( "UINT16" );
+                                  break;
+         case FormatTools.INT32:  image.SetDataType( "INT32" );
+                                  break;
+         case FormatTools.UINT32: image.SetDataType( "UINT32" );
+                                  break;
+         case FormatTools.FLOAT:  image.SetDataType( "SFLOAT" );
+                                  break;
+         case FormatTools.DOUBLE: image.SetDataType( "DFLOAT" );
+                                  break;
+      }
+   }
+
+   /// Returns { offset, step, count } for the range { start, stop, step } over `size` elements.
+   protected static long[] FixRange( long start, long stop, long step, long size ) {
+      if ( start < 0 ) {
+         start += size;
+      }
+      if ( stop < 0 ) {
+         stop += size;
+      }
+      if ( start < 0 || start >= size || stop < start || stop >= size || step < 1 ) {
+         throw new IllegalArgumentException( "Range out of bounds" );
+      }
+      long[] out = { start, step, ( stop - start ) / step + 1 };
+      return out;
+   }
+
+   /// Copies every `x[1]`-th pixel of every `y[1]`-th row of `span` to `plane`.
+   protected static void Subsample( byte[] span, byte[] plane, int spanX, int spanY, long[] x, long[] y,
+                                    int channels, int bytes, boolean interleaved ) {
+      // In interleaved data a pixel is `channels * bytes` consecutive bytes, otherwise each channel is a separate block
+      int pixel = interleaved ? channels * bytes : bytes;
+      int blocks = interleaved ? 1 : channels;
+      int pos = 0;
+      for ( int cc = 0; cc < blocks; ++cc ) {
+         int block = cc * spanX * spanY * pixel;
+         for ( long jj = 0; jj < y[ 2 ]; ++jj ) {
+            int row = block + (int)( jj * y[ 1 ] ) * spanX * pixel;
+            for ( long ii = 0; ii < x[ 2 ]; ++ii ) {
+               System.arraycopy( span, row + (int)( ii * x[ 1 ] ) * pixel, plane, pos, pixel );
+               pos += pixel;
+            }
+         }
+      }
+   }
+
+   /// True if samples of `bytes` bytes read by `reader` are not in the native byte order.
+   protected static boolean NeedsByteSwap( ImageReader reader, int bytes ) {
+      return ( bytes > 1 ) && ( reader.isLittleEndian() != ( ByteOrder.nativeOrder() == ByteOrder.LITTLE_ENDIAN ));
+   }
+
+   /// Converts each `bytes`-byte sample in `data` from the file's byte order to the native one.
+   protected static void SwapBytes( byte[] data, int bytes ) {
+      for ( int ii = 0; ii < data.length; ii += bytes ) {
+         for ( int jj = 0; jj < bytes / 2; ++jj ) {
+            byte tmp = data[ ii + jj ];
+            data[ ii + jj ] = data[ ii + bytes - 1 - jj ];
+            data[ ii + bytes - 1 - jj ] = tmp;
+         }
+      }
+   }
+
    protected static PhysicalQuantity GetPhysicalQuantity( Length length ) {
       if ( length == null ) {
          return new PhysicalQuantity( 1, "px" );
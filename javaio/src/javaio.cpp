@@ -21,6 +21,7 @@
 #include "diplib/javaio.h"
 #include "image.h"
 #include "fileinformation.h"
+#include "tools.h"
 
 #include <jni.h>
 #include <dlfcn.h>
@@ -83,16 +84,9 @@ JNIEnv *GetEnv() {
    return env;
 }
 
-} // namespace
-
-FileInformation ImageReadJavaIO(
-      Image& out,
-      String const& filename,
-      String const& interface
-) {
-   JNIEnv *env = GetEnv();
-   
-   jclass cls = env->FindClass( interface.c_str() );
+// Finds the static method `name` in the class `interface`
+jmethodID GetInterfaceMethod( JNIEnv *env, String const& interface, char const* name, char const* signature, jclass& cls ) {
+   cls = env->FindClass( interface.c_str() );
    
    if ( env->ExceptionOccurred() ) {
       env->ExceptionDescribe();
@@ -100,28 +94,187 @@ FileInformation ImageReadJavaIO(
       DIP_THROW_RUNTIME( "Reading JavaIO file: cannot find interface class (is it supported?)" );
    }   
    
-   jmethodID mid = env->GetStaticMethodID( cls, "Read", "(Ljava/lang/String;J)Lorg/diplib/FileInformation;" );
+   jmethodID mid = env->GetStaticMethodID( cls, name, signature );
 
    if ( env->ExceptionOccurred() ) {
       env->ExceptionDescribe();
       env->ExceptionClear();
-      DIP_THROW_RUNTIME( "Reading JavaIO file: cannot find interface class's Read method" );
+      DIP_THROW_RUNTIME( "Reading JavaIO file: cannot find interface class's " + String( name ) + " method" );
    }   
+   
+   return mid;
+}
 
-   // Call reader
-   out.Strip();
-   jobject obj = env->CallStaticObjectMethod( cls, mid, env->NewStringUTF( filename.c_str() ), &out );
+// Hands the data segment of `out` to an image being forged with the same sizes, number of tensor elements,
+// data type and strides. For any other layout it leaves `origin` unset, so that the image allocates its own data.
+class ReuseDataInterface : public ExternalInterface {
+   public:
+      explicit ReuseDataInterface( Image const& out ) : out_( out ) {}
+
+      DataSegment AllocateData(
+            void*& origin,
+            dip::DataType dataType,
+            UnsignedArray const& sizes,
+            IntegerArray& strides,
+            dip::Tensor const& tensor,
+            dip::sint& tensorStride
+      ) override {
+         if(( dataType != out_.DataType() ) || ( sizes != out_.Sizes() ) || ( strides != out_.Strides() ) ||
+            ( tensor.Elements() != out_.TensorElements() )) {
+            return nullptr;
+         }
+         if( tensor.Elements() == 1 ) {
+            tensorStride = out_.TensorStride(); // Not used, but this makes the two images an identical view
+         } else if( tensorStride != out_.TensorStride() ) {
+            return nullptr;
+         }
+         origin = out_.Origin();
+         return NonOwnedRefToDataSegment( out_.Data() );
+      }
+
+   private:
+      Image const& out_;
+};
+
+// Calls the reader method `mid`, which forges the image passed to it and writes the pixel data. The Java side
+// sets the sizes and strides itself, so it needs a raw image. If `out` is forged, a raw temporary image is
+// passed instead. When the Java side forges it with the sizes, number of tensor elements, data type and strides
+// of `out`, the temporary image is given the data segment of `out`, and the data are written there directly.
+// Otherwise, the data are written into a new data segment and copied into `out`. Like `dip::Image::ReForge`,
+// this reuses the data segment of `out` if it has the right sizes, number of tensor elements and data type,
+// and throws if `out` is protected and doesn't match.
+template< typename... Args >
+jobject CallReader( JNIEnv *env, jclass cls, jmethodID mid, Image& out, char const* method, String const& filename, Args... args ) {
+   ReuseDataInterface reuseData( out );
+   Image tmp;
+   if( out.IsForged() ) {
+      tmp.SetExternalInterface( &reuseData );
+   }
+   Image& dest = out.IsForged() ? tmp : out;
+   jobject obj = env->CallStaticObjectMethod( cls, mid, env->NewStringUTF( filename.c_str() ), &dest, args... );
 
    if ( env->ExceptionOccurred() ) {
       env->ExceptionDescribe();
       env->ExceptionClear();
-      out.Strip();
-      DIP_THROW_RUNTIME( "Reading JavaIO file: error calling interface class's Read method" );
+      dest.Strip();
+      DIP_THROW_RUNTIME( "Reading JavaIO file: error calling interface class's " + String( method ) + " method" );
    }
-   
+
+   if( &dest == &tmp ) {
+      if( tmp.IsIdenticalView( out )) {
+         // The data were written into `out` directly
+         out.CopyNonDataProperties( tmp );
+      } else {
+         DIP_START_STACK_TRACE
+            out.ReForge( tmp );
+            out.Copy( tmp );
+         DIP_END_STACK_TRACE
+      }
+   }
+   return obj;
+}
+
+} // namespace
+
+FileInformation ImageReadJavaIO(
+      Image& out,
+      String const& filename,
+      String const& interface
+) {
+   JNIEnv *env = GetEnv();
+   jclass cls;
+   jmethodID mid = GetInterfaceMethod( env, interface, "Read", "(Ljava/lang/String;J)Lorg/diplib/FileInformation;", cls );
+
+   // Call reader
+   jobject obj = CallReader( env, cls, mid, out, "Read", filename );
+   return FileInformationFromJava( env, obj );
+}
+
+FileInformation ImageReadJavaIO(
+      Image& out,
+      String const& filename,
+      Range const& imageNumbers,
+      RangeArray const& roi,
+      dip::uint series,
+      String const& interface
+) {
+   // Start, stop and step for x, y and the plane index. Ranges are checked on the Java side, which knows the sizes.
+   RangeArray ranges = roi;
+   if( ranges.empty() ) {
+      ranges.resize( 2 );
+   } else if( ranges.size() == 1 ) {
+      ranges.push_back( ranges[ 0 ] );
+   }
+   DIP_THROW_IF( ranges.size() != 2, E::ARRAY_PARAMETER_WRONG_LENGTH );
+   ranges.push_back( imageNumbers );
+   IntegerArray rangeValues;
+   for( auto const& range : ranges ) {
+      rangeValues.push_back( range.start );
+      rangeValues.push_back( range.stop );
+      rangeValues.push_back( static_cast< dip::sint >( range.step ));
+   }
+   DIP_THROW_IF( series > static_cast< dip::uint >( std::numeric_limits< jint >::max() ), E::INDEX_OUT_OF_RANGE );
+
+   JNIEnv *env = GetEnv();
+   jclass cls;
+   jmethodID mid = GetInterfaceMethod( env, interface, "ReadROI", "(Ljava/lang/String;JI[J)Lorg/diplib/FileInformation;", cls );
+
+   // Call reader
+   jobject obj = CallReader( env, cls, mid, out, "ReadROI", filename,
+                             static_cast< jint >( series ), IntegerArrayToJava( env, rangeValues ));
    return FileInformationFromJava( env, obj );
 }
 
 } // namespace javaio
 
 } // namespace dip
+
+
+#if defined( DIP__ENABLE_DOCTEST ) && defined( DIP__JAVAIO_HAS_BIOFORMATS )
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/random.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPjavaio] testing ImageReadJavaIO with Bio-Formats") {
+   dip::Image image( { 30, 20, 6 }, 1, dip::DT_UINT16 );
+   image.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( image, image, random, 0, 60000 );
+   dip::testing::TemporaryFiles files;
+   dip::String filename = files.Name( "javaio.ics" );
+   files.Name( "javaio.ids" );
+   dip::ImageWriteICS( image, filename, {}, 0, { "v1", "uncompressed" } );
+
+   // Full image
+   dip::Image result;
+   dip::FileInformation info = dip::javaio::ImageReadJavaIO( result, filename );
+   DOCTEST_CHECK( dip::testing::CompareImages( image, result ));
+
+   // Subset of planes and a region within each plane
+   info = dip::javaio::ImageReadJavaIO( result, filename, dip::Range{ 1, 5, 2 }, { dip::Range{ 2, 21, 3 }, dip::Range{} } );
+   DOCTEST_CHECK( dip::testing::CompareImages( image.At( dip::Range{ 2, 21, 3 }, dip::Range{}, dip::Range{ 1, 5, 2 } ), result ));
+   DOCTEST_CHECK( info.numberOfImages == 6 );
+   DOCTEST_CHECK( std::find( info.history.begin(), info.history.end(), "SizeZ\t6" ) != info.history.end() );
+
+   // A protected image of the right sizes and data type is reused
+   dip::Image out( { 30, 20, 6 }, 1, dip::DT_UINT16 );
+   out.Protect();
+   void const* origin = out.Origin();
+   dip::javaio::ImageReadJavaIO( out, filename );
+   DOCTEST_CHECK( out.Origin() == origin );
+   DOCTEST_CHECK( dip::testing::CompareImages( image, out ));
+   // ... also if its strides differ from the ones the reader uses
+   dip::Image permuted( { 20, 30, 6 }, 1, dip::DT_UINT16 );
+   permuted.PermuteDimensions( { 1, 0, 2 } );
+   origin = permuted.Origin();
+   dip::javaio::ImageReadJavaIO( permuted, filename );
+   DOCTEST_CHECK( permuted.Origin() == origin );
+   DOCTEST_CHECK( dip::testing::CompareImages( image, permuted ));
+   // ... and one of the wrong sizes causes an exception
+   dip::Image wrong( { 30, 20 }, 1, dip::DT_UINT16 );
+   wrong.Protect();
+   DOCTEST_CHECK_THROWS( dip::javaio::ImageReadJavaIO( wrong, filename ));
+}
+
+#endif // DIP__ENABLE_DOCTEST && DIP__JAVAIO_HAS_BIOFORMATS
@@ -68,47 +68,47 @@ void init_analysis( py::module& m ) {
             } );
 
    m.def( "SubpixelLocation", &dip::SubpixelLocation,
-          "in"_a, "position"_a, "polarity"_a = dip::S::MAXIMUM, "method"_a = dip::S::PARABOLIC_SEPARABLE );
+          "in"_a, "position"_a, "polarity"_a = dip::S::MAXIMUM, "method"_a = dip::S::PARABOLIC_SEPARABLE, ReleaseGIL() );
    m.def( "SubpixelMaxima", &dip::SubpixelMaxima,
-          "in"_a, "mask"_a = dip::Image{}, "method"_a = dip::S::PARABOLIC_SEPARABLE );
+          "in"_a, "mask"_a = dip::Image{}, "method"_a = dip::S::PARABOLIC_SEPARABLE, ReleaseGIL() );
    m.def( "SubpixelMinima", &dip::SubpixelMinima,
-          "in"_a, "mask"_a = dip::Image{}, "method"_a = dip::S::PARABOLIC_SEPARABLE );
+          "in"_a, "mask"_a = dip::Image{}, "method"_a = dip::S::PARABOLIC_SEPARABLE, ReleaseGIL() );
    m.def( "MeanShift", py::overload_cast< dip::Image const&, dip::FloatArray const&, dip::dfloat >( &dip::MeanShift ),
-          "meanShiftVectorResult"_a, "start"_a, "epsilon"_a = 1e-3 );
+          "meanShiftVectorResult"_a, "start"_a, "epsilon"_a = 1e-3, ReleaseGIL() );
    m.def( "MeanShift", py::overload_cast< dip::Image const&, dip::FloatCoordinateArray const&, dip::dfloat >( &dip::MeanShift ),
-          "meanShiftVectorResult"_a, "startArray"_a, "epsilon"_a = 1e-3 );
+          "meanShiftVectorResult"_a, "startArray"_a, "epsilon"_a = 1e-3, ReleaseGIL() );
    m.def( "CrossCorrelationFT", py::overload_cast< dip::Image const&, dip::Image const&, dip::String const&, dip::String const&, dip::String const&, dip::String const& >( &dip::CrossCorrelationFT ),
-          "in1"_a, "in2"_a, "in1Representation"_a = dip::S::SPATIAL, "in2Representation"_a = dip::S::SPATIAL, "outRepresentation"_a = dip::S::SPATIAL, "normalize"_a = dip::S::NORMALIZE );
+          "in1"_a, "in2"_a, "in1Representation"_a = dip::S::SPATIAL, "in2Representation"_a = dip::S::SPATIAL, "outRepresentation"_a = dip::S::SPATIAL, "normalize"_a = dip::S::NORMALIZE, ReleaseGIL() );
    m.def( "FindShift", &dip::FindShift,
-          "in1"_a, "in2"_a, "method"_a = "MTS", "parameter"_a = 0, "maxShift"_a = dip::UnsignedArray{ std::numeric_limits< dip::uint >::max() } );
+          "in1"_a, "in2"_a, "method"_a = "MTS", "parameter"_a = 0, "maxShift"_a = dip::UnsignedArray{ std::numeric_limits< dip::uint >::max() }, ReleaseGIL() );
    m.def( "FourierMellinMatch2D", py::overload_cast< dip::Image const&, dip::Image const&, dip::String const& >( &dip::FourierMellinMatch2D ),
-          "in1"_a, "in2"_a, "interpolationMethod"_a = dip::S::LINEAR );
+          "in1"_a, "in2"_a, "interpolationMethod"_a = dip::S::LINEAR, ReleaseGIL() );
 
    m.def( "StructureTensor", py::overload_cast< dip::Image const&, dip::Image const&, dip::FloatArray const&, dip::FloatArray const&, dip::String const&, dip::StringArray const&, dip::dfloat >( &dip::StructureTensor ),
-          "in"_a, "mask"_a = dip::Image{}, "gradientSigmas"_a = dip::FloatArray{ 1.0 }, "tensorSigmas"_a = dip::FloatArray{ 5.0 }, "method"_a = dip::S::BEST, "boundaryCondition"_a = dip::StringArray{}, "truncation"_a = 3.0 );
+          "in"_a, "mask"_a = dip::Image{}, "gradientSigmas"_a = dip::FloatArray{ 1.0 }, "tensorSigmas"_a = dip::FloatArray{ 5.0 }, "method"_a = dip::S::BEST, "boundaryCondition"_a = dip::StringArray{}, "truncation"_a = 3.0, ReleaseGIL() );
    m.def( "StructureTensorAnalysis", py::overload_cast< dip::Image const&, dip::StringArray const& >( &dip::StructureTensorAnalysis ),
-          "in"_a, "outputs"_a );
+          "in"_a, "outputs"_a, ReleaseGIL() );
    m.def( "StructureAnalysis", &dip::StructureAnalysis,
           "in"_a, "mask"_a = dip::Image{}, "scales"_a = std::vector< dip::dfloat >{}, "feature"_a = "energy",
-          "gradientSigmas"_a = dip::FloatArray{ 1.0 }, "method"_a = dip::S::BEST, "boundaryCondition"_a = dip::StringArray{}, "truncation"_a = 3.0 );
+          "gradientSigmas"_a = dip::FloatArray{ 1.0 }, "method"_a = dip::S::BEST, "boundaryCondition"_a = dip::StringArray{}, "truncation"_a = 3.0, ReleaseGIL() );
    m.def( "MonogenicSignal", py::overload_cast< dip::Image const&, dip::FloatArray const&, dip::dfloat, dip::String const&, dip::String const& >( &dip::MonogenicSignal ),
-          "in"_a, "wavelengths"_a = dip::FloatArray{ 3.0, 24.0 }, "bandwidth"_a = 0.41, "inRepresentation"_a = dip::S::SPATIAL, "outRepresentation"_a = dip::S::SPATIAL );
+          "in"_a, "wavelengths"_a = dip::FloatArray{ 3.0, 24.0 }, "bandwidth"_a = 0.41, "inRepresentation"_a = dip::S::SPATIAL, "outRepresentation"_a = dip::S::SPATIAL, ReleaseGIL() );
    m.def( "MonogenicSignalAnalysis", py::overload_cast< dip::Image const&, dip::StringArray const&, dip::dfloat, dip::dfloat, dip::dfloat, dip::dfloat, dip::String const& >( &dip::MonogenicSignalAnalysis ),
-          "in"_a, "outputs"_a, "noiseThreshold"_a = 0.2, "frequencySpreadThreshold"_a = 0.5, "sigmoidParameter"_a = 10, "deviationGain"_a = 1.5, "polarity"_a = dip::S::BOTH );
+          "in"_a, "outputs"_a, "noiseThreshold"_a = 0.2, "frequencySpreadThreshold"_a = 0.5, "sigmoidParameter"_a = 10, "deviationGain"_a = 1.5, "polarity"_a = dip::S::BOTH, ReleaseGIL() );
 
    m.def( "PairCorrelation", &dip::PairCorrelation,
-          "object"_a, "mask"_a = dip::Image{}, "probes"_a = 1000000, "length"_a = 100, "sampling"_a = dip::S::RANDOM, "options"_a = dip::StringSet{} );
+          "object"_a, "mask"_a = dip::Image{}, "probes"_a = 1000000, "length"_a = 100, "sampling"_a = dip::S::RANDOM, "options"_a = dip::StringSet{}, ReleaseGIL() );
    m.def( "ProbabilisticPairCorrelation", &dip::ProbabilisticPairCorrelation,
-          "object"_a, "mask"_a = dip::Image{}, "probes"_a = 1000000, "length"_a = 100, "sampling"_a = dip::S::RANDOM, "options"_a = dip::StringSet{} );
+          "object"_a, "mask"_a = dip::Image{}, "probes"_a = 1000000, "length"_a = 100, "sampling"_a = dip::S::RANDOM, "options"_a = dip::StringSet{}, ReleaseGIL() );
    m.def( "Semivariogram", &dip::Semivariogram,
-          "object"_a, "mask"_a = dip::Image{}, "probes"_a = 1000000, "length"_a = 100, "sampling"_a = dip::S::RANDOM );
+          "object"_a, "mask"_a = dip::Image{}, "probes"_a = 1000000, "length"_a = 100, "sampling"_a = dip::S::RANDOM, ReleaseGIL() );
    m.def( "ChordLength", &dip::ChordLength,
-          "object"_a, "mask"_a = dip::Image{}, "probes"_a = 1000000, "length"_a = 100, "sampling"_a = dip::S::RANDOM );
+          "object"_a, "mask"_a = dip::Image{}, "probes"_a = 1000000, "length"_a = 100, "sampling"_a = dip::S::RANDOM, ReleaseGIL() );
    m.def( "DistanceDistribution", &dip::DistanceDistribution,
-          "object"_a, "region"_a, "length"_a = 100 );
+          "object"_a, "region"_a, "length"_a = 100, ReleaseGIL() );
    m.def( "Granulometry", &dip::Granulometry,
-          "in"_a, "mask"_a = dip::Image{}, "scales"_a = std::vector< dip::dfloat >{}, "type"_a = "isotropic", "polarity"_a = dip::S::OPENING, "options"_a = dip::StringSet{} );
-   m.def( "FractalDimension", &dip::FractalDimension, "in"_a, "eta"_a = 0.5 );
+          "in"_a, "mask"_a = dip::Image{}, "scales"_a = std::vector< dip::dfloat >{}, "type"_a = "isotropic", "polarity"_a = dip::S::OPENING, "options"_a = dip::StringSet{}, ReleaseGIL() );
+   m.def( "FractalDimension", &dip::FractalDimension, "in"_a, "eta"_a = 0.5, ReleaseGIL() );
 
    // diplib/detection.h
 
@@ -122,13 +122,13 @@ void init_analysis( py::module& m ) {
    } );
 
    m.def( "HoughTransformCircleCenters", py::overload_cast< dip::Image const&, dip::Image const&, dip::UnsignedArray const& >( &dip::HoughTransformCircleCenters ),
-          "in"_a, "gv"_a, "range"_a = dip::UnsignedArray{} );
+          "in"_a, "gv"_a, "range"_a = dip::UnsignedArray{}, ReleaseGIL() );
    m.def( "FindHoughMaxima", py::overload_cast< dip::Image const&, dip::dfloat >( &dip::FindHoughMaxima ),
-          "in"_a, "distance"_a );
+          "in"_a, "distance"_a, ReleaseGIL() );
    m.def( "PointDistanceDistribution", py::overload_cast< dip::Image const&, dip::CoordinateArray const&, dip::UnsignedArray >( &dip::PointDistanceDistribution ),
-          "in"_a, "points"_a, "range"_a = dip::UnsignedArray{} );
+          "in"_a, "points"_a, "range"_a = dip::UnsignedArray{}, ReleaseGIL() );
    m.def( "FindHoughCircles", py::overload_cast< dip::Image const&, dip::Image const&, dip::UnsignedArray const&, dip::dfloat >( &dip::FindHoughCircles ),
-          "in"_a, "gv"_a, "range"_a, "distance"_a );
+          "in"_a, "gv"_a, "range"_a, "distance"_a, ReleaseGIL() );
           
    m.def( "RadonTransformCircles", []( dip::Image const& in, dip::Range radii, dip::dfloat sigma, dip::dfloat threshold, dip::String const& mode, dip::StringSet const& options ) {
              dip::Image out;
@@ -137,99 +137,99 @@ void init_analysis( py::module& m ) {
           }, "in"_a, "radii"_a = dip::Range{ 10, 30 }, "sigma"_a = 1.0, "threshold"_a = 1.0, "mode"_a = dip::S::FULL, "options"_a = dip::StringSet{ dip::S::NORMALIZE, dip::S::CORRECT } );
 
    m.def( "HarrisCornerDetector", py::overload_cast< dip::Image const&, dip::dfloat, dip::FloatArray const&, dip::StringArray const& >( &dip::HarrisCornerDetector ),
-          "in"_a, "kappa"_a = 0.04, "sigmas"_a = dip::FloatArray{ 2.0 }, "boundaryCondition"_a = dip::StringArray{} );
+          "in"_a, "kappa"_a = 0.04, "sigmas"_a = dip::FloatArray{ 2.0 }, "boundaryCondition"_a = dip::StringArray{}, ReleaseGIL() );
    m.def( "ShiTomasiCornerDetector", py::overload_cast< dip::Image const&, dip::FloatArray const&, dip::StringArray const& >( &dip::ShiTomasiCornerDetector ),
-          "in"_a, "sigmas"_a = dip::FloatArray{ 2.0 }, "boundaryCondition"_a = dip::StringArray{} );
+          "in"_a, "sigmas"_a = dip::FloatArray{ 2.0 }, "boundaryCondition"_a = dip::StringArray{}, ReleaseGIL() );
    m.def( "NobleCornerDetector", py::overload_cast< dip::Image const&, dip::FloatArray const&, dip::StringArray const& >( &dip::NobleCornerDetector ),
-          "in"_a, "sigmas"_a = dip::FloatArray{ 2.0 }, "boundaryCondition"_a = dip::StringArray{} );
+          "in"_a, "sigmas"_a = dip::FloatArray{ 2.0 }, "boundaryCondition"_a = dip::StringArray{}, ReleaseGIL() );
    m.def( "WangBradyCornerDetector", py::overload_cast< dip::Image const&, dip::dfloat, dip::FloatArray const&, dip::StringArray const& >( &dip::WangBradyCornerDetector ),
-          "in"_a, "threshold"_a = 0.1, "sigmas"_a = dip::FloatArray{ 2.0 }, "boundaryCondition"_a = dip::StringArray{} );
+          "in"_a, "threshold"_a = 0.1, "sigmas"_a = dip::FloatArray{ 2.0 }, "boundaryCondition"_a = dip::StringArray{}, ReleaseGIL() );
 
    m.def( "FrangiVesselness", py::overload_cast< dip::Image const&, dip::FloatArray const&, dip::FloatArray const&, dip::String const&, dip::StringArray const& >( &dip::FrangiVesselness ),
-          "in"_a, "sigmas"_a = dip::FloatArray{ 2.0 }, "parameters"_a = dip::FloatArray{}, "polarity"_a = dip::S::WHITE, "boundaryCondition"_a = dip::StringArray{} );
+          "in"_a, "sigmas"_a = dip::FloatArray{ 2.0 }, "parameters"_a = dip::FloatArray{}, "polarity"_a = dip::S::WHITE, "boundaryCondition"_a = dip::StringArray{}, ReleaseGIL() );
    m.def( "MatchedFiltersLineDetector2D", py::overload_cast< dip::Image const&, dip::dfloat, dip::dfloat, dip::String const&, dip::StringArray const& >( &dip::MatchedFiltersLineDetector2D ),
-          "in"_a, "sigma"_a = 2.0, "length"_a = 10.0, "polarity"_a = dip::S::WHITE, "boundaryCondition"_a = dip::StringArray{} );
+          "in"_a, "sigma"_a = 2.0, "length"_a = 10.0, "polarity"_a = dip::S::WHITE, "boundaryCondition"_a = dip::StringArray{}, ReleaseGIL() );
    m.def( "DanielssonLineDetector", py::overload_cast< dip::Image const&, dip::FloatArray const&, dip::String const&, dip::StringArray const& >( &dip::DanielssonLineDetector ),
-          "in"_a, "sigmas"_a = dip::FloatArray{ 2.0 }, "polarity"_a = dip::S::WHITE, "boundaryCondition"_a = dip::StringArray{} );
+          "in"_a, "sigmas"_a = dip::FloatArray{ 2.0 }, "polarity"_a = dip::S::WHITE, "boundaryCondition"_a = dip::StringArray{}, ReleaseGIL() );
    m.def( "RORPOLineDetector", py::overload_cast< dip::Image const&, dip::uint, dip::String const& >( &dip::RORPOLineDetector ),
-          "in"_a, "length"_a = 15, "polarity"_a = dip::S::WHITE );
+          "in"_a, "length"_a = 15, "polarity"_a = dip::S::WHITE, ReleaseGIL() );
 
    // diplib/distance.h
 
    m.def( "EuclideanDistanceTransform", py::overload_cast< dip::Image const&, dip::String const&, dip::String const& >( &dip::EuclideanDistanceTransform ),
-          "in"_a, "border"_a = dip::S::BACKGROUND, "method"_a = dip::S::SEPARABLE );
+          "in"_a, "border"_a = dip::S::BACKGROUND, "method"_a = dip::S::SEPARABLE, ReleaseGIL() );
    m.def( "VectorDistanceTransform", py::overload_cast< dip::Image const&, dip::String const&, dip::String const& >( &dip::VectorDistanceTransform ),
-          "in"_a, "border"_a = dip::S::BACKGROUND, "method"_a = dip::S::FAST );
+          "in"_a, "border"_a = dip::S::BACKGROUND, "method"_a = dip::S::FAST, ReleaseGIL() );
    m.def( "GreyWeightedDistanceTransform", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const&, dip::Metric const&, dip::String const& >( &dip::GreyWeightedDistanceTransform ),
-          "grey"_a, "bin"_a, "mask"_a = dip::Image{}, "metric"_a = dip::Metric{}, "outputMode"_a = dip::S::FASTMARCHING );
-   m.def( "GeodesicDistanceTransform", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::GeodesicDistanceTransform ),
-          "marker"_a, "condition"_a );
+          "grey"_a, "bin"_a, "mask"_a = dip::Image{}, "metric"_a = dip::Metric{}, "outputMode"_a = dip::S::FASTMARCHING, ReleaseGIL() );
+   m.def( "GeodesicDistanceTransform", py::overload_cast< dip::Image const&, dip::Image const&, dip::String const& >( &dip::GeodesicDistanceTransform ),
+          "marker"_a, "condition"_a, "mode"_a = dip::S::FASTMARCHING, ReleaseGIL() );
 
    // diplib/microscopy.h
 
    m.def( "BeerLambertMapping", py::overload_cast< dip::Image const&, dip::Image::Pixel const& >( &dip::BeerLambertMapping ),
-          "in"_a, "background"_a );
+          "in"_a, "background"_a, ReleaseGIL() );
    m.def( "InverseBeerLambertMapping", py::overload_cast< dip::Image const&, dip::Image::Pixel const& >( &dip::InverseBeerLambertMapping ),
-          "in"_a, "background"_a = dip::Image::Pixel{ 255 } );
+          "in"_a, "background"_a = dip::Image::Pixel{ 255 }, ReleaseGIL() );
    m.def( "UnmixStains", py::overload_cast< dip::Image const&, std::vector< dip::Image::Pixel > const& >( &dip::UnmixStains ),
-          "in"_a, "stains"_a );
+          "in"_a, "stains"_a, ReleaseGIL() );
    m.def( "MixStains", py::overload_cast< dip::Image const&, std::vector< dip::Image::Pixel > const& >( &dip::MixStains ),
-          "in"_a, "stains"_a );
+          "in"_a, "stains"_a, ReleaseGIL() );
    m.def( "IncoherentOTF", py::overload_cast< dip::Image&, dip::dfloat, dip::dfloat, dip::dfloat, dip::String const& >( &dip::IncoherentOTF ),
-          "out"_a, "defocus"_a = 0.0, "oversampling"_a = 1.0, "amplitude"_a = 1.0, "method"_a = "Stokseth" );
+          "out"_a, "defocus"_a = 0.0, "oversampling"_a = 1.0, "amplitude"_a = 1.0, "method"_a = "Stokseth", ReleaseGIL() );
    m.def( "IncoherentPSF", py::overload_cast< dip::Image&, dip::dfloat, dip::dfloat >( &dip::IncoherentPSF ),
-          "out"_a, "oversampling"_a = 1.0, "amplitude"_a = 1.0 );
+          "out"_a, "oversampling"_a = 1.0, "amplitude"_a = 1.0, ReleaseGIL() );
    m.def( "ExponentialFitCorrection", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat, dip::String const&, dip::dfloat, dip::String const& >( &dip::ExponentialFitCorrection ),
-          "in"_a, "mask"_a = dip::Image{}, "percentile"_a = -1.0, "fromWhere"_a = "first plane", "hysteresis"_a = 1.0, "weighting"_a = "none" );
+          "in"_a, "mask"_a = dip::Image{}, "percentile"_a = -1.0, "fromWhere"_a = "first plane", "hysteresis"_a = 1.0, "weighting"_a = "none", ReleaseGIL() );
    m.def( "AttenuationCorrection", py::overload_cast< dip::Image const&, dip::dfloat, dip::dfloat, dip::dfloat, dip::dfloat, dip::dfloat, dip::dfloat, dip::String const& >( &dip::AttenuationCorrection ),
-          "in"_a, "fAttenuation"_a = 0.01, "bAttenuation"_a = 0.01, "background"_a = 0.0, "threshold"_a = 0.0, "NA"_a = 1.4, "refIndex"_a = 1.518, "method"_a = "DET" );
+          "in"_a, "fAttenuation"_a = 0.01, "bAttenuation"_a = 0.01, "background"_a = 0.0, "threshold"_a = 0.0, "NA"_a = 1.4, "refIndex"_a = 1.518, "method"_a = "DET", ReleaseGIL() );
    m.def( "SimulatedAttenuation", py::overload_cast< dip::Image const&, dip::dfloat, dip::dfloat, dip::dfloat, dip::dfloat, dip::uint, dip::dfloat >( &dip::SimulatedAttenuation ),
-          "in"_a, "fAttenuation"_a = 0.01, "bAttenuation"_a = 0.01, "NA"_a = 1.4, "refIndex"_a = 1.518, "oversample"_a = 1, "rayStep"_a = 1 );
+          "in"_a, "fAttenuation"_a = 0.01, "bAttenuation"_a = 0.01, "NA"_a = 1.4, "refIndex"_a = 1.518, "oversample"_a = 1, "rayStep"_a = 1, ReleaseGIL() );
 
    // diplib/regions.h
 
    m.def( "Label", py::overload_cast< dip::Image const&, dip::uint, dip::uint, dip::uint, dip::StringArray const& >( &dip::Label ),
-          "binary"_a, "connectivity"_a = 0, "minSize"_a = 0, "maxSize"_a = 0, "boundaryCondition"_a = dip::StringArray{} );
+          "binary"_a, "connectivity"_a = 0, "minSize"_a = 0, "maxSize"_a = 0, "boundaryCondition"_a = dip::StringArray{}, ReleaseGIL() );
    m.def( "GetObjectLabels", py::overload_cast< dip::Image const&, dip::Image const&, dip::String const& >( &dip::GetObjectLabels ),
-          "label"_a, "mask"_a = dip::Image{}, "background"_a = dip::S::EXCLUDE );
-   m.def( "Relabel", py::overload_cast< dip::Image const& >( &dip::Relabel ), "label"_a );
+          "label"_a, "mask"_a = dip::Image{}, "background"_a = dip::S::EXCLUDE, ReleaseGIL() );
+   m.def( "Relabel", py::overload_cast< dip::Image const& >( &dip::Relabel ), "label"_a, ReleaseGIL() );
    m.def( "SmallObjectsRemove", py::overload_cast< dip::Image const&, dip::uint, dip::uint >( &dip::SmallObjectsRemove ),
-          "in"_a, "threshold"_a, "connectivity"_a = 0 );
+          "in"_a, "threshold"_a, "connectivity"_a = 0, ReleaseGIL() );
    m.def( "GrowRegions", py::overload_cast< dip::Image const&, dip::Image const&, dip::sint, dip::uint >( &dip::GrowRegions ),
-          "label"_a, "mask"_a = dip::Image{}, "connectivity"_a = -1, "iterations"_a = 0 );
+          "label"_a, "mask"_a = dip::Image{}, "connectivity"_a = -1, "iterations"_a = 0, ReleaseGIL() );
    m.def( "GrowRegionsWeighted", py::overload_cast< dip::Image const&, dip::Image const&, dip::Image const&, dip::Metric const& >( &dip::GrowRegionsWeighted ),
-          "label"_a, "grey"_a, "mask"_a = dip::Image{}, "metric"_a = dip::Metric{ dip::S::CHAMFER, 2 } );
+          "label"_a, "grey"_a, "mask"_a = dip::Image{}, "metric"_a = dip::Metric{ dip::S::CHAMFER, 2 }, ReleaseGIL() );
 
    // diplib/segmentation.h
    m.def( "KMeansClustering", py::overload_cast< dip::Image const&, dip::uint >( &dip::KMeansClustering ),
-          "in"_a, "nClusters"_a = 2 );
+          "in"_a, "nClusters"_a = 2, ReleaseGIL() );
    m.def( "MinimumVariancePartitioning", py::overload_cast< dip::Image const&, dip::uint >( &dip::MinimumVariancePartitioning ),
-          "in"_a, "nClusters"_a = 2 );
+          "in"_a, "nClusters"_a = 2, ReleaseGIL() );
    m.def( "IsodataThreshold", py::overload_cast< dip::Image const&, dip::Image const&, dip::uint >( &dip::IsodataThreshold ),
-          "in"_a, "mask"_a = dip::Image{}, "nThresholds"_a = 1 );
+          "in"_a, "mask"_a = dip::Image{}, "nThresholds"_a = 1, ReleaseGIL() );
    m.def( "OtsuThreshold", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::OtsuThreshold ),
-          "in"_a, "mask"_a = dip::Image{} );
+          "in"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "MinimumErrorThreshold", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::MinimumErrorThreshold ),
-          "in"_a, "mask"_a = dip::Image{} );
+          "in"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "TriangleThreshold", py::overload_cast< dip::Image const&, dip::Image const& >( &dip::TriangleThreshold ),
-          "in"_a, "mask"_a = dip::Image{} );
+          "in"_a, "mask"_a = dip::Image{}, ReleaseGIL() );
    m.def( "BackgroundThreshold", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat >( &dip::BackgroundThreshold ),
-          "in"_a, "mask"_a = dip::Image{}, "distance"_a = 2.0 );
+          "in"_a, "mask"_a = dip::Image{}, "distance"_a = 2.0, ReleaseGIL() );
    m.def( "VolumeThreshold", py::overload_cast< dip::Image const&, dip::Image const&, dip::dfloat >( &dip::VolumeThreshold ),
-          "in"_a, "mask"_a = dip::Image{}, "volumeFraction"_a = 0.5 );
+          "in"_a, "mask"_a = dip::Image{}, "volumeFraction"_a = 0.5, ReleaseGIL() );
    m.def( "FixedThreshold", py::overload_cast< dip::Image const&, dip::dfloat, dip::dfloat, dip::dfloat, dip::String const& >( &dip::FixedThreshold ),
-          "in"_a, "threshold"_a, "foreground"_a = 1.0, "background"_a = 0.0, "output"_a = dip::S::BINARY );
+          "in"_a, "threshold"_a, "foreground"_a = 1.0, "background"_a = 0.0, "output"_a = dip::S::BINARY, ReleaseGIL() );
    m.def( "RangeThreshold", py::overload_cast< dip::Image const&, dip::dfloat, dip::dfloat, dip::String const&, dip::dfloat, dip::dfloat >( &dip::RangeThreshold ),
-          "in"_a, "lowerBound"_a, "upperBound"_a, "output"_a = dip::S::BINARY, "foreground"_a = 1.0, "background"_a = 0.0 );
+          "in"_a, "lowerBound"_a, "upperBound"_a, "output"_a = dip::S::BINARY, "foreground"_a = 1.0, "background"_a = 0.0, ReleaseGIL() );
    m.def( "HysteresisThreshold", py::overload_cast< dip::Image const&, dip::dfloat, dip::dfloat >( &dip::HysteresisThreshold ),
-          "in"_a, "lowThreshold"_a, "highThreshold"_a );
+          "in"_a, "lowThreshold"_a, "highThreshold"_a, ReleaseGIL() );
    m.def( "MultipleThresholds", py::overload_cast< dip::Image const&, dip::FloatArray const& >( &dip::MultipleThresholds ),
-          "in"_a, "thresholds"_a );
+          "in"_a, "thresholds"_a, ReleaseGIL() );
    m.def( "Threshold", []( dip::Image const& in, dip::String const& method, dip::dfloat parameter ) {
              dip::Image out;
              dip::dfloat threshold = Threshold( in, out, method, parameter );
              return py::make_tuple( out, threshold ).release();
           }, "in"_a, "method"_a = dip::S::OTSU, "parameter"_a = dip::infinity );
    m.def( "Canny", py::overload_cast< dip::Image const&, dip::FloatArray const&, dip::dfloat, dip::dfloat, dip::String const& >( &dip::Canny ),
-          "in"_a, "sigmas"_a = dip::FloatArray{ 1 }, "lower"_a = 0.5, "upper"_a = 0.9, "selection"_a = dip::S::ALL );
+          "in"_a, "sigmas"_a = dip::FloatArray{ 1 }, "lower"_a = 0.5, "upper"_a = 0.9, "selection"_a = dip::S::ALL, ReleaseGIL() );
 }
@@ -21,6 +21,11 @@
 
 namespace {
 
+bool IsLittleEndianMachine() {
+   dip::uint16 value = 1;
+   return *reinterpret_cast< dip::uint8* >( &value ) == 1;
+}
+
 dip::Image BufferToImage( py::buffer& buf ) {
    py::buffer_info info = buf.request();
    //std::cout << "--Constructing dip::Image from Python buffer.\n";
@@ -34,34 +39,48 @@ dip::Image BufferToImage( py::buffer& buf ) {
    //std::cout << "   info.strides[0] = " << info.strides[0] << std::endl;
    //std::cout << "   info.strides[1] = " << info.strides[1] << std::endl;
    // Data type
+   // The format string can start with a byte order character; we only accept native byte order.
+   dip::String format = info.format;
+   if( !format.empty() && (( format[ 0 ] == '@' ) || ( format[ 0 ] == '=' ) || ( format[ 0 ] == '<' ))) {
+      // '<' is little endian, we can only accept it on a little-endian machine
+      DIP_THROW_IF(( format[ 0 ] == '<' ) && !IsLittleEndianMachine(), "Buffer byte order not compatible with class Image" );
+      format = format.substr( 1 );
+   }
+   DIP_THROW_IF( format.empty(), "Buffer data type not compatible with class Image" );
+   // Integer type characters map to different sizes on different platforms ('l' is 64 bits on Linux, but
+   // 32 bits on Windows), so we select the data type based on signedness and the item size.
    dip::DataType datatype;
-   switch( info.format[ 0 ] ) {
+   switch( format[ 0 ] ) {
       case py::format_descriptor< bool >::c:
          datatype = dip::DT_BIN;
          break;
-      case py::format_descriptor< dip::uint8 >::c:
-         datatype = dip::DT_UINT8;
-         break;
-      case py::format_descriptor< dip::uint16 >::c:
-         datatype = dip::DT_UINT16;
-         break;
-      case py::format_descriptor< dip::uint32 >::c:
-         datatype = dip::DT_UINT32;
-         break;
-      case py::format_descriptor< dip::uint64 >::c:
-         datatype = dip::DT_UINT64;
-         break;
-      case py::format_descriptor< dip::sint8 >::c:
-         datatype = dip::DT_SINT8;
-         break;
-      case py::format_descriptor< dip::sint16 >::c:
-         datatype = dip::DT_SINT16;
-         break;
-      case py::format_descriptor< dip::sint32 >::c:
-         datatype = dip::DT_SINT32;
+      case 'B':
+      case 'H':
+      case 'I':
+      case 'L':
+      case 'Q':
+         switch( info.itemsize ) {
+            case 1: datatype = dip::DT_UINT8; break;
+            case 2: datatype = dip::DT_UINT16; break;
+            case 4: datatype = dip::DT_UINT32; break;
+            case 8: datatype = dip::DT_UINT64; break;
+            default:
+               DIP_THROW( "Buffer data type not compatible with class Image" );
+         }
          break;
-      case py::format_descriptor< dip::sint64 >::c:
-         datatype = dip::DT_SINT64;
+      case 'b':
+      case 'h':
+      case 'i':
+      case 'l':
+      case 'q':
+         switch( info.itemsize ) {
+            case 1: datatype = dip::DT_SINT8; break;
+            case 2: datatype = dip::DT_SINT16; break;
+            case 4: datatype = dip::DT_SINT32; break;
+            case 8: datatype = dip::DT_SINT64; break;
+            default:
+               DIP_THROW( "Buffer data type not compatible with class Image" );
+         }
          break;
       case py::format_descriptor< dip::sfloat >::c:
          datatype = dip::DT_SFLOAT;
@@ -70,7 +89,7 @@ dip::Image BufferToImage( py::buffer& buf ) {
          datatype = dip::DT_DFLOAT;
          break;
       case 'Z':
-         switch( info.format[ 1 ] ) {
+         switch( format.size() > 1 ? format[ 1 ] : '\0' ) {
             case py::format_descriptor< dip::scomplex >::c:
                datatype = dip::DT_SCOMPLEX;
                break;
@@ -86,6 +105,7 @@ dip::Image BufferToImage( py::buffer& buf ) {
          std::cout << "Attempted to convert buffer to dip.Image object: data type not compatible." << std::endl;
          DIP_THROW( "Buffer data type not compatible with class Image" );
    }
+   DIP_THROW_IF( datatype.SizeOf() != static_cast< dip::uint >( info.itemsize ), "Buffer item size does not match its data type" );
    // Sizes, reversed
    dip::uint ndim = static_cast< dip::uint >( info.ndim );
    DIP_ASSERT( ndim == info.shape.size() );
@@ -102,12 +122,14 @@ dip::Image BufferToImage( py::buffer& buf ) {
       strides[ ii ] = s;
    }
    // The containing Python object. We increase its reference count, and create a unique_ptr that decreases
-   // its reference count again.
+   // its reference count again. The deleter can be called from a function that released the GIL (see `ReleaseGIL`),
+   // so it must re-acquire the GIL before touching the Python object.
    PyObject* pyObject = buf.ptr();
    //std::cout << "   *** Incrementing ref count for pyObject " << pyObject << std::endl;
    Py_XINCREF( pyObject );
    dip::DataSegment dataSegment{ pyObject, []( void* obj ) {
       //std::cout << "   *** Decrementing ref count for pyObject " << obj << std::endl;
+      py::gil_scoped_acquire acquire;
       Py_XDECREF( static_cast< PyObject* >( obj ));
    }};
    // Create an image with all of this.
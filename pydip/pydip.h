@@ -30,6 +30,10 @@
 using namespace pybind11::literals;
 namespace py = pybind11;
 
+// Add as an extra argument to `m.def` for functions that do significant work on image data, so that other
+// Python threads can run in the meantime. Don't use it for functions that touch Python objects or global state.
+using ReleaseGIL = py::call_guard< py::gil_scoped_release >;
+
 /* THINGS I'VE LEARNED SO FAR ABOUT PYBIND11:
  *
  * - Default parameter values seem to be converted to Python types, and then translated back to C++ when needed.
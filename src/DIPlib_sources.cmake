@@ -64,6 +64,7 @@ set(DIPlib_sources_bogus
 ../include/diplib/union_find.h
 analysis/chord_length.cpp
 analysis/distance_distribution.cpp
+analysis/distribution_thread_buffers.h
 analysis/findshift.cpp
 analysis/fouriermellin.cpp
 analysis/fractal_dimension.cpp
@@ -103,6 +104,7 @@ distance/vdt.cpp
 file_io/file_io_support.cpp
 file_io/file_io_support.h
 file_io/ics.cpp
+file_io/ics_tiles.cpp
 file_io/jpeg.cpp
 file_io/tiff_read.cpp
 file_io/tiff_write.cpp
@@ -227,6 +229,7 @@ microscopy/unmix_stains.cpp
 microscopy/wiener.cpp
 morphology/areaopening.cpp
 morphology/basic.cpp
+morphology/component_tree.cpp
 morphology/filters.cpp
 morphology/maxima.cpp
 morphology/one_dimensional.cpp
@@ -251,6 +254,7 @@ regions/labelingGrana2016.h
 segmentation/canny.cpp
 segmentation/kmeans_clustering.cpp
 segmentation/minimum_variance_partitioning.cpp
+segmentation/sparse_points.h
 segmentation/threshold.cpp
 support/accumulators.cpp
 support/matrix.cpp
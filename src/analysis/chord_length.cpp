@@ -26,6 +26,9 @@
 #include "diplib/generic_iterators.h"
 #include "diplib/overload.h"
 #include "diplib/random.h"
+#include "diplib/multithreading.h"
+
+#include "distribution_thread_buffers.h"
 
 namespace dip {
 
@@ -40,22 +43,31 @@ static dip::uint UIntPixelValueReader( void const* data ) {
 
 using PhaseLookupTable = std::unordered_map< dip::uint, dip::uint >;
 
+// Adds a chord of `length` pixels in phase `phase`. Chords outside the mask (`inMask` is false) are not counted.
 void UpdateDistribution(
       Distribution& distribution,
       std::vector< dip::uint >& counts,
       PhaseLookupTable const& phaseLookupTable,
       dip::uint phase,
+      bin inMask,
       dip::uint length
-
 ) {
-   if(( length > 0 ) && ( length - 1 < distribution.Size() )) {
-      // We are interested in the phase of the points
-      dip::uint index = phaseLookupTable.at( phase );
+   if( inMask && ( length > 0 ) && ( length - 1 < distribution.Size() )) {
+      // `phaseLookupTable` was built from all pixels within the mask before sampling started, so the phase is
+      // always found. We avoid `at()` because this is called from within a parallel region.
+      auto it = phaseLookupTable.find( phase );
+      DIP_ASSERT( it != phaseLookupTable.end() );
+      dip::uint index = it->second;
       distribution[ length - 1 ].Y( index ) += 1.0;
       ++( counts[ index ] );
    }
 }
 
+// Random probes are generated in blocks, each block uses its own stretch of the random stream. This way, the
+// probes do not depend on the number of threads used.
+constexpr dip::uint PROBES_PER_BLOCK = 256;
+constexpr dip::uint PROBE_BLOCK_STREAM_LENGTH = dip::uint( 1 ) << 40;
+
 void RandomPixelPairSampler(
       Image const& object,
       Image const& mask,
@@ -67,115 +79,136 @@ void RandomPixelPairSampler(
    UIntPixelValueReaderFunction GetUIntPixelValue;
    DIP_OVL_ASSIGN_UINT( GetUIntPixelValue, UIntPixelValueReader, object.DataType() );
    bool hasMask = mask.IsForged();
-   Random random( 0 );
-   UniformRandomGenerator uniformRandomGenerator( random );
-   GaussianRandomGenerator normalRandomGenerator( random );
+   Random const base( 0 );
    dip::uint nDims = object.Dimensionality();
    UnsignedArray const& sizes = object.Sizes();
    FloatArray maxpos{ sizes };   // upper limit for coordinates
    maxpos -= 1;
-   FloatArray origin( nDims );
-   FloatArray direction( nDims, 1 );
-   UnsignedArray pointInt( nDims );
-   FloatArray pointFloat( nDims );
-   for( dip::uint probe = 0; probe < nProbes; ++probe ) { // TODO: trivially parallelizable.
-      // A point
-      for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         origin[ ii ] = uniformRandomGenerator( 0, maxpos[ ii ] );
-      }
-      // A direction
-      if( nDims == 2 ) {
-         // This is the easy case
-         dfloat phi = uniformRandomGenerator( 0, 2 * pi );
-         direction[ 0 ] = cos( phi );
-         direction[ 1 ] = sin( phi );
-      } else if( nDims == 3 ) {
-         // https://math.stackexchange.com/a/44691/414894
-         // http://mathworld.wolfram.com/SpherePointPicking.html
-         dfloat phi = uniformRandomGenerator( 0, 2 * pi );
-         dfloat z = uniformRandomGenerator( -1, 1 );
-         dfloat u = std::sqrt( 1 - z * z );
-         direction[ 0 ] = u * cos( phi );
-         direction[ 1 ] = u * sin( phi );
-         direction[ 2 ] = z;
-      } else if( nDims > 3 ) {
-         // Pick a normally distributed point and normalize
-         dfloat norm = 0;
-         do {
+   dip::uint nBlocks = div_ceil( nProbes, PROBES_PER_BLOCK );
+   dip::uint nThreads = std::max< dip::uint >( std::min( GetNumberOfThreads(), nBlocks ), 1 );
+   if(( nThreads > 1 ) && ( nProbes * sizes.maximum_value() * nDims * 4 < threadingThreshold )) {
+      nThreads = 1;
+   }
+   DistributionThreadBuffers buffers( distribution, counts );
+   buffers.SetNumberOfThreads( nThreads );
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      Distribution& threadDistribution = buffers.GetDistribution( thread );
+      std::vector< dip::uint >& threadCounts = buffers.GetCounts( thread );
+      FloatArray origin( nDims );
+      FloatArray direction( nDims, 1 );
+      UnsignedArray pointInt( nDims );
+      FloatArray pointFloat( nDims );
+      #pragma omp for schedule( dynamic )
+      for( dip::sint block = 0; block < static_cast< dip::sint >( nBlocks ); ++block ) {
+         Random random = base;
+         random.Advance( static_cast< dip::uint >( block ) * PROBE_BLOCK_STREAM_LENGTH );
+         UniformRandomGenerator uniformRandomGenerator( random );
+         GaussianRandomGenerator normalRandomGenerator( random );
+         dip::uint firstProbe = static_cast< dip::uint >( block ) * PROBES_PER_BLOCK;
+         dip::uint lastProbe = std::min( firstProbe + PROBES_PER_BLOCK, nProbes );
+         for( dip::uint probe = firstProbe; probe < lastProbe; ++probe ) {
+            // A point
             for( dip::uint ii = 0; ii < nDims; ++ii ) {
-               direction[ ii ] = normalRandomGenerator( 0, 1 );
-               norm += direction[ ii ] * direction[ ii ];
+               origin[ ii ] = uniformRandomGenerator( 0, maxpos[ ii ] );
             }
-         } while( norm == 0 ); // highly unlikely, but we need to do this anway
-         norm = std::sqrt( norm );
-         for( dip::uint ii = 0; ii < nDims; ++ii ) {
-            direction[ ii ] /= norm;
-         }
-      } // else : ( nDims == 1 ) : direction is always 1
-      // Given a point and a direction, find the two points where this line crosses the image boundary
-      bool first = true;
-      dfloat distanceBegin = 0;
-      dfloat distanceEnd = 0;
-      for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         // We're sure at least one direction[ii] is not zero
-         if( direction[ ii ] != 0 ) {
-            dfloat distB, distE;
-            if( direction[ ii ] > 0 ) {
-               distB = ( origin[ ii ] ) / direction[ ii ];
-               distE = ( maxpos[ ii ] - origin[ ii ] ) / direction[ ii ];
-            } else {
-               distB = ( maxpos[ ii ] - origin[ ii ] ) / -direction[ ii ];
-               distE = ( -origin[ ii ] ) / direction[ ii ];
+            // A direction
+            if( nDims == 2 ) {
+               // This is the easy case
+               dfloat phi = uniformRandomGenerator( 0, 2 * pi );
+               direction[ 0 ] = cos( phi );
+               direction[ 1 ] = sin( phi );
+            } else if( nDims == 3 ) {
+               // https://math.stackexchange.com/a/44691/414894
+               // http://mathworld.wolfram.com/SpherePointPicking.html
+               dfloat phi = uniformRandomGenerator( 0, 2 * pi );
+               dfloat z = uniformRandomGenerator( -1, 1 );
+               dfloat u = std::sqrt( 1 - z * z );
+               direction[ 0 ] = u * cos( phi );
+               direction[ 1 ] = u * sin( phi );
+               direction[ 2 ] = z;
+            } else if( nDims > 3 ) {
+               // Pick a normally distributed point and normalize
+               dfloat norm = 0;
+               do {
+                  for( dip::uint ii = 0; ii < nDims; ++ii ) {
+                     direction[ ii ] = normalRandomGenerator( 0, 1 );
+                     norm += direction[ ii ] * direction[ ii ];
+                  }
+               } while( norm == 0 ); // highly unlikely, but we need to do this anway
+               norm = std::sqrt( norm );
+               for( dip::uint ii = 0; ii < nDims; ++ii ) {
+                  direction[ ii ] /= norm;
+               }
+            } // else : ( nDims == 1 ) : direction is always 1
+            // Given a point and a direction, find the two points where this line crosses the image boundary
+            bool first = true;
+            dfloat distanceBegin = 0;
+            dfloat distanceEnd = 0;
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               // We're sure at least one direction[ii] is not zero
+               if( direction[ ii ] != 0 ) {
+                  dfloat distB, distE;
+                  if( direction[ ii ] > 0 ) {
+                     distB = ( origin[ ii ] ) / direction[ ii ];
+                     distE = ( maxpos[ ii ] - origin[ ii ] ) / direction[ ii ];
+                  } else {
+                     distB = ( maxpos[ ii ] - origin[ ii ] ) / -direction[ ii ];
+                     distE = ( -origin[ ii ] ) / direction[ ii ];
+                  }
+                  distanceBegin = first ? distB : std::min( distB, distanceBegin );
+                  distanceEnd = first ? distE : std::min( distE, distanceEnd );
+                  first = false;
+               }
             }
-            distanceBegin = first ? distB : std::min( distB, distanceBegin );
-            distanceEnd = first ? distE : std::min( distE, distanceEnd );
-            first = false;
-         }
-      }
-      dfloat totalLength = 0.0;
-      for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         double end = origin[ ii ] + direction[ ii ] * distanceEnd;
-         double begin = origin[ ii ] - direction[ ii ] * distanceBegin;
-         DIP_ASSERT( end >= -0.499 );
-         DIP_ASSERT( end <= maxpos[ ii ] + 0.499 );
-         DIP_ASSERT( begin >= -0.499 );
-         DIP_ASSERT( begin <= maxpos[ ii ] + 0.499 );
-         pointFloat[ ii ] = begin;
-         pointInt[ ii ] = static_cast< dip::uint >( std::round( begin ));
-         dfloat dist = end - begin;
-         totalLength += dist * dist;
-      }
-      totalLength = sqrt( totalLength );
-      dip::uint totalLengthInt = static_cast< dip::uint >( totalLength );
-      // Walk along this line and find phase changes
-      dip::uint d1 = GetUIntPixelValue( object.Pointer( pointInt ));
-      bin m1 = hasMask ? *static_cast< bin const* >( mask.Pointer( pointInt )) : bin( true );
-      dip::uint d2 = d1;
-      bin m2 = m1;
-      dip::uint length = 0;
-      for( dip::uint rr = 0; rr < totalLengthInt; ++rr ) {
-         // We want to measure the len of the line in the same phase, in the same object
-         if( d2 == d1 && m2 == m1 ) {
-            ++length;
-         } else {
-            UpdateDistribution( distribution, counts, phaseLookupTable, d2, length );
-            // Only count chord length inside a masked area
-            length = ( m1 ? 1 : 0 );
-         }
-         // Update to the next point on the line by adding direction to pointFloat and rounding it to nearest integer point
-         d2 = d1;
-         m2 = m1;
-         for( dip::uint ii = 0; ii < nDims; ++ii ) {
-            pointFloat[ ii ] += direction[ ii ];
-            DIP_ASSERT( pointFloat[ ii ] >= -0.499 );
-            DIP_ASSERT( pointFloat[ ii ] <= maxpos[ ii ] + 0.499 );
-            pointInt[ ii ] = static_cast< dip::uint >( std::round( pointFloat[ ii ] ));
+            dfloat totalLength = 0.0;
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               double end = origin[ ii ] + direction[ ii ] * distanceEnd;
+               double begin = origin[ ii ] - direction[ ii ] * distanceBegin;
+               DIP_ASSERT( end >= -0.499 );
+               DIP_ASSERT( end <= maxpos[ ii ] + 0.499 );
+               DIP_ASSERT( begin >= -0.499 );
+               DIP_ASSERT( begin <= maxpos[ ii ] + 0.499 );
+               pointFloat[ ii ] = begin;
+               pointInt[ ii ] = static_cast< dip::uint >( std::round( begin ));
+               dfloat dist = end - begin;
+               totalLength += dist * dist;
+            }
+            totalLength = sqrt( totalLength );
+            dip::uint totalLengthInt = static_cast< dip::uint >( totalLength );
+            // Walk along this line and find phase changes
+            dip::uint d1 = GetUIntPixelValue( object.Pointer( pointInt ));
+            bin m1 = hasMask ? *static_cast< bin const* >( mask.Pointer( pointInt )) : bin( true );
+            dip::uint d2 = d1;
+            bin m2 = m1;
+            dip::uint length = 0;
+            for( dip::uint rr = 0; rr < totalLengthInt; ++rr ) {
+               // We want to measure the len of the line in the same phase, in the same object
+               if( d2 == d1 && m2 == m1 ) {
+                  ++length;
+               } else {
+                  UpdateDistribution( threadDistribution, threadCounts, phaseLookupTable, d2, m2, length );
+                  // Only count chord length inside a masked area
+                  length = ( m1 ? 1 : 0 );
+               }
+               // Update to the next point on the line by adding direction to pointFloat and rounding it to nearest integer point
+               d2 = d1;
+               m2 = m1;
+               for( dip::uint ii = 0; ii < nDims; ++ii ) {
+                  pointFloat[ ii ] += direction[ ii ];
+                  DIP_ASSERT( pointFloat[ ii ] >= -0.499 );
+                  DIP_ASSERT( pointFloat[ ii ] <= maxpos[ ii ] + 0.499 );
+                  pointInt[ ii ] = static_cast< dip::uint >( std::round( pointFloat[ ii ] ));
+               }
+               d1 = GetUIntPixelValue( object.Pointer( pointInt ));
+               m1 = hasMask ? *static_cast< bin const* >( mask.Pointer( pointInt )) : bin( true );
+            }
+            UpdateDistribution( threadDistribution, threadCounts, phaseLookupTable, d2, m2, length );
          }
-         d1 = GetUIntPixelValue( object.Pointer( pointInt ));
-         m1 = hasMask ? *static_cast< bin const* >( mask.Pointer( pointInt )) : bin( true );
       }
-      UpdateDistribution( distribution, counts, phaseLookupTable, d2, length );
    }
+   buffers.Reduce();
 }
 
 void GridPixelPairSampler(
@@ -202,16 +235,35 @@ void GridPixelPairSampler(
       step = div_floor( nLines, nProbes );
       step = std::max< dip::uint >( step, 1 ); // step must be at least 1.
    }
+   dip::uint maxThreads = GetNumberOfThreads();
+   DistributionThreadBuffers buffers( distribution, counts );
    // Iterate over image dimensions
    for( dip::uint dim = 0; dim < nDims; ++dim ) {
       GenericJointImageIterator< 2 > it( { object, mask }, dim );
       dip::uint size = it.ProcessingDimensionSize();
       dip::sint dataStride = it.ProcessingDimensionStride< 0 >() * static_cast< dip::sint >( object.DataType().SizeOf() );
       dip::sint maskStride = hasMask ? it.ProcessingDimensionStride< 1 >() : 0;
-      // Iterate over `fraction` image lines
+      // Collect `fraction` image lines
+      std::vector< std::pair< void const*, bin const* >> lines;
       do {
-         void const* dataPtr = it.Pointer< 0 >();
-         bin const* maskPtr = hasMask ? static_cast< bin const* >( it.Pointer< 1 >() ) : nullptr;
+         lines.emplace_back( it.Pointer< 0 >(), hasMask ? static_cast< bin const* >( it.Pointer< 1 >() ) : nullptr );
+         for( dip::uint ii = 0; ( ii < step ) && it; ++ii ) {
+            ++it; // TODO: this does not skip appropriately in 3D and higher dims.
+         }
+      } while( it );
+      dip::uint nThreads = std::min( maxThreads, lines.size() );
+      if(( nThreads > 1 ) && ( lines.size() * size * 4 < threadingThreshold )) {
+         nThreads = 1;
+      }
+      buffers.SetNumberOfThreads( nThreads );
+      // Iterate over the image lines
+      #pragma omp parallel for num_threads( static_cast< int >( nThreads )) schedule( dynamic, 16 )
+      for( dip::sint line = 0; line < static_cast< dip::sint >( lines.size() ); ++line ) {
+         dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+         Distribution& threadDistribution = buffers.GetDistribution( thread );
+         std::vector< dip::uint >& threadCounts = buffers.GetCounts( thread );
+         void const* dataPtr = lines[ static_cast< dip::uint >( line ) ].first;
+         bin const* maskPtr = lines[ static_cast< dip::uint >( line ) ].second;
          // Walk along this line and find phase changes
          dip::uint d1 = GetUIntPixelValue( dataPtr );
          bin m1 = hasMask ? *maskPtr : bin( true );
@@ -223,7 +275,7 @@ void GridPixelPairSampler(
             if( d2 == d1 && m2 == m1 ) {
                ++length;
             } else {
-               UpdateDistribution( distribution, counts, phaseLookupTable, d2, length );
+               UpdateDistribution( threadDistribution, threadCounts, phaseLookupTable, d2, m2, length );
                // Only count chord length inside a masked area
                length = ( m1 ? 1 : 0 );
             }
@@ -235,11 +287,9 @@ void GridPixelPairSampler(
             d1 = GetUIntPixelValue( dataPtr );
             m1 = hasMask ? *maskPtr : bin( true );
          }
-         UpdateDistribution( distribution, counts, phaseLookupTable, d2, length );
-         for( dip::uint ii = 0; ( ii < step ) && it; ++ii ) {
-            ++it; // TODO: this does not skip appropriately in 3D and higher dims.
-         }
-      } while( it );
+         UpdateDistribution( threadDistribution, threadCounts, phaseLookupTable, d2, m2, length );
+      }
+      buffers.Reduce();
    }
 }
 
@@ -296,3 +346,28 @@ Distribution ChordLength(
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing ChordLength with a mask") {
+   // Phase 0 in columns 0-9, phase 1 in columns 10-14, phase 2 in columns 15-19, which are outside the mask
+   dip::Image object( { 20, 10 }, 1, dip::DT_UINT8 );
+   object.Fill( 0 );
+   object.At( dip::Range{ 10, 14 }, dip::Range{} ).Fill( 1 );
+   object.At( dip::Range{ 15, 19 }, dip::Range{} ).Fill( 2 );
+   dip::Image mask( { 20, 10 }, 1, dip::DT_BIN );
+   mask.Fill( true );
+   mask.At( dip::Range{ 15, 19 }, dip::Range{} ).Fill( false );
+   dip::Distribution distribution = dip::ChordLength( object, mask, 0, 20, dip::S::GRID );
+   DOCTEST_REQUIRE( distribution.ValuesPerSample() == 2 );
+   // Phase 0: 10 horizontal and 10 vertical chords, all 10 pixels long
+   DOCTEST_CHECK( distribution[ 9 ].Y( 0 ) == doctest::Approx( 1.0 ));
+   // Phase 1: 10 horizontal chords of 5 pixels, 5 vertical chords of 10 pixels
+   DOCTEST_CHECK( distribution[ 4 ].Y( 1 ) == doctest::Approx( 10.0 / 15.0 ));
+   DOCTEST_CHECK( distribution[ 9 ].Y( 1 ) == doctest::Approx( 5.0 / 15.0 ));
+   // Phase 2 is only outside the mask, it is not counted
+   DOCTEST_CHECK( distribution[ 4 ].Y( 0 ) == 0.0 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -0,0 +1,82 @@
+/*
+ * DIPlib 3.0
+ * This file contains support for accumulating a dip::Distribution on multiple threads.
+ *
+ * (c)2026, DIPlib contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_DISTRIBUTION_THREAD_BUFFERS_H
+#define DIP_DISTRIBUTION_THREAD_BUFFERS_H
+
+#include "diplib.h"
+#include "diplib/distribution.h"
+
+namespace dip {
+namespace {
+
+// A distribution and a vector of counts that are accumulated on multiple threads. Thread 0 accumulates
+// directly into the output, each other thread into its own zero-initialized copy. `Reduce` adds the copies
+// into the output and frees them. When running on a single thread, no copies are made.
+class DistributionThreadBuffers {
+   public:
+      DistributionThreadBuffers( Distribution& distribution, std::vector< dip::uint >& counts )
+            : distribution_( distribution ), counts_( counts ) {}
+
+      // Must be called before accumulating on `nThreads` threads. Can be called again after `Reduce`.
+      void SetNumberOfThreads( dip::uint nThreads ) {
+         DIP_ASSERT( threadDistributions_.empty() );
+         if( nThreads <= 1 ) {
+            return;
+         }
+         Distribution zero = distribution_;
+         for( dip::uint ii = 0; ii < zero.ValuesPerSample(); ++ii ) {
+            for( auto it = zero.Ybegin( ii ); it != zero.Yend( ii ); ++it ) {
+               *it = 0.0;
+            }
+         }
+         threadDistributions_.assign( nThreads - 1, zero );
+         threadCounts_.assign( nThreads - 1, std::vector< dip::uint >( counts_.size(), 0 ));
+      }
+
+      Distribution& GetDistribution( dip::uint thread ) {
+         return thread == 0 ? distribution_ : threadDistributions_[ thread - 1 ];
+      }
+      std::vector< dip::uint >& GetCounts( dip::uint thread ) {
+         return thread == 0 ? counts_ : threadCounts_[ thread - 1 ];
+      }
+
+      // Adds the results of all threads into the output.
+      void Reduce() {
+         for( dip::uint ii = 0; ii < threadDistributions_.size(); ++ii ) {
+            distribution_ += threadDistributions_[ ii ];
+            for( dip::uint jj = 0; jj < counts_.size(); ++jj ) {
+               counts_[ jj ] += threadCounts_[ ii ][ jj ];
+            }
+         }
+         threadDistributions_.clear();
+         threadCounts_.clear();
+      }
+
+   private:
+      Distribution& distribution_;
+      std::vector< dip::uint >& counts_;
+      std::vector< Distribution > threadDistributions_;
+      std::vector< std::vector< dip::uint >> threadCounts_;
+};
+
+} // namespace
+} // namespace dip
+
+#endif // DIP_DISTRIBUTION_THREAD_BUFFERS_H
@@ -26,9 +26,74 @@
 #include "diplib/geometry.h"
 #include "diplib/mapping.h"
 #include "diplib/math.h"
+#include "diplib/iterators.h"
 
 namespace dip {
 
+namespace {
+
+// Computes, for each of the given `areas` (sorted), the difference between the mean of `in` within `mask` and
+// the mean of its area opening (or closing) with that filter size. All area openings are computed at once from
+// the max-tree (min-tree for closings): a node with an area smaller than the filter size is removed, lowering
+// all pixels in it (and its descendants) to the level of its parent.
+std::vector< dfloat > AreaOpeningMeanDifference(
+      Image const& in,
+      Image const& mask,
+      std::vector< dfloat > const& areas,
+      bool opening
+) {
+   ComponentTree tree( in, 1, opening ? S::OPENING : S::CLOSING );
+   auto const& nodes = tree.Nodes();
+   dip::uint nNodes = nodes.size();
+
+   // Number of pixels within the mask for each node, including its descendants
+   std::vector< dip::uint > count( nNodes, 0 );
+   if( mask.IsForged() ) {
+      auto const& pixelNodes = tree.PixelNodes();
+      ImageIterator< dip::bin > it( mask );
+      dip::uint ii = 0;
+      do {
+         if( *it ) {
+            ++count[ pixelNodes[ ii ]];
+         }
+         ++ii;
+      } while( ++it );
+      for( dip::uint jj = 0; jj < nNodes - 1; ++jj ) {
+         count[ nodes[ jj ].parent ] += count[ jj ];
+      }
+   } else {
+      for( dip::uint jj = 0; jj < nNodes; ++jj ) {
+         count[ jj ] = nodes[ jj ].area;
+      }
+   }
+   dfloat total = static_cast< dfloat >( count.back() );
+   DIP_THROW_IF( total == 0, "Mask image is empty" );
+
+   // The volume removed by removing each node: its height above its parent times its (masked) area
+   std::vector< std::pair< dip::uint, dfloat >> removed;
+   removed.reserve( nNodes - 1 );
+   for( dip::uint jj = 0; jj < nNodes - 1; ++jj ) {
+      dfloat height = std::abs( nodes[ jj ].level - nodes[ nodes[ jj ].parent ].level );
+      removed.emplace_back( nodes[ jj ].area, height * static_cast< dfloat >( count[ jj ] ));
+   }
+   std::sort( removed.begin(), removed.end(), []( auto const& a, auto const& b ) { return a.first < b.first; } );
+
+   // Accumulate the removed volume for increasing areas
+   std::vector< dfloat > out( areas.size() );
+   dfloat sum = 0;
+   auto it = removed.begin();
+   for( dip::uint ii = 0; ii < areas.size(); ++ii ) {
+      while(( it != removed.end() ) && ( static_cast< dfloat >( it->first ) < areas[ ii ] )) {
+         sum += it->second;
+         ++it;
+      }
+      out[ ii ] = sum / total;
+   }
+   return out;
+}
+
+} // namespace
+
 Distribution Granulometry(
       Image const& in,
       Image const& mask,
@@ -47,8 +112,15 @@ Distribution Granulometry(
    std::sort( scales.begin(), scales.end() );
    DIP_THROW_IF( scales[ 0 ] <= 1.0, E::PARAMETER_OUT_OF_RANGE ); // all scales must be larger than 1
    // Type
-   bool isotropic;
-   DIP_STACK_TRACE_THIS( isotropic = BooleanFromString( type, S::ISOTROPIC, S::LENGTH ));
+   bool isotropic = false;
+   bool area = false;
+   if( type == S::ISOTROPIC ) {
+      isotropic = true;
+   } else if( type == S::AREA ) {
+      area = true;
+   } else if( type != S::LENGTH ) {
+      DIP_THROW_INVALID_FLAG( type );
+   }
    // Polarity
    bool opening;
    DIP_STACK_TRACE_THIS( opening = BooleanFromString( polarity, S::OPENING, S::CLOSING ));
@@ -68,9 +140,9 @@ Distribution Granulometry(
          interpolate = true;
       } else if( isotropic && ( option == S::SUBSAMPLE )) {
          subsample = true;
-      } else if( !isotropic && ( option == S::UNCONSTRAINED )) {
+      } else if( !isotropic && !area && ( option == S::UNCONSTRAINED )) {
          constrained = false;
-      } else if( !isotropic && ( option == S::ROBUST )) {
+      } else if( !isotropic && !area && ( option == S::ROBUST )) {
          robust = true;
       } else {
          DIP_THROW_INVALID_FLAG( option );
@@ -194,6 +266,25 @@ Distribution Granulometry(
          out[ ii ].Y() = clamp(( result - offset ) * gain, 0.0, 1.0 ); // Clamping is necessary if we interpolate and/or subsample
       }
 
+   } else if( area ) {
+      // Area opening/closing, all scales computed at once from the component tree
+
+      if( mask.IsForged() ) {
+         DIP_STACK_TRACE_THIS( mask.CheckIsMask( in.Sizes() ));
+      }
+      // The filter size is the volume of a ball with the scale as diameter
+      dfloat ballVolume = std::pow( pi, static_cast< dfloat >( nDims ) / 2.0 ) / std::tgamma( static_cast< dfloat >( nDims ) / 2.0 + 1.0 );
+      std::vector< dfloat > areas( scales.size() );
+      for( dip::uint ii = 0; ii < scales.size(); ++ii ) {
+         areas[ ii ] = ballVolume * std::pow( scales[ ii ] / 2.0, nDims );
+      }
+      std::vector< dfloat > difference;
+      DIP_STACK_TRACE_THIS( difference = AreaOpeningMeanDifference( in, mask, areas, opening ));
+      for( dip::uint ii = 0; ii < scales.size(); ++ii ) {
+         dfloat result = opening ? offset - difference[ ii ] : offset + difference[ ii ];
+         out[ ii ].Y() = clamp(( result - offset ) * gain, 0.0, 1.0 );
+      }
+
    } else {
       // Path opening/closing
 
@@ -217,3 +308,32 @@ Distribution Granulometry(
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/linear.h"
+#include "diplib/random.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the area granulometry") {
+   dip::Image in( { 64, 50 }, 1, dip::DT_SFLOAT );
+   in.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( in, in, random, 0, 255 );
+   dip::Gauss( in, in, { 2 } );
+   in.Convert( dip::DT_UINT8 );
+   std::vector< dip::dfloat > scales{ 2, 4, 8 };
+   for( auto const& polarity : { dip::S::OPENING, dip::S::CLOSING } ) {
+      dip::Distribution distribution = dip::Granulometry( in, {}, scales, dip::S::AREA, polarity );
+      auto maxmin = dip::MaximumAndMinimum( in );
+      dip::dfloat offset = dip::Mean( in ).As< dip::dfloat >();
+      dip::dfloat gain = 1 / (( polarity == dip::S::OPENING ? maxmin.Minimum() : maxmin.Maximum() ) - offset );
+      for( dip::uint ii = 0; ii < scales.size(); ++ii ) {
+         auto filterSize = static_cast< dip::uint >( std::ceil( dip::pi * scales[ ii ] * scales[ ii ] / 4.0 ));
+         dip::Image tmp = dip::AreaOpening( in, {}, filterSize, 1, polarity );
+         dip::dfloat expected = ( dip::Mean( tmp ).As< dip::dfloat >() - offset ) * gain;
+         DOCTEST_CHECK( distribution[ ii ].Y() == doctest::Approx( expected ));
+      }
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -26,8 +26,11 @@
 #include "diplib/generic_iterators.h"
 #include "diplib/overload.h"
 #include "diplib/random.h"
+#include "diplib/multithreading.h"
 #include "diplib/saturated_arithmetic.h"
 
+#include "distribution_thread_buffers.h"
+
 namespace dip {
 
 namespace {
@@ -62,21 +65,33 @@ dfloat FloatPixelValueReader( void const* data ) {
 }
 
 
-class PixelPairFunction {
+// The per-thread accumulation is handled by the `DistributionThreadBuffers` base class; `thread` selects the
+// buffer to accumulate into.
+class PixelPairFunction : public DistributionThreadBuffers {
    public:
       virtual void UpdateRandom(
             UnsignedArray const& coords1,
             UnsignedArray const& coords2,
-            dip::uint distance
+            dip::uint distance,
+            dip::uint thread
       ) = 0;
       virtual void UpdateGrid(
             void const* dataPtr1,
             void const* dataPtr2,
-            dip::uint distance
+            dip::uint distance,
+            dip::uint thread
       ) = 0;
-      // virtual void SetNumberOfThreads( dip::uint  threads ) { ( void )threads; }
+
+   protected:
+      PixelPairFunction( Distribution& distribution, std::vector< dip::uint >& counts )
+            : DistributionThreadBuffers( distribution, counts ) {}
 };
 
+// Random probes are generated in blocks, each block uses its own stretch of the random stream. This way, the
+// probes do not depend on the number of threads used.
+constexpr dip::uint PROBES_PER_BLOCK = 1024;
+constexpr dip::uint PROBE_BLOCK_STREAM_LENGTH = dip::uint( 1 ) << 40;
+
 void RandomPixelPairSampler(
       Image const& object, // unsigned integer type
       Image const& mask,   // might or might not be forged
@@ -85,46 +100,64 @@ void RandomPixelPairSampler(
       dip::uint maxLength
 ) {
    bool hasMask = mask.IsForged();
-   Random random( 0 );
-   UniformRandomGenerator uniformRandomGenerator( random );
+   Random const base( 0 );
    dip::uint nDims = object.Dimensionality();
    UnsignedArray const& sizes = object.Sizes();
-   UnsignedArray coords1( nDims );
-   UnsignedArray coords2( nDims );
-   for( dip::uint probe = 0; probe < nProbes; ++probe ) { // TODO: trivially parallelizable.
-      bool isInMask = true;
-      // First point
-      do {
-         for( dip::uint ii = 0; ii < nDims; ++ii ) {
-            coords1[ ii ] = static_cast< dip::uint >( uniformRandomGenerator( 0, static_cast< dfloat >( sizes[ ii ] ))); // computes floor
-         }
-         isInMask = hasMask ? static_cast< bool >( *static_cast< bin* >( mask.Pointer( coords1 ))) : true;
-      } while( !isInMask );
-      // Second point, probe within a region of side maxLength around first point
+   dip::uint nBlocks = div_ceil( nProbes, PROBES_PER_BLOCK );
+   dip::uint nThreads = std::max< dip::uint >( std::min( GetNumberOfThreads(), nBlocks ), 1 );
+   if(( nThreads > 1 ) && ( nProbes * nDims * 20 < threadingThreshold )) {
+      nThreads = 1;
+   }
+   pixelPairFunction->SetNumberOfThreads( nThreads );
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      UnsignedArray coords1( nDims );
+      UnsignedArray coords2( nDims );
       UnsignedArray topLeft( nDims );
       UnsignedArray botRight( nDims );
-      for( dip::uint ii = 0; ii < nDims; ++ii ) {
-         topLeft[ ii ] = coords1[ ii ] > maxLength ? coords1[ ii ] - maxLength : 0u;
-         botRight[ ii ] = std::min( coords1[ ii ] + maxLength + 1, sizes[ ii ] );
-      }
-      dip::uint distance;
-      do {
-         distance = 0;
-         for( dip::uint ii = 0; ii < nDims; ++ii ) {
-            coords2[ ii ] = static_cast< dip::uint >( uniformRandomGenerator(
-                  static_cast< dfloat >( topLeft[ ii ] ), static_cast< dfloat >( botRight[ ii ] ))); // computes floor
-            dip::uint d = coords2[ ii ] >= coords1[ ii ] ? coords2[ ii ] - coords1[ ii ] : coords1[ ii ] - coords2[ ii ];
-            distance += d * d;
-         }
-         if( distance > maxLength * maxLength ) {
-            isInMask = false;
-         } else {
-            isInMask = hasMask ? static_cast< bool >( *static_cast< bin* >( mask.Pointer( coords2 ))) : true;
+      #pragma omp for schedule( dynamic )
+      for( dip::sint block = 0; block < static_cast< dip::sint >( nBlocks ); ++block ) {
+         Random random = base;
+         random.Advance( static_cast< dip::uint >( block ) * PROBE_BLOCK_STREAM_LENGTH );
+         UniformRandomGenerator uniformRandomGenerator( random );
+         dip::uint firstProbe = static_cast< dip::uint >( block ) * PROBES_PER_BLOCK;
+         dip::uint lastProbe = std::min( firstProbe + PROBES_PER_BLOCK, nProbes );
+         for( dip::uint probe = firstProbe; probe < lastProbe; ++probe ) {
+            bool isInMask = true;
+            // First point
+            do {
+               for( dip::uint ii = 0; ii < nDims; ++ii ) {
+                  coords1[ ii ] = static_cast< dip::uint >( uniformRandomGenerator( 0, static_cast< dfloat >( sizes[ ii ] ))); // computes floor
+               }
+               isInMask = hasMask ? static_cast< bool >( *static_cast< bin* >( mask.Pointer( coords1 ))) : true;
+            } while( !isInMask );
+            // Second point, probe within a region of side maxLength around first point
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               topLeft[ ii ] = coords1[ ii ] > maxLength ? coords1[ ii ] - maxLength : 0u;
+               botRight[ ii ] = std::min( coords1[ ii ] + maxLength + 1, sizes[ ii ] );
+            }
+            dip::uint distance;
+            do {
+               distance = 0;
+               for( dip::uint ii = 0; ii < nDims; ++ii ) {
+                  coords2[ ii ] = static_cast< dip::uint >( uniformRandomGenerator(
+                        static_cast< dfloat >( topLeft[ ii ] ), static_cast< dfloat >( botRight[ ii ] ))); // computes floor
+                  dip::uint d = coords2[ ii ] >= coords1[ ii ] ? coords2[ ii ] - coords1[ ii ] : coords1[ ii ] - coords2[ ii ];
+                  distance += d * d;
+               }
+               if( distance > maxLength * maxLength ) {
+                  isInMask = false;
+               } else {
+                  isInMask = hasMask ? static_cast< bool >( *static_cast< bin* >( mask.Pointer( coords2 ))) : true;
+               }
+            } while( !isInMask );
+            distance = static_cast< dip::uint >( std::round( std::sqrt( distance )));
+            pixelPairFunction->UpdateRandom( coords1, coords2, distance, thread );
          }
-      } while( !isInMask );
-      distance = static_cast< dip::uint >( std::round( std::sqrt( distance )));
-      pixelPairFunction->UpdateRandom( coords1, coords2, distance );
+      }
    }
+   pixelPairFunction->Reduce();
 }
 
 void GridPixelPairSampler(
@@ -136,7 +169,6 @@ void GridPixelPairSampler(
 ) {
    bool hasMask = mask.IsForged();
    dip::uint nDims = object.Dimensionality();
-   UnsignedArray coords( nDims );
    dip::uint nPixels = object.Sizes().product();
    dip::uint nGridPoints = nPixels;
    dip::uint step = 1; // how many lines to skip
@@ -146,6 +178,7 @@ void GridPixelPairSampler(
       step = static_cast< dip::uint >( floor_cast( 1.0 / fraction ));
       step = std::max< dip::uint >( step, 1 ); // step must be at least 1, this test should never trigger.
    }
+   dip::uint maxThreads = GetNumberOfThreads();
    // Iterate over image dimensions
    for( dip::uint dim = 0; dim < nDims; ++dim ) {
       GenericJointImageIterator< 2 > it( { object, mask }, dim );
@@ -157,11 +190,26 @@ void GridPixelPairSampler(
       nPointsPerLine = std::min( nPointsPerLine, size ); // don't do more points than we have in the line, this should not trigger.
       dip::uint lineStep = div_floor( size, nPointsPerLine );
       dip::uint lastPoint = lineStep * nPointsPerLine;
-      // Iterate over `fraction` image lines
+      // Collect `fraction` image lines
+      std::vector< std::pair< void const*, bin const* >> lines;
       do {
+         lines.emplace_back( it.Pointer< 0 >(), hasMask ? static_cast< bin const* >( it.Pointer< 1 >() ) : nullptr );
+         for( dip::uint ii = 0; ( ii < step ) && it; ++ii ) {
+            ++it; // TODO: this does not skip appropriately in 3D and higher dims.
+         }
+      } while( it );
+      dip::uint nThreads = std::min( maxThreads, lines.size() );
+      if(( nThreads > 1 ) && ( lines.size() * nPointsPerLine * ( maxLength + 1 ) * 4 < threadingThreshold )) {
+         nThreads = 1;
+      }
+      pixelPairFunction->SetNumberOfThreads( nThreads );
+      // Iterate over the image lines
+      #pragma omp parallel for num_threads( static_cast< int >( nThreads )) schedule( dynamic, 16 )
+      for( dip::sint line = 0; line < static_cast< dip::sint >( lines.size() ); ++line ) {
+         dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
          // Iterate over `fraction` pixels in this image line
-         void const* dataPtr = it.Pointer< 0 >();
-         bin const* maskPtr = hasMask ? static_cast< bin const* >( it.Pointer< 1 >() ) : nullptr;
+         void const* dataPtr = lines[ static_cast< dip::uint >( line ) ].first;
+         bin const* maskPtr = lines[ static_cast< dip::uint >( line ) ].second;
          for( dip::uint ii = 0; ii < lastPoint; ii += lineStep ) {
             if( !hasMask || *maskPtr ) {
                // Iterate over pixels at all distances from this pixel
@@ -170,7 +218,7 @@ void GridPixelPairSampler(
                bin const* maskPtr2 = maskPtr;
                for( dip::uint distance = 0; distance <= max; ++distance ) {
                   if( !hasMask || *maskPtr2 ) {
-                     pixelPairFunction->UpdateGrid( dataPtr, dataPtr2, distance );
+                     pixelPairFunction->UpdateGrid( dataPtr, dataPtr2, distance, thread );
                   }
                   dataPtr2 = static_cast< uint8 const* >( dataPtr2 ) + dataStride;
                   maskPtr2 += maskStride;
@@ -179,10 +227,8 @@ void GridPixelPairSampler(
             dataPtr = static_cast< uint8 const* >( dataPtr ) + dataStride;
             maskPtr += maskStride;
          }
-         for( dip::uint ii = 0; ( ii < step ) && it; ++ii ) {
-            ++it; // TODO: this does not skip appropriately in 3D and higher dims.
-         }
-      } while( it );
+      }
+      pixelPairFunction->Reduce();
    }
 }
 
@@ -218,32 +264,35 @@ class PairCorrelationFunction : public PixelPairFunction {
       virtual void UpdateRandom(
             UnsignedArray const& coords1,
             UnsignedArray const& coords2,
-            dip::uint distance
+            dip::uint distance,
+            dip::uint thread
       ) override {
-         UpdateGrid( object_.Pointer( coords1 ), object_.Pointer( coords2 ), distance );
+         UpdateGrid( object_.Pointer( coords1 ), object_.Pointer( coords2 ), distance, thread );
       }
 
       virtual void UpdateGrid(
             void const* dataPtr1,
             void const* dataPtr2,
-            dip::uint distance
+            dip::uint distance,
+            dip::uint thread
       ) override {
          dip::uint phase1 = GetUIntPixelValue_( dataPtr1 );
          dip::uint phase2 = GetUIntPixelValue_( dataPtr2 );
-         ++( counts_[ distance ] );
-         dip::uint index1 = phaseLookupTable_.at( phase1 );
+         Distribution& distribution = GetDistribution( thread );
+         ++( GetCounts( thread )[ distance ] );
+         dip::uint index1 = PhaseIndex( phase1 );
          if( covariance_ ) {
             if( phase1 == phase2 ) {
-               distribution_[ distance ].Y( index1, index1 ) += 1.0;
+               distribution[ distance ].Y( index1, index1 ) += 1.0;
             } else {
-               dip::uint index2 = phaseLookupTable_.at( phase2 );
+               dip::uint index2 = PhaseIndex( phase2 );
                // To make sure the matrix remains symmetric, we assign half the hit to each phase.
-               distribution_[ distance ].Y( index1, index2 ) += 0.5;
-               distribution_[ distance ].Y( index2, index1 ) += 0.5;
+               distribution[ distance ].Y( index1, index2 ) += 0.5;
+               distribution[ distance ].Y( index2, index1 ) += 0.5;
             }
          } else {
             if( phase1 == phase2 ) {
-               distribution_[ distance ].Y( index1 ) += 1.0;
+               distribution[ distance ].Y( index1 ) += 1.0;
             }
          }
       }
@@ -254,18 +303,25 @@ class PairCorrelationFunction : public PixelPairFunction {
             std::vector< dip::uint >& counts,
             PhaseLookupTable const& phaseLookupTable,
             bool covariance                     // if true, distribution.Columns()==nPhases, otherwise distribution.Columns()==1
-      ) : object_( object ), distribution_( distribution ), counts_( counts ), phaseLookupTable_( phaseLookupTable ),
+      ) : PixelPairFunction( distribution, counts ), object_( object ), phaseLookupTable_( phaseLookupTable ),
           covariance_( covariance ) {
          DIP_OVL_ASSIGN_UINT( GetUIntPixelValue_, UIntPixelValueReader, object.DataType() );
       }
 
    private:
       Image const& object_;
-      Distribution& distribution_;
-      std::vector< dip::uint >& counts_;
       PhaseLookupTable const& phaseLookupTable_;
       bool covariance_;
       UIntPixelValueReaderFunction GetUIntPixelValue_;
+
+      // Both pixels of a pair are within the mask, and `phaseLookupTable_` was built from all pixels within the
+      // mask before sampling started, so the phase is always found. We avoid `at()` because this is called
+      // from within a parallel region, where exceptions must not escape.
+      dip::uint PhaseIndex( dip::uint phase ) const {
+         auto it = phaseLookupTable_.find( phase );
+         DIP_ASSERT( it != phaseLookupTable_.end() );
+         return it->second;
+      }
 };
 
 enum class PairCorrelationNormalization{ None, Volume, VolumeSquare };
@@ -398,25 +454,28 @@ class ProbabilisticPairCorrelationFunction : public PixelPairFunction {
       virtual void UpdateRandom(
             UnsignedArray const& coords1,
             UnsignedArray const& coords2,
-            dip::uint distance
+            dip::uint distance,
+            dip::uint thread
       ) override {
-         UpdateGrid( phases_.Pointer( coords1 ), phases_.Pointer( coords2 ), distance );
+         UpdateGrid( phases_.Pointer( coords1 ), phases_.Pointer( coords2 ), distance, thread );
       }
 
       virtual void UpdateGrid(
             void const* dataPtr1,
             void const* dataPtr2,
-            dip::uint distance
+            dip::uint distance,
+            dip::uint thread
       ) override {
-         ++( counts_[ distance ] );
+         Distribution& distribution = GetDistribution( thread );
+         ++( GetCounts( thread )[ distance ] );
          if( covariance_ ) {
             for( dip::uint phase1 = 0; phase1 < nPhases_; ++phase1 ) {
                dfloat prob1 = GetFloatPixelValue_( dataPtr1, phases_.TensorStride() * static_cast< dip::sint >( phase1 ));
                for( dip::uint phase2 = phase1; phase2 < nPhases_; ++phase2 ) {
                   dfloat prob2 = GetFloatPixelValue_( dataPtr2, phases_.TensorStride() * static_cast< dip::sint >( phase2 ));
-                  distribution_[ distance ].Y( phase1, phase2 ) += prob1 * prob2;
+                  distribution[ distance ].Y( phase1, phase2 ) += prob1 * prob2;
                   if( phase1 != phase2 ) {
-                     distribution_[ distance ].Y( phase2, phase1 ) += prob1 * prob2;
+                     distribution[ distance ].Y( phase2, phase1 ) += prob1 * prob2;
                   }
                }
             }
@@ -424,7 +483,7 @@ class ProbabilisticPairCorrelationFunction : public PixelPairFunction {
             for( dip::uint ii = 0; ii < nPhases_; ++ii ) {
                dfloat prob1 = GetFloatPixelValue_( dataPtr1, phases_.TensorStride() * static_cast< dip::sint >( ii ));
                dfloat prob2 = GetFloatPixelValue_( dataPtr2, phases_.TensorStride() * static_cast< dip::sint >( ii ));
-               distribution_[ distance ].Y( ii ) += prob1 * prob2;
+               distribution[ distance ].Y( ii ) += prob1 * prob2;
             }
          }
       }
@@ -434,15 +493,13 @@ class ProbabilisticPairCorrelationFunction : public PixelPairFunction {
             Distribution& distribution,         // distribution_.Rows()==nPhases
             std::vector< dip::uint >& counts,
             bool covariance                     // if true, distribution.Columns()==nPhases, otherwise distribution.Columns()==1
-      ) : phases_( phases ), distribution_( distribution ), counts_( counts ), covariance_( covariance ) {
+      ) : PixelPairFunction( distribution, counts ), phases_( phases ), covariance_( covariance ) {
          DIP_OVL_ASSIGN_FLOAT( GetFloatPixelValue_, FloatPixelValueReaderWithOffset, phases.DataType() );
          nPhases_ = phases.TensorElements();
       }
 
    private:
       Image const& phases_;
-      Distribution& distribution_;
-      std::vector< dip::uint >& counts_;
       dip::uint nPhases_;
       bool covariance_;
       FloatPixelValueReaderWithOffsetFunction GetFloatPixelValue_;
@@ -503,33 +560,34 @@ class SemivariogramFunction : public PixelPairFunction {
       virtual void UpdateRandom(
             UnsignedArray const& coords1,
             UnsignedArray const& coords2,
-            dip::uint distance
+            dip::uint distance,
+            dip::uint thread
       ) override {
-         UpdateGrid( image_.Pointer( coords1 ), image_.Pointer( coords2 ), distance );
+         UpdateGrid( image_.Pointer( coords1 ), image_.Pointer( coords2 ), distance, thread );
       }
 
       virtual void UpdateGrid(
             void const* dataPtr1,
             void const* dataPtr2,
-            dip::uint distance
+            dip::uint distance,
+            dip::uint thread
       ) override {
-         ++( counts_[ distance ] );
+         Distribution& distribution = GetDistribution( thread );
+         ++( GetCounts( thread )[ distance ] );
          dfloat diff = GetFloatPixelValue_( dataPtr1 ) - GetFloatPixelValue_( dataPtr2 );
-         distribution_[ distance ].Y() += 0.5 * diff * diff;
+         distribution[ distance ].Y() += 0.5 * diff * diff;
       }
 
       SemivariogramFunction(
             Image const& in,
             Distribution& distribution,         // distribution_.Rows()==nPhases
             std::vector< dip::uint >& counts
-      ) : image_( in ), distribution_( distribution ), counts_( counts ) {
+      ) : PixelPairFunction( distribution, counts ), image_( in ) {
          DIP_OVL_ASSIGN_REAL( GetFloatPixelValue_, FloatPixelValueReader, in.DataType() );
       }
 
    private:
       Image const& image_;
-      Distribution& distribution_;
-      std::vector< dip::uint >& counts_;
       FloatPixelValueReaderFunction GetFloatPixelValue_;
 };
 
@@ -571,3 +629,33 @@ Distribution Semivariogram(
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the multi-threaded pair correlation") {
+   dip::Image in( { 80, 60 }, 1, dip::DT_SFLOAT );
+   in.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( in, in, random, 0, 1 );
+   dip::Image object = in > 0.5;
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Distribution dist1 = dip::PairCorrelation( object, {}, 200000, 20, dip::S::RANDOM, { "covariance" } );
+   dip::Distribution grid1 = dip::PairCorrelation( object, {}, 0, 20, dip::S::GRID );
+   dip::SetNumberOfThreads( 3 );
+   dip::Distribution dist3 = dip::PairCorrelation( object, {}, 200000, 20, dip::S::RANDOM, { "covariance" } );
+   dip::Distribution grid3 = dip::PairCorrelation( object, {}, 0, 20, dip::S::GRID );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_REQUIRE( dist1.Size() == dist3.Size() );
+   for( dip::uint ii = 0; ii < dist1.Size(); ++ii ) {
+      for( dip::uint jj = 0; jj < dist1.ValuesPerSample(); ++jj ) {
+         DOCTEST_CHECK( dist1[ ii ].Y( jj ) == dist3[ ii ].Y( jj ));
+      }
+      DOCTEST_CHECK( grid1[ ii ].Y( 0 ) == grid3[ ii ].Y( 0 ));
+      DOCTEST_CHECK( grid1[ ii ].Y( 1 ) == grid3[ ii ].Y( 1 ));
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
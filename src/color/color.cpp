@@ -74,6 +74,7 @@ ColorSpaceManager::ColorSpaceManager() {
    Register( new cmyk2cmy );
    // HSI
    Define( "HSI", 3 );
+   colorSpaces_.back().hasHue = true;
    DefineAlias( "hsi", "HSI" );
    Register( new grey2hsi );
    Register( new hsi2grey );
@@ -81,11 +82,13 @@ ColorSpaceManager::ColorSpaceManager() {
    Register( new hsi2rgb );
    // HCV
    Define( "HCV", 3 );
+   colorSpaces_.back().hasHue = true;
    DefineAlias( "hcv", "HCV" );
    Register( new rgb2hcv );
    Register( new hcv2rgb );
    // HSV
    Define( "HSV", 3 );
+   colorSpaces_.back().hasHue = true;
    DefineAlias( "hsv", "HSV" );
    Register( new hcv2hsv );
    Register( new hsv2hcv );
@@ -126,6 +129,7 @@ ColorSpaceManager::ColorSpaceManager() {
    Register( new luv2grey );
    // LCH
    Define( "LCH", 3 );
+   colorSpaces_.back().hasHue = true;
    DefineAlias( "lch", "LCH" );
    DefineAlias( "L*C*H*", "LCH" );
    DefineAlias( "l*c*h*", "LCH" );
@@ -151,7 +155,7 @@ class ConverterLineFilter : public Framework::ScanLineFilter {
       ConverterLineFilter( ConversionStepArray const& steps ) : steps_( steps ) {
          maxIntermediateChannels_ = steps[ 0 ].nOutputChannels;
          for( dip::uint ii = 1; ii < steps.size() - 1; ++ii ) {
-            maxIntermediateChannels_ = std::max( maxIntermediateChannels_, steps[ 1 ].nOutputChannels );
+            maxIntermediateChannels_ = std::max( maxIntermediateChannels_, steps[ ii ].nOutputChannels );
          }
          nBuffers_ = std::min< dip::uint >( 2, steps.size() - 1 );
       }
@@ -220,6 +224,109 @@ class ConverterLineFilter : public Framework::ScanLineFilter {
       // It also means we don't need to worry about how many channels an intermediate representation needs.
 };
 
+// The look-up table for 8-bit, 3-channel input images samples each input channel at `lutStep` intervals
+constexpr dip::uint lutStep = 5;
+constexpr dip::uint lutSize = 255 / lutStep + 1; // 255 is a multiple of `lutStep`, so the last node is at 255
+static_assert( 255 % lutStep == 0, "The look-up table grid must include the value 255" );
+
+// Converts a 3-channel uint8 image by trilinear interpolation in a table of converted values,
+// `table` is a `lutSize`^3 image of type SFLOAT, with the conversion result for each of the grid nodes.
+class LookupTableLineFilter : public Framework::ScanLineFilter {
+   public:
+      LookupTableLineFilter( Image const& table ) :
+            table_( static_cast< sfloat const* >( table.Origin() )),
+            strides_( table.Strides() ),
+            tensorStride_( table.TensorStride() ),
+            nChannels_( table.TensorElements() ) {}
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override {
+         return 20 * nChannels_;
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         dip::uint const nPixels = params.bufferLength;
+         uint8 const* in = static_cast< uint8 const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint const inStride = params.inBuffer[ 0 ].stride;
+         dip::sint const inTStride = params.inBuffer[ 0 ].tensorStride;
+         sfloat* out = static_cast< sfloat* >( params.outBuffer[ 0 ].buffer );
+         dip::sint const outStride = params.outBuffer[ 0 ].stride;
+         dip::sint const outTStride = params.outBuffer[ 0 ].tensorStride;
+         dip::sint const s0 = strides_[ 0 ];
+         dip::sint const s1 = strides_[ 1 ];
+         dip::sint const s2 = strides_[ 2 ];
+         constexpr sfloat scale = 1.0f / static_cast< sfloat >( lutStep );
+         for( dip::uint ii = 0; ii < nPixels; ++ii, in += inStride, out += outStride ) {
+            // Find the grid cell, the value 255 is in the last cell with a weight of 1 for the upper node
+            dip::uint v0 = in[ 0 ];
+            dip::uint v1 = in[ inTStride ];
+            dip::uint v2 = in[ 2 * inTStride ];
+            dip::uint i0 = std::min( v0 / lutStep, lutSize - 2 );
+            dip::uint i1 = std::min( v1 / lutStep, lutSize - 2 );
+            dip::uint i2 = std::min( v2 / lutStep, lutSize - 2 );
+            sfloat w0 = static_cast< sfloat >( v0 - i0 * lutStep ) * scale;
+            sfloat w1 = static_cast< sfloat >( v1 - i1 * lutStep ) * scale;
+            sfloat w2 = static_cast< sfloat >( v2 - i2 * lutStep ) * scale;
+            sfloat const* p000 = table_ + static_cast< dip::sint >( i0 ) * s0
+                                        + static_cast< dip::sint >( i1 ) * s1
+                                        + static_cast< dip::sint >( i2 ) * s2;
+            sfloat const* p100 = p000 + s0;
+            sfloat const* p010 = p000 + s1;
+            sfloat const* p110 = p010 + s0;
+            sfloat const* p001 = p000 + s2;
+            sfloat const* p101 = p001 + s0;
+            sfloat const* p011 = p001 + s1;
+            sfloat const* p111 = p011 + s0;
+            sfloat* o = out;
+            for( dip::uint jj = 0; jj < nChannels_; ++jj ) {
+               sfloat c00 = *p000 + w0 * ( *p100 - *p000 );
+               sfloat c10 = *p010 + w0 * ( *p110 - *p010 );
+               sfloat c01 = *p001 + w0 * ( *p101 - *p001 );
+               sfloat c11 = *p011 + w0 * ( *p111 - *p011 );
+               sfloat c0 = c00 + w1 * ( c10 - c00 );
+               sfloat c1 = c01 + w1 * ( c11 - c01 );
+               *o = c0 + w2 * ( c1 - c0 );
+               o += outTStride;
+               p000 += tensorStride_;
+               p100 += tensorStride_;
+               p010 += tensorStride_;
+               p110 += tensorStride_;
+               p001 += tensorStride_;
+               p101 += tensorStride_;
+               p011 += tensorStride_;
+               p111 += tensorStride_;
+            }
+         }
+      }
+   private:
+      sfloat const* table_;
+      IntegerArray strides_;
+      dip::sint tensorStride_;
+      dip::uint nChannels_;
+};
+
+// Converts `in` along the path given by `steps`, using the look-up table for 8-bit, 3-channel images.
+void ConvertUsingLookupTable( Image const& in, Image& out, ConversionStepArray const& steps ) {
+   // Create an image with the grid node values, and convert it along the path
+   Image grid( { lutSize, lutSize, lutSize }, 3, DT_DFLOAT );
+   DIP_ASSERT( grid.HasNormalStrides() );
+   dfloat* ptr = static_cast< dfloat* >( grid.Origin() );
+   for( dip::uint i2 = 0; i2 < lutSize; ++i2 ) {
+      for( dip::uint i1 = 0; i1 < lutSize; ++i1 ) {
+         for( dip::uint i0 = 0; i0 < lutSize; ++i0 ) {
+            *( ptr++ ) = static_cast< dfloat >( i0 * lutStep );
+            *( ptr++ ) = static_cast< dfloat >( i1 * lutStep );
+            *( ptr++ ) = static_cast< dfloat >( i2 * lutStep );
+         }
+      }
+   }
+   dip::uint nOutputChannels = steps.back().nOutputChannels;
+   ConverterLineFilter converter( steps );
+   Image table;
+   Framework::ScanMonadic( grid, table, DT_DFLOAT, DT_SFLOAT, nOutputChannels, converter );
+   // Interpolate in the table for each input pixel
+   LookupTableLineFilter lineFilter( table );
+   ImageRefArray outar{ out };
+   Framework::Scan( { in }, outar, { DT_UINT8 }, { DT_SFLOAT }, { DT_SFLOAT }, { nOutputChannels }, lineFilter );
+}
+
 } // namespace
 
 void ColorSpaceManager::Convert(
@@ -263,15 +370,20 @@ void ColorSpaceManager::Convert(
       //std::cout << colorSpaces_[ path.back() ].name << std::endl;
       // Call scan framework
       DIP_START_STACK_TRACE
-         ConverterLineFilter lineFilter( steps );
-         Framework::ScanMonadic(
-               in,
-               out,
-               DT_DFLOAT,
-               DataType::SuggestFloat( in.DataType() ),
-               steps.back().nOutputChannels,
-               lineFilter
-         );
+         if( useLookupTable_ && ( in.DataType() == DT_UINT8 ) && ( in.TensorElements() == 3 ) &&
+             !colorSpaces_[ endIndex ].hasHue && ( in.NumberOfPixels() > lutSize * lutSize * lutSize )) {
+            ConvertUsingLookupTable( in, out, steps );
+         } else {
+            ConverterLineFilter lineFilter( steps );
+            Framework::ScanMonadic(
+                  in,
+                  out,
+                  DT_DFLOAT,
+                  DataType::SuggestFloat( in.DataType() ),
+                  steps.back().nOutputChannels,
+                  lineFilter
+            );
+         }
       DIP_END_STACK_TRACE
       out.ReshapeTensorAsVector();
    }
@@ -385,6 +497,7 @@ void ColorSpaceManager::SetWhitePoint( XYZ whitePoint ) {
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
 #include "diplib/math.h"
+#include "diplib/testing.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the ColorSpaceManager class") {
    dip::ColorSpaceManager csm;
@@ -428,4 +541,24 @@ DOCTEST_TEST_CASE("[DIPlib] testing the ColorSpaceManager class") {
    DOCTEST_CHECK_FALSE( xyz.At( 0 ) == out.At( 0 ));
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the ColorSpaceManager look-up table") {
+   dip::ColorSpaceManager csm;
+   dip::Image img( { 400, 400 }, 3, dip::DT_UINT8 );
+   dip::uint8* ptr = static_cast< dip::uint8* >( img.Origin() );
+   for( dip::uint ii = 0; ii < img.NumberOfSamples(); ++ii ) {
+      ptr[ ii ] = static_cast< dip::uint8 >(( ii * 7919 ) % 256 );
+   }
+   img.SetColorSpace( "sRGB" );
+   dip::Image exact = csm.Convert( img, "Lab" );
+   csm.UseLookupTable();
+   dip::Image approx = csm.Convert( img, "Lab" );
+   DOCTEST_CHECK( approx.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( approx.ColorSpace() == "Lab" );
+   DOCTEST_CHECK( dip::testing::CompareImages( exact, approx, 0.2 )); // the maximum error over all inputs is 0.19
+   // Hue can not be interpolated, the exact path is used
+   exact = csm.Convert( img, "LCH" );
+   csm.UseLookupTable( false );
+   DOCTEST_CHECK( dip::testing::CompareImages( exact, csm.Convert( img, "LCH" )));
+}
+
 #endif // DIP__ENABLE_DOCTEST
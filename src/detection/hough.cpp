@@ -23,6 +23,7 @@
 #include "diplib/distribution.h"
 #include "diplib/morphology.h"
 #include "diplib/measurement.h"
+#include "diplib/multithreading.h"
 
 namespace dip {
 
@@ -105,6 +106,47 @@ bool clip( IntegerCoords& A, IntegerCoords& B, IntegerCoords Pmax ) {
    }
 }
 
+struct Vote {
+   IntegerCoords pos;
+   dfloat angle;
+};
+
+// Draws the votes for one on pixel along its gradient direction
+void DrawVote(
+      Image& accumulator,
+      Vote const& vote,
+      IntegerCoords sz,
+      dfloat minsz,
+      dfloat maxsz
+) {
+   // TODO: option to select inside or outside
+   IntegerCoords max = { static_cast< dip::sint >( std::round( std::cos( vote.angle ) * maxsz )),
+                         static_cast< dip::sint >( std::round( std::sin( vote.angle ) * maxsz )) };
+   if( minsz == 0 ) {
+      // Draw single line
+      IntegerCoords start = vote.pos - max;
+      IntegerCoords end = vote.pos + max;
+      if( clip( start, end, sz )) {
+         // Note that after clipping we can be sure that all coordinates are positive
+         DrawLine( accumulator, start, end, { 1 }, S::ADD );
+      }
+   } else {
+      // Draw two line segments
+      IntegerCoords min = { static_cast< dip::sint >( std::round( std::cos( vote.angle ) * minsz )),
+                            static_cast< dip::sint >( std::round( std::sin( vote.angle ) * minsz )) };
+      IntegerCoords start = vote.pos - min;
+      IntegerCoords end = vote.pos - max;
+      if( clip( start, end, sz )) {
+         DrawLine( accumulator, start, end, { 1 }, S::ADD );
+      }
+      start = vote.pos + min;
+      end = vote.pos + max;
+      if( clip( start, end, sz )) {
+         DrawLine( accumulator, start, end, { 1 }, S::ADD );
+      }
+   }
+}
+
 dfloat norm_square(
       const UnsignedArray& a,
       const UnsignedArray& b
@@ -148,46 +190,77 @@ void HoughTransformCircleCenters(
       maxsz = static_cast< dfloat >( range[ 1 ] );
    }
 
-   // Initialize accumulator
-   out.ReForge( in.Sizes(), 1, DT_SFLOAT );
-   out.Fill( 0 );
-
+   // Collect the votes: the coordinates and gradient direction of each on pixel
+   std::vector< Vote > votes;
    auto coordComp = gv.OffsetToCoordinatesComputer();
-
-   // Iterate over on pixels
    // NOTE: calling end() on View does not work
    for( auto it = gv.At( in ).begin(); it; ++it ) {
       auto coord = coordComp( it.Offset() );
-      IntegerCoords c{ static_cast< dip::sint >( coord[ 0 ] ),
-                       static_cast< dip::sint >( coord[ 1 ] ) };
-      dfloat angle = std::atan2( static_cast< dfloat >( it[ 1 ] ), static_cast< dfloat >( it[ 0 ] ));
-      // TODO: option to select inside or outside
-      IntegerCoords max = { static_cast< dip::sint >( std::round( std::cos( angle ) * maxsz )),
-                            static_cast< dip::sint >( std::round( std::sin( angle ) * maxsz )) };
-      if( minsz == 0 ) {
-         // Draw single line
-         IntegerCoords start = c - max;
-         IntegerCoords end = c + max;
-         if( clip( start, end, sz )) {
-            // Note that after clipping we can be sure that all coordinates are positive
-            DrawLine( out, start, end, { 1 }, S::ADD );
+      votes.push_back( { { static_cast< dip::sint >( coord[ 0 ] ), static_cast< dip::sint >( coord[ 1 ] ) },
+                         std::atan2( static_cast< dfloat >( it[ 1 ] ), static_cast< dfloat >( it[ 0 ] )) } );
+   }
+   dip::uint nVotes = votes.size();
+
+   // Initialize accumulator
+   out.ReForge( in.Sizes(), 1, DT_SFLOAT );
+   out.Fill( 0 );
+   if( nVotes == 0 ) {
+      return;
+   }
+
+   // Votes are independent, we distribute them over threads. Each thread draws into its own accumulator,
+   // these are summed at the end. All values are small integers, so the result does not depend on the
+   // order in which votes are added.
+   dip::uint nThreads = std::min( GetNumberOfThreads(), nVotes );
+   if( nThreads > 1 ) {
+      // Each vote draws a line of up to 2 * maxsz pixels, at a cost of about 10 operations per pixel.
+      // Each additional thread also costs an accumulator to be cleared and summed.
+      if( static_cast< dfloat >( nVotes ) * ( maxsz - minsz ) * 20 < static_cast< dfloat >( threadingThreshold + nThreads * out.NumberOfPixels() * 2 )) {
+         nThreads = 1;
+      }
+   }
+   std::vector< Image > accumulators( nThreads );
+   std::exception_ptr exception;
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      Image& accumulator = accumulators[ thread ];
+      try {
+         if( thread == 0 ) {
+            accumulator = out.QuickCopy();
+         } else {
+            accumulator.ReForge( out );
+            accumulator.Fill( 0 );
          }
-      } else {
-         // Draw two line segments
-         IntegerCoords min = { static_cast< dip::sint >( std::round( std::cos( angle ) * minsz )),
-                               static_cast< dip::sint >( std::round( std::sin( angle ) * minsz )) };
-         IntegerCoords start = c - min;
-         IntegerCoords end = c - max;
-         if( clip( start, end, sz )) {
-            DrawLine( out, start, end, { 1 }, S::ADD );
+      } catch( ... ) {
+         #pragma omp critical
+         if( !exception ) {
+            exception = std::current_exception();
          }
-         start = c + min;
-         end = c + max;
-         if( clip( start, end, sz )) {
-            DrawLine( out, start, end, { 1 }, S::ADD );
+      }
+      #pragma omp barrier
+      if( !exception ) {
+         #pragma omp for schedule( static )
+         for( dip::sint ii = 0; ii < static_cast< dip::sint >( nVotes ); ++ii ) {
+            try {
+               DrawVote( accumulator, votes[ static_cast< dip::uint >( ii ) ], sz, minsz, maxsz );
+            } catch( ... ) {
+               #pragma omp critical
+               if( !exception ) {
+                  exception = std::current_exception();
+               }
+            }
          }
       }
    }
+   if( exception ) {
+      std::rethrow_exception( exception );
+   }
+
+   // Merge accumulators
+   for( dip::uint ii = 1; ii < nThreads; ++ii ) {
+      out += accumulators[ ii ];
+   }
 }
 
 CoordinateArray FindHoughMaxima(
@@ -316,6 +389,7 @@ FloatCoordinateArray FindHoughCircles(
 #include "diplib/segmentation.h"
 #include "diplib/math.h"
 #include "diplib/statistics.h"
+#include "diplib/testing.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the HoughTransformCircleCenters function") {
    // Draw a circle
@@ -334,6 +408,15 @@ DOCTEST_TEST_CASE("[DIPlib] testing the HoughTransformCircleCenters function") {
    // Check result
    DOCTEST_CHECK( m[0] == 256 );
    DOCTEST_CHECK( m[1] == 256 );
+
+   // The multi-threaded accumulation should give the exact same result
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   auto h1 = dip::HoughTransformCircleCenters( bin, gv, { 50, 150 } );
+   dip::SetNumberOfThreads( 3 );
+   auto h3 = dip::HoughTransformCircleCenters( bin, gv, { 50, 150 } );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( dip::testing::CompareImages( h1, h3 ));
 }
 
 DOCTEST_TEST_CASE("[DIPlib] testing the FindHoughCircles function") {
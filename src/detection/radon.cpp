@@ -109,6 +109,29 @@ void ComputeFullParameterSpace(
    ClipLow( paramSpace, paramSpace, 0 );
 }
 
+// Keeps the running maximum and argmax over the slices computed so far; `tmp` is the slice for `radius`
+void UpdateMaximum(
+      Image& max,
+      Image& argmax,
+      Image const& tmp,
+      dfloat radius
+) {
+   DIP_ASSERT( max.DataType() == DT_SFLOAT );
+   DIP_ASSERT( argmax.DataType() == DT_SFLOAT );
+   DIP_ASSERT( tmp.DataType() == DT_SFLOAT );
+   JointImageIterator< sfloat, sfloat, sfloat > it( { tmp, max, argmax } );
+   it.Optimize();
+   sfloat r = static_cast< sfloat >( radius );
+   do {
+      if( it.Sample< 0 >() > it.Sample< 1 >() ) {
+         it.Sample< 1 >() = it.Sample< 0 >();
+         it.Sample< 2 >() = r;
+      }
+   } while( ++it );
+}
+
+// Only one slice of the parameter space exists at any given time, the memory used does not depend on
+// the number of radii. `paramSpace` is a local image, forged here as DT_SFLOAT.
 void ComputeProjectedParameterSpace(
       Image const& inFT,
       Image& paramSpace,
@@ -119,18 +142,19 @@ void ComputeProjectedParameterSpace(
    UnsignedArray const& outSize = inFT.Sizes();
    Image sphere( outSize, 1, DT_SFLOAT );
    Image sphereFT;
-   paramSpace.ReForge( outSize, 2, DT_SFLOAT, Option::AcceptDataTypeChange::DO_ALLOW );
+   DIP_ASSERT( !paramSpace.IsProtected() );
+   paramSpace.ReForge( outSize, 2, DT_SFLOAT );
    paramSpace.Fill( 0 );
    Image max = paramSpace[ 0 ];
    max.Protect();
    Image argmax = paramSpace[ 1 ];
    argmax.Protect();
-   Image tmp, mask;
+   Image tmp;
    for( auto radius : radii ) {
-      ComputeParameterSpaceSlice( inFT, sphere, sphereFT, tmp, static_cast< dfloat >( radius ), sigma, options );
-      Greater( tmp, max, mask );
-      Select( tmp, max, mask, max );
-      argmax.At( std::move( mask )) = radius;
+      dfloat r = static_cast< dfloat >( radius );
+      ComputeParameterSpaceSlice( inFT, sphere, sphereFT, tmp, r, sigma, options );
+      DIP_ASSERT( tmp.DataType() == DT_SFLOAT );
+      UpdateMaximum( max, argmax, tmp, r );
    }
 }
 
@@ -167,6 +191,7 @@ void UpdateMaxima(
    } while( ++it );
 }
 
+// `paramSpace` is a local image, forged here as DT_SFLOAT.
 void ComputeProjectedParameterSpace_SubPixel(
       Image const& inFT,
       Image& paramSpace,
@@ -178,7 +203,8 @@ void ComputeProjectedParameterSpace_SubPixel(
    UnsignedArray const& outSize = inFT.Sizes();
    Image sphere( outSize, 1, DT_SFLOAT );
    Image sphereFT;
-   paramSpace.ReForge( outSize, 2, DT_SFLOAT, Option::AcceptDataTypeChange::DONT_ALLOW );
+   DIP_ASSERT( !paramSpace.IsProtected() );
+   paramSpace.ReForge( outSize, 2, DT_SFLOAT );
    paramSpace.Fill( 0 );
    Image max = paramSpace[ 0 ];
    max.Protect();
@@ -326,14 +352,18 @@ RadonCircleParametersArray RadonTransformCircles(
 
    // Prepare
    Image inFT = FourierTransform( in ); // TODO: We could try using the "fast" option, leading to a slightly larger parameter space.
+   if(( mode == RadonTransformCirclesMode::subpixelProjection ) && ( radii.Size() < 3 )) {
+      mode = RadonTransformCirclesMode::projection;
+   }
+   // The projection modes compute into a local DT_SFLOAT image, which is copied to `out` at the end.
+   // This way, `out` can be protected and of any data type, as with the "full" mode.
+   bool saveParamSpace = options.Contains( RadonTransformCirclesOption::saveParamSpace );
+   bool computeInPlace = saveParamSpace && ( mode == RadonTransformCirclesMode::full );
    Image tmp_paramSpace;
-   Image& parameterSpace = options.Contains( RadonTransformCirclesOption::saveParamSpace ) ? out : tmp_paramSpace;
+   Image& parameterSpace = computeInPlace ? out : tmp_paramSpace;
    RadonCircleParametersArray out_params;
 
    // Compute parameter space
-   if(( mode == RadonTransformCirclesMode::subpixelProjection ) && ( radii.Size() < 3 )) {
-      mode = RadonTransformCirclesMode::projection;
-   }
    switch( mode ) {
       case RadonTransformCirclesMode::full:
          //if ( options.Contains( RadonTransformCirclesOption::saveParamSpace ) || ( radii.Size() < 3 )) {
@@ -376,7 +406,51 @@ RadonCircleParametersArray RadonTransformCircles(
          }
       }
    }
+   if( saveParamSpace && !computeInPlace ) {
+      DIP_START_STACK_TRACE
+         out.ReForge( parameterSpace, Option::AcceptDataTypeChange::DO_ALLOW );
+         out.Copy( parameterSpace );
+      DIP_END_STACK_TRACE
+   }
    return out_params;
 }
 
 } // namespace
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/statistics.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the RadonTransformCircles projection mode") {
+   dip::Image in( { 64, 60 }, 1, dip::DT_SFLOAT );
+   in.Fill( 0 );
+   dip::DrawBandlimitedBall( in, 2 * 14.3, { 30.2, 28.6 }, { 1 }, dip::S::EMPTY );
+   dip::Image full;
+   auto params = dip::RadonTransformCircles( in, full, { 10, 20 }, 1.0, 1.0, dip::S::FULL );
+   dip::Image projection;
+   auto projParams = dip::RadonTransformCircles( in, projection, { 10, 20 }, 1.0, 1.0, dip::S::PROJECTION );
+   DOCTEST_REQUIRE( full.Dimensionality() == 3 );
+   DOCTEST_REQUIRE( projection.TensorElements() == 2 );
+   dip::Image max;
+   dip::Maximum( full, {}, max, { false, false, true } );
+   max.Squeeze( 2 );
+   DOCTEST_CHECK( dip::testing::CompareImages( max, projection[ 0 ], 1e-6 ));
+   DOCTEST_REQUIRE( params.size() == 1 );
+   DOCTEST_REQUIRE( projParams.size() == 1 );
+   DOCTEST_CHECK( projParams[ 0 ].origin[ 0 ] == doctest::Approx( params[ 0 ].origin[ 0 ] ));
+   DOCTEST_CHECK( projParams[ 0 ].origin[ 1 ] == doctest::Approx( params[ 0 ].origin[ 1 ] ));
+   DOCTEST_CHECK( projParams[ 0 ].radius == doctest::Approx( 14 ));
+   DOCTEST_CHECK( params[ 0 ].radius == doctest::Approx( 14.3 ).epsilon( 0.02 ));
+   // A protected output image of a different data type receives the converted parameter space
+   dip::Image projection64( in.Sizes(), 2, dip::DT_DFLOAT );
+   projection64.Protect();
+   auto params64 = dip::RadonTransformCircles( in, projection64, { 10, 20 }, 1.0, 1.0, dip::S::PROJECTION );
+   DOCTEST_CHECK( projection64.DataType() == dip::DT_DFLOAT );
+   DOCTEST_CHECK( dip::testing::CompareImages( projection64, projection ));
+   DOCTEST_REQUIRE( params64.size() == 1 );
+   DOCTEST_CHECK( params64[ 0 ].radius == projParams[ 0 ].radius );
+}
+
+#endif // DIP__ENABLE_DOCTEST
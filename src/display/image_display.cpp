@@ -95,18 +95,50 @@ void ImageDisplay::ComputeLimits( bool set ) {
          }
       }
    }
+   if( tmp.IsForged() && !globalStretch_ ) {
+      sliceLimitsCache_[ SliceKey() ] = sliceLimits_;
+   }
    if( set ) {
       range_ = *lims;
    }
 }
 
 void ImageDisplay::InvalidateSliceLimits() {
+   // Limits for a slice we've shown before don't need to be recomputed
+   auto it = sliceLimitsCache_.find( SliceKey() );
+   if( it != sliceLimitsCache_.end() ) {
+      sliceLimits_ = it->second;
+      return;
+   }
    for( auto& lim : sliceLimits_ ) {
       lim.maxMin = { nan, nan };
       lim.percentile = { nan, nan };
    }
 }
 
+ImageDisplay::SliceKeyType ImageDisplay::SliceKey() const {
+   SliceKeyType key{ static_cast< dip::sint >( projectionMode_ ),
+                     static_cast< dip::sint >( dim1_ ),
+                     static_cast< dip::sint >( dim2_ ),
+                     red_, green_, blue_ };
+   if( projectionMode_ == ProjectionMode::SLICE ) {
+      for( auto dim : orthogonal_ ) {
+         key.push_back( static_cast< dip::sint >( coordinates_[ dim ] ));
+      }
+   }
+   return key;
+}
+
+void ImageDisplay::InputChanged() {
+   projectionCache_.clear();
+   sliceLimitsCache_.clear();
+   for( auto& lim : globalLimits_ ) {
+      lim.maxMin = { nan, nan };
+      lim.percentile = { nan, nan };
+   }
+   sliceIsDirty_ = true;
+}
+
 ImageDisplay::Limits ImageDisplay::GetLimits( bool compute ) {
    Limits* lims;
    if( globalStretch_ ) {
@@ -141,22 +173,22 @@ void ImageDisplay::UpdateSlice() {
                slice_ = image_.At( std::move( rangeArray ));
                break;
             }
-            case ProjectionMode::MAX: {
-               BooleanArray process( nDims, true );
-               process[ dim1_ ] = false;
-               process[ dim2_ ] = false;
-               if( image_.DataType().IsComplex() ) {
-                  MaximumAbs( image_, {}, slice_, process );
-               } else {
-                  Maximum( image_, {}, slice_, process );
-               }
-               break;
-            }
+            case ProjectionMode::MAX:
             case ProjectionMode::MEAN: {
-               BooleanArray process( nDims, true );
-               process[ dim1_ ] = false;
-               process[ dim2_ ] = false;
-               Mean( image_, {}, slice_, "", process );
+               Image& projection = projectionCache_[ {{ static_cast< dip::uint >( projectionMode_ ), dim1_, dim2_ }} ];
+               if( !projection.IsForged() ) {
+                  BooleanArray process( nDims, true );
+                  process[ dim1_ ] = false;
+                  process[ dim2_ ] = false;
+                  if( projectionMode_ == ProjectionMode::MEAN ) {
+                     Mean( image_, {}, projection, "", process );
+                  } else if( image_.DataType().IsComplex() ) {
+                     MaximumAbs( image_, {}, projection, process );
+                  } else {
+                     Maximum( image_, {}, projection, process );
+                  }
+               }
+               slice_ = projection; // shares the data, `slice_` is never written to
                break;
             }
          }
@@ -459,3 +491,66 @@ Image::Pixel ImageDisplay::MapSinglePixel( Image::Pixel const& input ) {
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the ImageDisplay projection and limits caches") {
+   // Pixel values x + y + 10 * z
+   dip::Image img( { 10, 8, 5 }, 1, dip::DT_UINT8 );
+   for( dip::uint z = 0; z < 5; ++z ) {
+      for( dip::uint y = 0; y < 8; ++y ) {
+         for( dip::uint x = 0; x < 10; ++x ) {
+            img.At( x, y, z ) = x + y + 10 * z;
+         }
+      }
+   }
+   dip::ImageDisplay display( img );
+   display.SetRange( "lin" );
+   // Projections along z
+   display.SetProjectionMode( "max" );
+   DOCTEST_CHECK( display.Slice().At( 3, 2 ).As< dip::dfloat >() == 45.0 );
+   display.SetProjectionMode( "mean" );
+   DOCTEST_CHECK( display.Slice().At( 3, 2 ).As< dip::dfloat >() == doctest::Approx( 25.0 ));
+   display.SetProjectionMode( "max" );
+   DOCTEST_CHECK( display.Slice().At( 3, 2 ).As< dip::dfloat >() == 45.0 );
+   // Limits of slices
+   display.SetProjectionMode( "slice" );
+   display.SetCoordinates( { 0, 0, 2 } );
+   display.Output();
+   dip::ImageDisplay::Limits limits = display.GetLimits( true );
+   DOCTEST_CHECK( limits.lower == 20.0 );
+   DOCTEST_CHECK( limits.upper == 36.0 );
+   display.SetCoordinates( { 0, 0, 0 } );
+   display.Output();
+   limits = display.GetLimits( true );
+   DOCTEST_CHECK( limits.lower == 0.0 );
+   DOCTEST_CHECK( limits.upper == 16.0 );
+   // Going back to a slice we've shown before gives the same limits
+   display.SetCoordinates( { 0, 0, 2 } );
+   display.Output();
+   limits = display.GetLimits( true );
+   DOCTEST_CHECK( limits.lower == 20.0 );
+   DOCTEST_CHECK( limits.upper == 36.0 );
+   // ... which come from the cache: a change to the pixel data that isn't signaled is not seen
+   img.At( 3, 2, 2 ) = 200;
+   display.SetCoordinates( { 0, 0, 0 } );
+   display.Output();
+   display.SetCoordinates( { 0, 0, 2 } );
+   display.Output();
+   limits = display.GetLimits( true );
+   DOCTEST_CHECK( limits.lower == 20.0 );
+   DOCTEST_CHECK( limits.upper == 36.0 );
+   // Modifying the shared pixel data requires a call to `InputChanged`
+   img.Fill( 7 );
+   display.InputChanged();
+   display.Output();
+   limits = display.GetLimits( true );
+   DOCTEST_CHECK( limits.lower == 7.0 );
+   DOCTEST_CHECK( limits.upper == 7.0 );
+   display.SetProjectionMode( "max" );
+   DOCTEST_CHECK( display.Slice().At( 3, 2 ).As< dip::dfloat >() == 7.0 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -26,6 +26,7 @@
 #include "diplib/generation.h"
 #include "diplib/iterators.h"
 #include "diplib/overload.h"
+#include "diplib/multithreading.h"
 
 namespace dip {
 
@@ -127,6 +128,49 @@ PriorityQueue CreateAndInitializePriorityQueue(
 }
 
 
+// Solves the discretized eikonal equation at one pixel. `nValues` contains, for each dimension, the smallest
+// distance value of the two neighbors along that dimension (or infinity if there are none). `dist` contains
+// 1/d^2 for each dimension, with d the pixel size. `W` is the weight at the pixel. Both arrays are modified.
+dfloat SolveEikonal( FloatArray& nValues, FloatArray& dist, dfloat W ) {
+   nValues.sort( dist );
+   // Find: sum{(value - nValues[i])^2 * dist[i]} = W^2, subject to: value >= nValues[i]
+   // (note that dist[i] is 1/d[i]^2, the inverse of the square distance between pixels along each dimension)
+   dip::uint k = nValues.size(); // The sum is over the first k elements, as long as value >= nValues[i]
+   while(( k > 0 ) && std::isinf( nValues[ k - 1 ] )) {
+      --k;
+   }
+   if( k == 0 ) {
+      return infinity; // No neighbor has a distance yet
+   }
+   // So we solve: sum(dist) * value^2 - 2 * value * sum(nValues*dist) + sum(nValues^2*dist) - W^2 = 0
+   //           => value = {sum(nValues*dist) + sqrt( X )} / sum(dist)
+   //        with: X = sum(nValues*dist)^2 - sum(dist) * {sum(nValues^2*dist) - W^2}, X >= 0
+   // (update rule inspired by code here: https://github.com/gpeyre/matlab-toolboxes/tree/master/toolbox_fast_marching/mex)
+   dfloat value = 0;
+   do {
+      if( k == 1 ) {
+         value = nValues[ 0 ] + W / std::sqrt( dist[ 0 ] );
+         break;
+      }
+      dfloat sumvd = 0;    // sum(nValues*dist)
+      dfloat sumv2d = 0;   // sum(nValues^2*dist)
+      dfloat sumd = 0;     // sum(dist)
+      for( dip::uint ii = 0; ii < k; ++ii ) {
+         sumvd += nValues[ ii ] * dist[ ii ];
+         sumv2d += nValues[ ii ] * nValues[ ii ] * dist[ ii ];
+         sumd += dist[ ii ];
+      }
+      dfloat X = sumvd * sumvd - sumd * ( sumv2d - W * W );
+      if( X >= 0 ) {
+         value = ( sumvd + std::sqrt( X )) / sumd;
+      } else {
+         value = 0;
+      }
+      --k;
+   } while( value < nValues[ k ] );
+   return value;
+}
+
 template< typename TPI >
 void dip__FastMarchingAlgorithm(
       Image const& im_weights,
@@ -206,40 +250,8 @@ void dip__FastMarchingAlgorithm(
             nValues[ dim ] = std::min< dfloat >( nValues[ dim ], gdt[ nneigh ] );
          }
          dist = distances;
-         nValues.sort( dist );
          dfloat W = weights ? static_cast< dfloat >( weights[ neigh ] ) : 1.0;
-         // Find: sum{(value - nValues[i])^2 * dist[i]} = W^2, subject to: value >= nValues[i]
-         // (note that dist[i] is 1/d[i]^2, the inverse of the square distance between pixels along each dimension)
-         dip::uint k = nValues.size(); // The sum is over the first k elements, as long as value >= nValues[i]
-         while( std::isinf( nValues[ k - 1 ] )) { // There's always at least one valid value in here.
-            --k;
-         }
-         // So we solve: sum(dist) * value^2 - 2 * value * sum(nValues*dist) + sum(nValues^2*dist) - W^2 = 0
-         //           => value = {sum(nValues*dist) + sqrt( X )} / sum(dist)
-         //        with: X = sum(nValues*dist)^2 - sum(dist) * {sum(nValues^2*dist) - W^2}, X >= 0
-         // (update rule inspired by code here: https://github.com/gpeyre/matlab-toolboxes/tree/master/toolbox_fast_marching/mex)
-         dfloat value = 0;
-         do {
-            if( k == 1 ) {
-               value = nValues[ 0 ] + W / std::sqrt( dist[ 0 ] );
-               break;
-            }
-            dfloat sumvd = 0;    // sum(nValues*dist)
-            dfloat sumv2d = 0;   // sum(nValues^2*dist)
-            dfloat sumd = 0;     // sum(dist)
-            for( dip::uint ii = 0; ii < k; ++ii ) {
-               sumvd += nValues[ ii ] * dist[ ii ];
-               sumv2d += nValues[ ii ] * nValues[ ii ] * dist[ ii ];
-               sumd += dist[ ii ];
-            }
-            dfloat X = sumvd * sumvd - sumd * ( sumv2d - W * W );
-            if( X >= 0 ) {
-               value = ( sumvd + std::sqrt( X )) / sumd;
-            } else {
-               value = 0;
-            }
-            --k;
-         } while( value < nValues[ k ] );
+         dfloat value = SolveEikonal( nValues, dist, W );
          // Update
          // If we could update stuff that's in the queue, we'd check the INQUEUE flag to see if it's in the queue or not.
          if( value < gdt[ neigh ] ) {
@@ -251,6 +263,153 @@ void dip__FastMarchingAlgorithm(
    }
 }
 
+// Calls `function( offset )` for each pixel on the diagonal hyperplane `sum(coords) == remaining` (where the
+// coordinates are counted from the corner given by `flip`), for dimensions `dim` and up. The pixel's coordinates
+// are written to `coords`. `maxRest[ii]` is the largest possible sum of the coordinates for dimensions `ii+1`
+// and up.
+template< typename F >
+void ForEachPixelOnLevel(
+      dip::uint dim,
+      dip::uint remaining,
+      dip::sint offset,
+      UnsignedArray& coords,
+      UnsignedArray const& sizes,
+      IntegerArray const& strides,
+      UnsignedArray const& maxRest,
+      BooleanArray const& flip,
+      F const& function
+) {
+   // Along the last dimension, `first == last`
+   dip::uint first = remaining > maxRest[ dim ] ? remaining - maxRest[ dim ] : 0;
+   dip::uint last = std::min( sizes[ dim ] - 1, remaining );
+   for( dip::uint ii = first; ii <= last; ++ii ) {
+      coords[ dim ] = flip[ dim ] ? sizes[ dim ] - 1 - ii : ii;
+      dip::sint newOffset = offset + static_cast< dip::sint >( coords[ dim ] ) * strides[ dim ];
+      if( dim == sizes.size() - 1 ) {
+         function( newOffset );
+      } else {
+         ForEachPixelOnLevel( dim + 1, remaining - ii, newOffset, coords, sizes, strides, maxRest, flip, function );
+      }
+   }
+}
+
+// The fast sweeping method solves the same discretized eikonal equation as the fast marching method, using
+// Gauss-Seidel iterations that sweep the image in each of the 2^n diagonal directions, until nothing changes.
+// Each sweep processes the image one diagonal hyperplane at the time. Pixels on a hyperplane do not depend
+// on each other, so they are processed in parallel, and the result does not depend on the number of threads
+// (Detrixhe, Gibou and Min, 2013).
+template< typename TPI >
+void dip__FastSweepingAlgorithm(
+      Image const& im_weights,
+      Image& im_gdt,
+      Image& im_flags,
+      FloatArray distances   // We modify this
+) {
+   // Get data pointers
+   TPI const* weights = im_weights.IsForged() ? static_cast< TPI const* >( im_weights.Origin() ) : nullptr;
+   sfloat* gdt = static_cast< sfloat* >( im_gdt.Origin() );
+   uint8* flags = static_cast< uint8* >( im_flags.Origin() );
+   UnsignedArray const& sizes = im_gdt.Sizes();
+   IntegerArray const& strides = im_gdt.Strides();
+   dip::uint nDims = sizes.size();
+   if( nDims == 0 ) {
+      return; // A single pixel, it's either background or unreachable
+   }
+
+   // Pixel sizes
+   for( auto& d : distances ) {
+      d = 1.0 / ( d * d );
+   }
+
+   // Background and masked pixels are never updated: we mark them as finished
+   ImageIterator< uint8 > it( im_flags );
+   it.OptimizeAndFlatten();
+   do {
+      dip::sint offset = it.Offset();
+      if(( gdt[ offset ] == 0 ) || IsSet( flags[ offset ], MASKED )) {
+         Set( flags[ offset ], FINISHED );
+      }
+   } while( ++it );
+
+   // Hyperplanes are indexed by `level`, the sum of the coordinates
+   UnsignedArray maxRest( nDims, 0 );
+   for( dip::uint ii = nDims - 1; ii > 0; --ii ) {
+      maxRest[ ii - 1 ] = maxRest[ ii ] + sizes[ ii ] - 1;
+   }
+   dip::uint nLevels = maxRest[ 0 ] + sizes[ 0 ];
+
+   // Distribute each hyperplane over the threads by the coordinate along the first dimension
+   dip::uint nThreads = im_gdt.NumberOfPixels() < threadingThreshold ? 1 : GetNumberOfThreads();
+   std::vector< uint8 > changed( nThreads );
+   bool anyChanged;
+   do {
+      anyChanged = false;
+      for( dip::uint direction = 0; direction < ( 1u << nDims ); ++direction ) {
+         BooleanArray flip( nDims );
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            flip[ ii ] = ( direction & ( 1u << ii )) != 0;
+         }
+         std::fill( changed.begin(), changed.end(), 0 );
+         #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+         {
+            dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+            FloatArray nValues( nDims );
+            FloatArray dist( nDims );
+            UnsignedArray coords( nDims );
+            // Each thread records changes in a local variable, and writes it to the shared array only once
+            // at the end, to avoid false sharing in the inner loop
+            bool threadChanged = false;
+            auto Update = [ & ]( dip::sint offset ) {
+               if( IsSet( flags[ offset ], FINISHED )) {
+                  return;
+               }
+               // Get neighbor values in each direction, the pixel's coordinates are in `coords`
+               for( dip::uint ii = 0; ii < nDims; ++ii ) {
+                  dfloat value = infinity;
+                  if( coords[ ii ] > 0 ) {
+                     dip::sint neigh = offset - strides[ ii ];
+                     if( !IsSet( flags[ neigh ], MASKED )) {
+                        value = gdt[ neigh ];
+                     }
+                  }
+                  if( coords[ ii ] + 1 < sizes[ ii ] ) {
+                     dip::sint neigh = offset + strides[ ii ];
+                     if( !IsSet( flags[ neigh ], MASKED )) {
+                        value = std::min< dfloat >( value, gdt[ neigh ] );
+                     }
+                  }
+                  nValues[ ii ] = value;
+               }
+               dist = distances;
+               dfloat W = weights ? static_cast< dfloat >( weights[ offset ] ) : 1.0;
+               sfloat value = static_cast< sfloat >( SolveEikonal( nValues, dist, W ));
+               if( value < gdt[ offset ] ) {
+                  gdt[ offset ] = value;
+                  threadChanged = true;
+               }
+            };
+            for( dip::uint level = 0; level < nLevels; ++level ) {
+               // Range of coordinates along the first dimension for this level
+               dip::uint first = level > maxRest[ 0 ] ? level - maxRest[ 0 ] : 0;
+               dip::uint last = std::min( sizes[ 0 ] - 1, level );
+               #pragma omp for schedule( static )
+               for( dip::sint ii = static_cast< dip::sint >( first ); ii <= static_cast< dip::sint >( last ); ++ii ) {
+                  coords[ 0 ] = flip[ 0 ] ? sizes[ 0 ] - 1 - static_cast< dip::uint >( ii ) : static_cast< dip::uint >( ii );
+                  dip::sint offset = static_cast< dip::sint >( coords[ 0 ] ) * strides[ 0 ];
+                  if( nDims == 1 ) {
+                     Update( offset );
+                  } else {
+                     ForEachPixelOnLevel( 1, level - static_cast< dip::uint >( ii ), offset, coords, sizes, strides, maxRest, flip, Update );
+                  }
+               }
+            }
+            changed[ thread ] = threadChanged;
+         }
+         anyChanged |= std::find( changed.begin(), changed.end(), 1 ) != changed.end();
+      }
+   } while( anyChanged );
+}
+
 template< typename TPI >
 void dip__ChamferMetricAlgorithm(
       Image const& im_weights,
@@ -348,10 +507,12 @@ void GreyWeightedDistanceTransform(
    }
 
    // What will we output?
-   bool fastMarching; // true if fast marching algorithm, false if chamfer algorithm.
+   bool fastMarching; // true if fast marching or fast sweeping algorithm, false if chamfer algorithm.
+   bool fastSweeping = false;
    bool outputDistance = false;
-   if( mode == S::FASTMARCHING ) {
+   if(( mode == S::FASTMARCHING ) || ( mode == S::FASTSWEEPING )) {
       fastMarching = true;
+      fastSweeping = mode == S::FASTSWEEPING;
       metric = {}; // use the default city-block neighborhood
    } else {
       fastMarching = false;
@@ -482,7 +643,11 @@ void GreyWeightedDistanceTransform(
       for( dip::uint ii = 0; ii < dims; ++ii ) {
          distances[ ii ] = out.PixelSize( ii ).magnitude;
       }
-      DIP_OVL_CALL_REAL( dip__FastMarchingAlgorithm, ( grey, out, flags, neighborhood, offsets, coordComputer, distances ), grey.DataType());
+      if( fastSweeping ) {
+         DIP_OVL_CALL_REAL( dip__FastSweepingAlgorithm, ( grey, out, flags, distances ), grey.DataType());
+      } else {
+         DIP_OVL_CALL_REAL( dip__FastMarchingAlgorithm, ( grey, out, flags, neighborhood, offsets, coordComputer, distances ), grey.DataType());
+      }
    } else {
       if( outputDistance ) {
          out.swap( tmp ); // We need to use these in a different order...
@@ -492,3 +657,58 @@ void GreyWeightedDistanceTransform(
 }
 
 } // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/random.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the fast sweeping grey-weighted distance transform") {
+   dip::Image grey( { 50, 40, 40 }, 1, dip::DT_SFLOAT );
+   grey.Fill( 1 );
+   dip::Random random( 0 );
+   dip::UniformNoise( grey, grey, random, 1, 5 );
+   dip::Image bin = grey < 4.99;        // a few background pixels
+   dip::Image mask = grey < 4.5;        // paths go around the high-weight pixels
+   mask.At( bin == 0 ) = true;
+   dip::Image fm = dip::GreyWeightedDistanceTransform( grey, bin, mask, {}, dip::S::FASTMARCHING );
+   dip::Image fs = dip::GreyWeightedDistanceTransform( grey, bin, mask, {}, dip::S::FASTSWEEPING );
+   dip::Image finite = fm < dip::infinity;
+   DOCTEST_CHECK( dip::testing::CompareImages( finite, fs < dip::infinity ));
+   DOCTEST_CHECK( dip::MaximumAbsoluteError( fs, fm, finite ) < 1e-4 * dip::Maximum( fm, finite ).As< dip::dfloat >() );
+   // The result doesn't depend on the number of threads
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Image fs1 = dip::GreyWeightedDistanceTransform( grey, bin, mask, {}, dip::S::FASTSWEEPING );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( dip::testing::CompareImages( fs, fs1 ));
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the fast sweeping grey-weighted distance transform on known values") {
+   // With the seed a full column and weights that vary only along x, the distance is the cumulative sum
+   // of the weights along x
+   dip::Image grey( { 5, 4 }, 1, dip::DT_SFLOAT );
+   dip::Image bin( { 5, 4 }, 1, dip::DT_BIN );
+   for( dip::uint ii = 0; ii < 5; ++ii ) {
+      grey.At( dip::Range( static_cast< dip::sint >( ii )), dip::Range{} ).Fill( static_cast< dip::dfloat >( ii + 1 ));
+      bin.At( dip::Range( static_cast< dip::sint >( ii )), dip::Range{} ).Fill( ii > 0 );
+   }
+   dip::Image out = dip::GreyWeightedDistanceTransform( grey, bin, {}, {}, dip::S::FASTSWEEPING );
+   DOCTEST_CHECK( out.At( 1, 2 ).As< dip::dfloat >() == doctest::Approx( 2.0 ));
+   DOCTEST_CHECK( out.At( 4, 0 ).As< dip::dfloat >() == doctest::Approx( 2.0 + 3.0 + 4.0 + 5.0 ));
+   // In 2D with unit weights, the distance along the axes is exact, and the diagonal neighbor of the seed
+   // satisfies ( u - 1 )^2 + ( u - 1 )^2 = 1
+   grey = dip::Image( { 9, 9 }, 1, dip::DT_SFLOAT );
+   grey.Fill( 1 );
+   bin = dip::Image( { 9, 9 }, 1, dip::DT_BIN );
+   bin.Fill( true );
+   bin.At( 4, 4 ) = false;
+   out = dip::GreyWeightedDistanceTransform( grey, bin, {}, {}, dip::S::FASTSWEEPING );
+   DOCTEST_CHECK( out.At( 4, 4 ).As< dip::dfloat >() == 0.0 );
+   DOCTEST_CHECK( out.At( 8, 4 ).As< dip::dfloat >() == doctest::Approx( 4.0 ));
+   DOCTEST_CHECK( out.At( 4, 0 ).As< dip::dfloat >() == doctest::Approx( 4.0 ));
+   DOCTEST_CHECK( out.At( 5, 5 ).As< dip::dfloat >() == doctest::Approx( 1.0 + 1.0 / std::sqrt( 2.0 )));
+   DOCTEST_CHECK( out.At( 3, 3 ).As< dip::dfloat >() == doctest::Approx( 1.0 + 1.0 / std::sqrt( 2.0 )));
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -187,6 +187,141 @@ class DistanceTransformLineFilter : public Framework::SeparableLineFilter {
       bool squareDistance_;
 };
 
+// The vector distance transform: each pixel stores the vector to the nearest background pixel found so far.
+// In the first pass, this is the nearest background pixel along the image line. In each subsequent pass, the
+// vector to the nearest background pixel within the subspace spanned by the dimensions processed so far is
+// found by the same lower envelope of parabolas as used above, copying the vector of the minimizing pixel.
+// Pixels for which no background pixel has been found yet have a component equal to `maxDistance_`.
+class VectorDistanceTransformLineFilter : public Framework::SeparableLineFilter {
+   public:
+      VectorDistanceTransformLineFilter( FloatArray const& spacing, dfloat maxDistance )
+            : spacing_( spacing ), maxDistance_( maxDistance ) {}
+      virtual void SetNumberOfThreads( dip::uint threads ) override {
+         buffers_.resize( threads );
+         distances_.resize( threads );
+      }
+      virtual dip::uint GetNumberOfOperations( dip::uint lineLength, dip::uint nTensorElements, dip::uint, dip::uint ) override {
+         return lineLength * ( 20 + 2 * nTensorElements );
+      }
+      virtual void Filter( Framework::SeparableLineFilterParameters const& params ) override {
+         sfloat const* in = static_cast< sfloat const* >( params.inBuffer.buffer );
+         dip::sint inStride = params.inBuffer.stride;
+         dip::sint inTensorStride = params.inBuffer.tensorStride;
+         dip::uint length = params.inBuffer.length;
+         sfloat* out = static_cast< sfloat* >( params.outBuffer.buffer );
+         dip::sint outStride = params.outBuffer.stride;
+         dip::sint outTensorStride = params.outBuffer.tensorStride;
+         dip::uint nDims = params.inBuffer.tensorLength;
+         dip::uint dim = params.dimension;
+         dfloat const spacing = spacing_[ dim ];
+         dip::sint padding = static_cast< dip::sint >( params.inBuffer.border ); // 0 or 1, 1 means that the image edge is background
+         dip::sint len = static_cast< dip::sint >( length );
+
+         if( params.pass == 0 ) {
+            // Find the nearest background pixel along the line, the input is 0 for background pixels
+            // 1: Forward, store the index of the nearest background pixel to the left
+            constexpr dip::sint NONE = std::numeric_limits< dip::sint >::max();
+            auto& buffer = buffers_[ params.thread ];
+            buffer.resize( length );
+            dip::sint* nearest = buffer.data();
+            dip::sint last = padding ? -1 : NONE;
+            for( dip::sint u = 0; u < len; ++u ) {
+               if( in[ u * inStride ] == 0 ) {
+                  last = u;
+               }
+               nearest[ u ] = last;
+            }
+            // 2: Backward, compare to the nearest background pixel to the right
+            last = padding ? len : NONE;
+            for( dip::sint u = len - 1; u >= 0; --u ) {
+               if( in[ u * inStride ] == 0 ) {
+                  last = u;
+               }
+               if(( last != NONE ) && (( nearest[ u ] == NONE ) || ( last - u < u - nearest[ u ] ))) {
+                  nearest[ u ] = last;
+               }
+               sfloat* pout = out + u * outStride;
+               for( dip::uint jj = 0; jj < nDims; ++jj ) {
+                  pout[ static_cast< dip::sint >( jj ) * outTensorStride ] = 0;
+               }
+               pout[ static_cast< dip::sint >( dim ) * outTensorStride ] = nearest[ u ] == NONE
+                     ? static_cast< sfloat >( maxDistance_ )
+                     : static_cast< sfloat >( spacing * static_cast< dfloat >( nearest[ u ] - u ));
+            }
+            return;
+         }
+
+         // Subsequent passes
+         in -= padding * inStride;
+         dip::sint paddedLength = len + 2 * padding;
+         auto& buffer = buffers_[ params.thread ];
+         buffer.resize( 2 * static_cast< dip::uint >( paddedLength ));
+         dip::sint* S = buffer.data();
+         dip::sint* T = S + paddedLength;
+         auto& distances = distances_[ params.thread ];
+         distances.resize( static_cast< dip::uint >( paddedLength ));
+         dfloat* g = distances.data();
+         for( dip::sint u = 0; u < paddedLength; ++u ) {
+            sfloat const* pin = in + u * inStride;
+            dfloat d2 = 0;
+            for( dip::uint jj = 0; jj < nDims; ++jj ) {
+               dfloat v = pin[ static_cast< dip::sint >( jj ) * inTensorStride ];
+               d2 += v * v;
+            }
+            g[ u ] = d2;
+         }
+
+         // 3: Forward, compute the lower envelope of the parabolas
+         dip::sint q = 0;
+         S[ 0 ] = 0;
+         T[ 0 ] = 0;
+         for( dip::sint u = 1; u < paddedLength; ++u ) {
+            while( q >= 0 ) {
+               dfloat d1 = spacing * static_cast< dfloat >( T[ q ] - S[ q ] );
+               dfloat d2 = spacing * static_cast< dfloat >( T[ q ] - u );
+               if(( d1 * d1 + g[ S[ q ]] ) < ( d2 * d2 + g[ u ] )) {
+                  break;
+               }
+               --q;
+            }
+            if( q < 0 ) {
+               q = 0;
+               S[ 0 ] = u;
+               T[ 0 ] = 0;
+            } else {
+               dfloat d1 = spacing * static_cast< dfloat >( u );
+               dfloat d2 = spacing * static_cast< dfloat >( S[ q ] );
+               dfloat w = std::floor( 1 + ( d1 * d1 - d2 * d2 + g[ u ] - g[ S[ q ]] ) / ( 2 * ( d1 - d2 ) * spacing ));
+               if( w < static_cast< dfloat >( paddedLength )) {
+                  ++q;
+                  S[ q ] = u;
+                  T[ q ] = static_cast< dip::sint >( w );
+               }
+            }
+         }
+
+         // 4: Backward, copy the vector of the minimizing pixel, and add the displacement along this dimension
+         for( dip::sint u = paddedLength - 1; u >= 0; --u ) {
+            if(( u >= padding ) && ( u < len + padding )) {
+               sfloat const* pin = in + S[ q ] * inStride;
+               sfloat* pout = out + ( u - padding ) * outStride;
+               for( dip::uint jj = 0; jj < nDims; ++jj ) {
+                  pout[ static_cast< dip::sint >( jj ) * outTensorStride ] = pin[ static_cast< dip::sint >( jj ) * inTensorStride ];
+               }
+               pout[ static_cast< dip::sint >( dim ) * outTensorStride ] = static_cast< sfloat >( spacing * static_cast< dfloat >( S[ q ] - u ));
+            }
+            if( u == T[ q ] ) {
+               --q;
+            }
+         }
+      }
+   private:
+      FloatArray const& spacing_;
+      std::vector< std::vector< dip::sint >> buffers_;   // one for each thread
+      std::vector< std::vector< dfloat >> distances_;    // one for each thread
+      dfloat maxDistance_;
+};
+
 } // namespace
 
 // Implements `dip::EuclideanDistanceTransform(...,"separable")`
@@ -212,6 +347,33 @@ void SeparableDistanceTransform(
    }
 }
 
+// Implements `dip::VectorDistanceTransform(...,"separable")`
+void SeparableVectorDistanceTransform(
+      Image const& in,
+      Image& out,
+      FloatArray const& spacing,
+      bool border
+) {
+   dip::uint nDims = in.Dimensionality();
+   dfloat maxDistance2 = 1;
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      dfloat d = static_cast< dfloat >( in.Size( ii )) * spacing[ ii ];
+      maxDistance2 += d * d;
+   }
+   // The input to the separable framework is a vector image with the binary image in the first component
+   Image tmp( in.Sizes(), nDims, DT_SFLOAT );
+   tmp.Fill( 0 );
+   DIP_STACK_TRACE_THIS( tmp[ 0 ].Copy( in ));
+   VectorDistanceTransformLineFilter lineFilter( spacing, std::sqrt( maxDistance2 ));
+   if( border ) {
+      DIP_STACK_TRACE_THIS( Framework::Separable( tmp, out, DT_SFLOAT, DT_SFLOAT,
+            {}, {}, {}, lineFilter, Framework::SeparableOption::UseInputBuffer ));
+   } else {
+      DIP_STACK_TRACE_THIS( Framework::Separable( tmp, out, DT_SFLOAT, DT_SFLOAT,
+            {}, { 1 }, { BoundaryCondition::ADD_ZEROS }, lineFilter, Framework::SeparableOption::UseInputBuffer ));
+   }
+}
+
 } // namespace dip
 
 
@@ -220,6 +382,7 @@ void SeparableDistanceTransform(
 #include "diplib/math.h"
 #include "diplib/statistics.h"
 #include "diplib/generation.h"
+#include "diplib/random.h"
 
 DOCTEST_TEST_CASE("[DIPlib] testing the distance transform") {
    // 1D case
@@ -318,4 +481,48 @@ DOCTEST_TEST_CASE("[DIPlib] testing the distance transform") {
    }
 }
 
+DOCTEST_TEST_CASE("[DIPlib] testing the separable vector distance transform") {
+   for( dip::uint nDims = 2; nDims <= 3; ++nDims ) {
+      dip::UnsignedArray sizes( nDims, 23 );
+      sizes[ 0 ] = 31;
+      dip::Image in( sizes, 1, dip::DT_SFLOAT );
+      in.Fill( 0 );
+      dip::Random random( 0 );
+      dip::UniformNoise( in, in, random, 0, 1 );
+      in = in > 0.05;
+      in.SetPixelSize( dip::PhysicalQuantityArray{ 0.1 * dip::Units::Meter(), 0.13 * dip::Units::Meter() } );
+      for( auto const& border : { dip::S::OBJECT, dip::S::BACKGROUND } ) {
+         dip::Image vdt = dip::VectorDistanceTransform( in, border, dip::S::SEPARABLE );
+         DOCTEST_REQUIRE( vdt.TensorElements() == nDims );
+         dip::Image edt = dip::EuclideanDistanceTransform( in, border, dip::S::SEPARABLE );
+         DOCTEST_CHECK( dip::MaximumAbsoluteError( dip::Norm( vdt ), edt ) < 1e-5 );
+         if( border == dip::S::OBJECT ) {
+            dip::Image bf = dip::VectorDistanceTransform( in, border, dip::S::BRUTE_FORCE );
+            DOCTEST_CHECK( dip::MaximumAbsoluteError( dip::Norm( vdt ), dip::Norm( bf )) < 1e-5 );
+         }
+      }
+   }
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the separable vector distance transform on known values") {
+   // A single background pixel at ( 2, 1 ): each vector points from the pixel to it
+   dip::Image in( { 9, 7 }, 1, dip::DT_BIN );
+   in.Fill( true );
+   in.At( 2, 1 ) = false;
+   dip::Image vdt = dip::VectorDistanceTransform( in, dip::S::OBJECT, dip::S::SEPARABLE );
+   DOCTEST_CHECK( vdt.At( 6, 4 ) == dip::Image::Pixel( { -4.0, -3.0 } ));
+   DOCTEST_CHECK( vdt.At( 0, 0 ) == dip::Image::Pixel( { 2.0, 1.0 } ));
+   DOCTEST_CHECK( vdt.At( 2, 1 ) == dip::Image::Pixel( { 0.0, 0.0 } ));
+   // The vector components are in physical units
+   in.SetPixelSize( dip::PhysicalQuantityArray{ 0.5 * dip::Units::Meter(), 2.0 * dip::Units::Meter() } );
+   vdt = dip::VectorDistanceTransform( in, dip::S::OBJECT, dip::S::SEPARABLE );
+   DOCTEST_CHECK( vdt.At( 6, 4 ) == dip::Image::Pixel( { -2.0, -6.0 } ));
+   // With a background border, the nearest background pixel is just outside the image
+   in.At( 2, 1 ) = true;
+   in.ResetPixelSize();
+   vdt = dip::VectorDistanceTransform( in, dip::S::BACKGROUND, dip::S::SEPARABLE );
+   DOCTEST_CHECK( vdt.At( 1, 3 ) == dip::Image::Pixel( { -2.0, 0.0 } ));
+   DOCTEST_CHECK( vdt.At( 7, 3 ) == dip::Image::Pixel( { 2.0, 0.0 } ));
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -34,6 +34,14 @@ DIP_NO_EXPORT void SeparableDistanceTransform(
       bool squareDistance = false   // Set to true to return square distances -- should be slightly cheaper
 );
 
+// Implements `dip::VectorDistanceTransform(...,"separable")`
+DIP_NO_EXPORT void SeparableVectorDistanceTransform(
+      Image const& in,              // Must be forged, scalar and binary
+      Image& out,
+      FloatArray const& spacing,    // Must be given, and have one value for each dimension in `in`
+      bool border = false           // Values outside the image are background by default
+);
+
 } // namespace dip
 
 #endif // DIP_SEPARABLE_DT_H
@@ -21,6 +21,8 @@
 #include "diplib.h"
 #include "diplib/distance.h"
 
+#include "separable_dt.h"
+
 namespace dip {
 
 namespace {
@@ -1693,7 +1695,7 @@ void VectorDistanceTransform(
    DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
    DIP_THROW_IF( !in.DataType().IsBinary(), E::DATA_TYPE_NOT_SUPPORTED );
    dip::uint dim = in.Dimensionality();
-   DIP_THROW_IF(( dim > 3 ) || ( dim < 2 ), E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF( dim < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
    UnsignedArray sizes = in.Sizes();
 
    bool objectBorder;
@@ -1707,6 +1709,14 @@ void VectorDistanceTransform(
       }
    }
 
+   if( method == S::SEPARABLE ) {
+      PixelSize pixelSize = in.PixelSize();
+      DIP_STACK_TRACE_THIS( SeparableVectorDistanceTransform( in, out, dist, objectBorder ));
+      out.SetPixelSize( pixelSize );
+      return;
+   }
+   DIP_THROW_IF(( dim > 3 ) || ( dim < 2 ), E::DIMENSIONALITY_NOT_SUPPORTED );
+
    // Convert in to out and get data pointer of out
    Image tmpIn = in.QuickCopy(); // preserve the input data, in case &in == &out
    out.ReForge( in.Sizes(), dim, DT_SFLOAT );
@@ -20,6 +20,16 @@
 
 #include "file_io_support.h"
 
+#ifdef _WIN32
+   #define NOMINMAX // windows.h must not define min() and max(), which are conflicting with std::min() and std::max()
+   #include <windows.h>
+#else
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
+
 namespace dip {
 
 RangeArray ConvertRoiSpec(
@@ -101,4 +111,49 @@ RoiSpec CheckAndConvertRoi(
    return roiSpec;
 }
 
+DataSegment MapFileCopyOnWrite( String const& filename, dip::uint& size ) {
+   size = 0;
+#ifdef _WIN32
+   HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+   if( file == INVALID_HANDLE_VALUE ) {
+      return {};
+   }
+   LARGE_INTEGER fileSize;
+   if( !GetFileSizeEx( file, &fileSize ) || ( fileSize.QuadPart == 0 )) {
+      CloseHandle( file );
+      return {};
+   }
+   HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+   CloseHandle( file ); // The mapping keeps its own reference to the file
+   if( mapping == nullptr ) {
+      return {};
+   }
+   void* ptr = MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+   CloseHandle( mapping ); // The view keeps its own reference to the mapping
+   if( ptr == nullptr ) {
+      return {};
+   }
+   size = static_cast< dip::uint >( fileSize.QuadPart );
+   return DataSegment{ ptr, []( void* p ) { UnmapViewOfFile( p ); }};
+#else
+   int file = open( filename.c_str(), O_RDONLY );
+   if( file < 0 ) {
+      return {};
+   }
+   struct stat fileStat{};
+   if(( fstat( file, &fileStat ) != 0 ) || ( fileStat.st_size <= 0 )) {
+      close( file );
+      return {};
+   }
+   dip::uint mapSize = static_cast< dip::uint >( fileStat.st_size );
+   void* ptr = mmap( nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0 );
+   close( file ); // The mapping keeps its own reference to the file
+   if( ptr == MAP_FAILED ) {
+      return {};
+   }
+   size = mapSize;
+   return DataSegment{ ptr, [ mapSize ]( void* p ) { munmap( p, mapSize ); }};
+#endif
+}
+
 } // namespace
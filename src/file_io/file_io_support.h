@@ -48,6 +48,27 @@ RoiSpec CheckAndConvertRoi(
       dip::uint nDims
 );
 
+// Maps the file `filename` into memory, copy-on-write: the data can be modified through the returned
+// pointer, but changes are never written back to the file. Pages are shared with the OS file cache until
+// they are written to. The mapping is released when the last copy of the returned `DataSegment` is destroyed.
+// On failure, returns an empty `DataSegment`; on success, `size` is set to the size of the file in bytes.
+DataSegment MapFileCopyOnWrite( String const& filename, dip::uint& size );
+
+// Writes tiles to an existing uncompressed ICS file, such as one created with `dip::ImageCreateICS`. The header
+// is parsed once, and the data file is kept open for the lifetime of the object.
+class ICSTileWriter {
+   public:
+      explicit ICSTileWriter( String const& filename );
+      ICSTileWriter( ICSTileWriter const& ) = delete;
+      ICSTileWriter& operator=( ICSTileWriter const& ) = delete;
+      ~ICSTileWriter();
+      // Writes `tile` to the file, with its first pixel at `origin`. See `dip::ImageWriteICSTile`.
+      void Write( Image const& tile, UnsignedArray const& origin );
+   private:
+      struct Impl;
+      std::unique_ptr< Impl > impl_;
+};
+
 } // namespace dip
 
 #endif //DIP_FILE_IO_SUPPORT_H
@@ -21,16 +21,22 @@
 #ifdef DIP__HAS_ICS
 
 #include <cstdlib> // std::strtoul
+#include <fstream>
 
 #include "diplib.h"
 #include "diplib/file_io.h"
 #include "diplib/generic_iterators.h"
 #include "diplib/library/copy_buffer.h"
+#include "diplib/multithreading.h"
 
 #include "file_io_support.h"
 
 #include "libics.h"
 
+#ifdef DIP__HAS_ZLIB
+#include "zlib.h"
+#endif
+
 namespace dip {
 
 namespace {
@@ -283,10 +289,27 @@ class IcsFile {
             }
          }
       }
+      // Closes the file after writing only the header. The caller is responsible for writing the pixel data,
+      // which is expected to go into the file named by `DataFileName()`. Call only for files opened for writing,
+      // after setting all metadata but not the pixel data.
+      void CloseHeaderOnly() {
+         if( ics_ ) {
+            dataFileName_ = ics_->version == 1 ? FileAddExtension( ics_->filename, "ids" ) : String( ics_->filename );
+            Ics_Error error = IcsClose( ics_ );
+            ics_ = nullptr;
+            // libics writes the header, then complains that there's no data to write
+            if(( error != IcsErr_Ok ) && ( error != IcsErr_MissingData )) {
+               DIP_THROW_RUNTIME( String( "Couldn't close ICS file: " ) + IcsGetErrorText( error ) );
+            }
+         }
+      }
+      // After `CloseHeaderOnly()`, returns the name of the file that should contain the pixel data
+      String const& DataFileName() const { return dataFileName_; }
       // Implicit cast to ICS*
       operator ICS*() { return ics_; }
    private:
       ICS* ics_ = nullptr;
+      String dataFileName_;
 };
 
 struct GetICSInfoData {
@@ -421,6 +444,69 @@ GetICSInfoData GetICSInfo( IcsFile& icsFile ) {
    return data;
 }
 
+// Returns true if the data in the ICS file is stored in the byte order of this machine
+bool HasNativeByteOrder( ICS* ics ) {
+   dip::uint16 test = 1;
+   bool littleEndian = *reinterpret_cast< dip::uint8* >( &test ) == 1;
+   int bytes = static_cast< int >( IcsGetImelSize( ics ));
+   bool isComplex = ( ics->imel.dataType == Ics_complex32 ) || ( ics->imel.dataType == Ics_complex64 );
+   int hbytes = isComplex ? bytes / 2 : bytes;
+   for( int ii = 0; ii < bytes; ++ii ) {
+      int expected = littleEndian ? ii + 1 : ( ii < hbytes ? hbytes - ii : bytes + hbytes - ii );
+      if( ics->byteOrder[ ii ] != expected ) {
+         return false;
+      }
+   }
+   return true;
+}
+
+// Returns the name of the file that contains the pixel data
+String GetICSDataFileName( ICS* ics ) {
+   if( ics->version == 1 ) {
+      return FileAddExtension( ics->filename, "ids" );
+   }
+   return ics->srcFile;
+}
+
+// Creates an image that uses the memory-mapped data file as its data segment. `strides` are the strides
+// of the image on file (in samples), with the tensor dimension last if there is one. Returns false if the
+// file cannot be mapped, in which case `out` is not modified.
+bool MapICSData(
+      IcsFile& icsFile,
+      GetICSInfoData const& data,
+      RoiSpec const& roiSpec,
+      IntegerArray const& strides,
+      Image& out
+) {
+   ICS* ics = icsFile;
+   dip::uint sizeOf = data.fileInformation.dataType.SizeOf();
+   if(( ics->compression != IcsCompr_uncompressed ) || !HasNativeByteOrder( ics ) || ( ics->srcOffset % sizeOf != 0 )) {
+      return false;
+   }
+   dip::uint fileSize;
+   DataSegment dataSegment = MapFileCopyOnWrite( GetICSDataFileName( ics ), fileSize );
+   if( !dataSegment || ( fileSize < ics->srcOffset + sizeOf * data.fileSizes.product() )) {
+      return false;
+   }
+   // find the pointer to the first pixel of the ROI and the strides within the ROI
+   dip::sint offset = static_cast< dip::sint >( ics->srcOffset / sizeOf );
+   dip::uint nDims = roiSpec.sizes.size();
+   IntegerArray outStrides( nDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      offset += static_cast< dip::sint >( roiSpec.roi[ ii ].Offset() ) * strides[ ii ];
+      outStrides[ ii ] = static_cast< dip::sint >( roiSpec.roi[ ii ].step ) * strides[ ii ];
+   }
+   dip::sint tensorStride = 1;
+   if( data.fileInformation.tensorElements > 1 ) {
+      offset += static_cast< dip::sint >( roiSpec.channels.Offset() ) * strides.back();
+      tensorStride = static_cast< dip::sint >( roiSpec.channels.step ) * strides.back();
+   }
+   void* origin = static_cast< uint8* >( dataSegment.get() ) + offset * static_cast< dip::sint >( sizeOf );
+   out = Image( dataSegment, origin, data.fileInformation.dataType, roiSpec.sizes, outStrides,
+                Tensor( roiSpec.tensorElements ), tensorStride );
+   return true;
+}
+
 } // namespace
 
 FileInformation ImageReadICS(
@@ -430,8 +516,15 @@ FileInformation ImageReadICS(
       Range const& channels,
       String const& mode
 ) {
-   bool fast;
-   DIP_STACK_TRACE_THIS( fast = BooleanFromString( mode, "fast", "" ));
+   bool fast = false;
+   bool mapped = false;
+   if( mode == "fast" ) {
+      fast = true;
+   } else if( mode == "mmap" ) {
+      mapped = true;
+   } else if( !mode.empty() ) {
+      DIP_THROW_INVALID_FLAG( mode );
+   }
 
    // open the ICS file
    IcsFile icsFile( filename, "r" );
@@ -489,8 +582,20 @@ FileInformation ImageReadICS(
       }
    }
 
+   // if "mmap", try to use the data file directly as the image's data segment
+   bool isMapped = false;
+   if( mapped ) {
+      Image tmp;
+      DIP_STACK_TRACE_THIS( isMapped = MapICSData( icsFile, data, roiSpec, strides, tmp ));
+      if( isMapped ) {
+         out = std::move( tmp );
+      }
+   }
+
    // forge the image
-   out.ReForge( roiSpec.sizes, roiSpec.tensorElements, data.fileInformation.dataType );
+   if( !isMapped ) {
+      out.ReForge( roiSpec.sizes, roiSpec.tensorElements, data.fileInformation.dataType );
+   }
    if( roiSpec.tensorElements == data.fileInformation.tensorElements ) {
       out.SetColorSpace( data.fileInformation.colorSpace );
    }
@@ -527,89 +632,91 @@ FileInformation ImageReadICS(
    }
    //std::cout << "[ImageReadICS] out = " << out << std::endl;
 
-   // make a quick copy and place the tensor dimension at the back
-   Image outRef = out.QuickCopy();
-   if( data.fileInformation.tensorElements > 1 ) {
-      outRef.TensorToSpatial();
-      roiSpec.roi.push_back( roiSpec.channels );
-      sizes.push_back( roiSpec.tensorElements );
-      ++nDims;
-   }
-   //std::cout << "[ImageReadICS] outRef = " << outRef << std::endl;
+   if( !isMapped ) {
+      // make a quick copy and place the tensor dimension at the back
+      Image outRef = out.QuickCopy();
+      if( data.fileInformation.tensorElements > 1 ) {
+         outRef.TensorToSpatial();
+         roiSpec.roi.push_back( roiSpec.channels );
+         sizes.push_back( roiSpec.tensorElements );
+         ++nDims;
+      }
+      //std::cout << "[ImageReadICS] outRef = " << outRef << std::endl;
 
-   if( strides == out.Strides() ) {
-      // Fast reading!
-      //std::cout << "[ImageReadICS] fast reading!\n";
+      if( strides == out.Strides() ) {
+         // Fast reading!
+         //std::cout << "[ImageReadICS] fast reading!\n";
 
-      CALL_ICS( IcsGetData( icsFile, outRef.Origin(), outRef.NumberOfPixels() * outRef.DataType().SizeOf() ),
-                "Couldn't read pixel data from ICS file" );
+         CALL_ICS( IcsGetData( icsFile, outRef.Origin(), outRef.NumberOfPixels() * outRef.DataType().SizeOf() ),
+                   "Couldn't read pixel data from ICS file" );
 
-   } else {
-      // Reading using strides
-      //std::cout << "[ImageReadICS] reading with strides\n";
-   
-      // remove any singleton dimensions (in the input file, not the roi)
-      // this should improve reading speed, especially if the first dimension is singleton
-      for( dip::uint ii = nDims; ii > 0; ) { // loop backwards, so we don't skip a dimension when erasing
-         --ii;
-         if( sizes[ ii ] == 1 ) {
-            sizes.erase( ii );
-            roiSpec.roi.erase( ii );
-            order.erase( ii );
-            strides.erase( ii );
-            outRef.Squeeze( ii );
+      } else {
+         // Reading using strides
+         //std::cout << "[ImageReadICS] reading with strides\n";
+
+         // remove any singleton dimensions (in the input file, not the roi)
+         // this should improve reading speed, especially if the first dimension is singleton
+         for( dip::uint ii = nDims; ii > 0; ) { // loop backwards, so we don't skip a dimension when erasing
+            --ii;
+            if( sizes[ ii ] == 1 ) {
+               sizes.erase( ii );
+               roiSpec.roi.erase( ii );
+               order.erase( ii );
+               strides.erase( ii );
+               outRef.Squeeze( ii );
+            }
          }
-      }
-      nDims = outRef.Dimensionality();
-
-      // re-order dimensions according to strides, so that we only go forward in the file
-      auto sort = strides.sorted_indices();
-      outRef.PermuteDimensions( sort );
-      sizes = sizes.permute( sort );
-      roiSpec.roi = roiSpec.roi.permute( sort );
-      order = order.permute( sort );
-      strides = strides.permute( sort );
-
-      // what is the processing dimension?
-      dip::uint procDim = 0;
-      for( dip::uint ii = 1; ii < order.size(); ++ii ) {
-         if( order[ ii ] < order[ procDim ] ) {
-            procDim = ii;
+         nDims = outRef.Dimensionality();
+
+         // re-order dimensions according to strides, so that we only go forward in the file
+         auto sort = strides.sorted_indices();
+         outRef.PermuteDimensions( sort );
+         sizes = sizes.permute( sort );
+         roiSpec.roi = roiSpec.roi.permute( sort );
+         order = order.permute( sort );
+         strides = strides.permute( sort );
+
+         // what is the processing dimension?
+         dip::uint procDim = 0;
+         for( dip::uint ii = 1; ii < order.size(); ++ii ) {
+            if( order[ ii ] < order[ procDim ] ) {
+               procDim = ii;
+            }
          }
-      }
 
-      // prepare the buffer
-      dip::uint sizeOf = data.fileInformation.dataType.SizeOf();
-      dip::uint bufSize = sizeOf * (( outRef.Size( procDim ) - 1 ) * roiSpec.roi[ procDim ].step + 1 );
-      std::vector< uint8 > buffer( bufSize );
-
-      // read the data
-      dip::uint cur_loc = 0;
-      GenericImageIterator<> it( outRef, procDim );
-      do {
-         // find location in file to read at
-         UnsignedArray const& curipos = it.Coordinates();
-         dip::uint new_loc = sizeOf * roiSpec.roi[ procDim ].Offset();
-         for( dip::uint ii = 0; ii < nDims; ++ii ) {
-            if( ii != procDim ) {
-               dip::uint curfpos = curipos[ ii ] * roiSpec.roi[ ii ].step + roiSpec.roi[ ii ].Offset();
-               new_loc += sizeOf * curfpos * static_cast< dip::uint >( strides[ ii ] );
+         // prepare the buffer
+         dip::uint sizeOf = data.fileInformation.dataType.SizeOf();
+         dip::uint bufSize = sizeOf * (( outRef.Size( procDim ) - 1 ) * roiSpec.roi[ procDim ].step + 1 );
+         std::vector< uint8 > buffer( bufSize );
+
+         // read the data
+         dip::uint cur_loc = 0;
+         GenericImageIterator<> it( outRef, procDim );
+         do {
+            // find location in file to read at
+            UnsignedArray const& curipos = it.Coordinates();
+            dip::uint new_loc = sizeOf * roiSpec.roi[ procDim ].Offset();
+            for( dip::uint ii = 0; ii < nDims; ++ii ) {
+               if( ii != procDim ) {
+                  dip::uint curfpos = curipos[ ii ] * roiSpec.roi[ ii ].step + roiSpec.roi[ ii ].Offset();
+                  new_loc += sizeOf * curfpos * static_cast< dip::uint >( strides[ ii ] );
+               }
             }
-         }
-         // read line portion into buffer
-         DIP_ASSERT( new_loc >= cur_loc ); // we cannot move backwards!
-         if( new_loc > cur_loc ) {
-            IcsSkipDataBlock( icsFile, new_loc - cur_loc );
-            cur_loc = new_loc;
-         }
-         CALL_ICS( IcsGetDataBlock( icsFile, buffer.data(), bufSize ), "Couldn't read pixel data from ICS file" );
-         cur_loc += bufSize;
-         // copy buffer to image
-         detail::CopyBuffer( buffer.data(), data.fileInformation.dataType, static_cast< dip::sint >( roiSpec.roi[ procDim ].step ), 1,
-                             it.Pointer(), outRef.DataType(), outRef.Stride( procDim ), 1,
-                             outRef.Size( procDim ), 1 );
-      } while( ++it );
+            // read line portion into buffer
+            DIP_ASSERT( new_loc >= cur_loc ); // we cannot move backwards!
+            if( new_loc > cur_loc ) {
+               IcsSkipDataBlock( icsFile, new_loc - cur_loc );
+               cur_loc = new_loc;
+            }
+            CALL_ICS( IcsGetDataBlock( icsFile, buffer.data(), bufSize ), "Couldn't read pixel data from ICS file" );
+            cur_loc += bufSize;
+            // copy buffer to image
+            detail::CopyBuffer( buffer.data(), data.fileInformation.dataType, static_cast< dip::sint >( roiSpec.roi[ procDim ].step ), 1,
+                                it.Pointer(), outRef.DataType(), outRef.Stride( procDim ), 1,
+                                outRef.Size( procDim ), 1 );
+         } while( ++it );
 
+      }
    }
 
    // apply the mirroring to the output image
@@ -662,8 +769,300 @@ inline bool StridesArePositive( IntegerArray strides ) {
    return true;
 }
 
+// Returns the ICS data type for `dataType`, and adjusts `significantBits` to be within the range for the type
+// (0 means the full range).
+Ics_DataType DataTypeToICS( DataType dataType, dip::uint& significantBits ) {
+   Ics_DataType dt;
+   dip::uint maxSignificantBits;
+   switch( dataType ) {
+      case DT_BIN:      dt = Ics_uint8;     maxSignificantBits = 1;  break;
+      case DT_UINT8:    dt = Ics_uint8;     maxSignificantBits = 8;  break;
+      case DT_UINT16:   dt = Ics_uint16;    maxSignificantBits = 16; break;
+      case DT_UINT32:   dt = Ics_uint32;    maxSignificantBits = 32; break;
+      case DT_UINT64:   dt = Ics_uint64;    maxSignificantBits = 64; break;
+      case DT_SINT8:    dt = Ics_sint8;     maxSignificantBits = 8;  break;
+      case DT_SINT16:   dt = Ics_sint16;    maxSignificantBits = 16; break;
+      case DT_SINT32:   dt = Ics_sint32;    maxSignificantBits = 32; break;
+      case DT_SINT64:   dt = Ics_sint64;    maxSignificantBits = 64; break;
+      case DT_SFLOAT:   dt = Ics_real32;    maxSignificantBits = 32; break;
+      case DT_DFLOAT:   dt = Ics_real64;    maxSignificantBits = 64; break;
+      case DT_SCOMPLEX: dt = Ics_complex32; maxSignificantBits = 32; break;
+      case DT_DCOMPLEX: dt = Ics_complex64; maxSignificantBits = 64; break;
+      default:
+         DIP_THROW( E::DATA_TYPE_NOT_SUPPORTED ); // Should not happen
+   }
+   if( significantBits == 0 ) {
+      significantBits = maxSignificantBits;
+   } else {
+      significantBits = std::min( significantBits, maxSignificantBits );
+   }
+   return dt;
+}
+
+// Writes the layout and related metadata to the ICS header. `sizes` includes the tensor dimension at the end
+// if `tensor` is not scalar.
+void WriteICSLayout(
+      IcsFile& icsFile,
+      Ics_DataType dt,
+      UnsignedArray const& sizes,
+      dip::uint significantBits,
+      Tensor const& tensor,
+      String const& colorSpace,
+      PixelSize const& pixelSize
+) {
+   bool isTensor = !tensor.IsScalar();
+   int nDims = static_cast< int >( sizes.size() );
+   CALL_ICS( IcsSetLayout( icsFile, dt, nDims, sizes.data() ), "Couldn't write to ICS file" );
+   if( nDims >= 5 ) {
+      // By default, 5th dimension is called "probe", but this is turned into a tensor dimension...
+      CALL_ICS( IcsSetOrder( icsFile, 4, "dim_4", nullptr ), "Couldn't write to ICS file" );
+   }
+   CALL_ICS( IcsSetSignificantBits( icsFile, significantBits ), "Couldn't write to ICS file" );
+   if( !colorSpace.empty() ) {
+      CALL_ICS( IcsSetOrder( icsFile, nDims - 1, colorSpace.c_str(), nullptr ), "Couldn't write to ICS file" );
+   } else if( isTensor ) {
+      CALL_ICS( IcsSetOrder( icsFile, nDims - 1, "tensor", nullptr ), "Couldn't write to ICS file" );
+   }
+   if( pixelSize.IsDefined() ) {
+      if( isTensor ) { nDims--; }
+      for( int ii = 0; ii < nDims; ii++ ) {
+         auto ps = pixelSize[ static_cast< dip::uint >( ii ) ];
+         CALL_ICS( IcsSetPosition( icsFile, ii, 0.0, ps.magnitude, ps.units.String().c_str() ), "Couldn't write to ICS file" );
+      }
+      if( isTensor ) {
+         CALL_ICS( IcsSetPosition( icsFile, nDims, 0.0, 1.0, nullptr ), "Couldn't write to ICS file" );
+      }
+   }
+   if( isTensor ) {
+      String tensorShape = tensor.TensorShapeAsString() + "\t" +
+                           std::to_string( tensor.Rows() ) + "\t" +
+                           std::to_string( tensor.Columns() );
+      CALL_ICS( IcsAddHistory( icsFile, "tensor", tensorShape.c_str() ), "Couldn't write metadata to ICS file" );
+   }
+}
+
+// Writes the history lines to the ICS header, including our own tag.
+void WriteICSHistory( IcsFile& icsFile, StringArray const& history ) {
+   // tag the data
+   CALL_ICS( IcsAddHistory( icsFile, "software", "DIPlib " DIP_VERSION_STRING ), "Couldn't write metadata to ICS file" );
+
+   // write history lines
+   for( auto const& line : history ) {
+      auto error = IcsAddHistory( icsFile, nullptr, line.c_str() );
+      if(( error == IcsErr_LineOverflow ) || // history line is too long
+         ( error == IcsErr_IllParameter )) { // history line contains illegal characters
+         // Ignore these errors, the history line will not be written.
+      }
+      CALL_ICS( error, "Couldn't write metadata to ICS file" );
+   }
+}
+
 } // namespace
 
+#ifdef DIP__HAS_ZLIB
+
+// Pixel data is compressed in chunks of approximately this size. Each chunk is compressed independently, so that
+// chunks can be compressed in parallel, and so that decompression can start at the beginning of any chunk. The
+// output does not depend on the number of threads used.
+constexpr dip::uint GZIP_CHUNK_SIZE = 4 * 1024 * 1024; // 4 MiB
+// zlib uses 32-bit lengths, we feed it data in pieces of at most this size
+constexpr dip::uint ZLIB_MAX_BLOCK = 1024 * 1024 * 1024; // 1 GiB
+
+struct GzipChunk {
+   std::vector< uint8 > data;    // compressed data
+   dip::uint size = 0;           // uncompressed size in bytes
+   uLong crc = 0;                // CRC-32 of the uncompressed data
+   bool error = false;
+};
+
+void PutLittleEndian( std::ostream& file, dip::uint64 value, dip::uint nBytes ) {
+   for( dip::uint ii = 0; ii < nBytes; ++ii ) {
+      file.put( static_cast< char >( value & 0xFFu ));
+      value >>= 8u;
+   }
+}
+
+// Owns a zlib deflate stream, calls `deflateEnd` when destroyed
+class DeflateStream {
+   public:
+      explicit DeflateStream( int level ) {
+         initialized_ = deflateInit2( &stream_, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) == Z_OK;
+      }
+      DeflateStream( DeflateStream const& ) = delete;
+      DeflateStream& operator=( DeflateStream const& ) = delete;
+      ~DeflateStream() {
+         if( initialized_ ) {
+            deflateEnd( &stream_ );
+         }
+      }
+      bool IsInitialized() const { return initialized_; }
+      z_stream* operator->() { return &stream_; }
+      z_stream* get() { return &stream_; }
+   private:
+      z_stream stream_{};
+      bool initialized_ = false;
+};
+
+// Compresses `size` bytes at `src` as a raw deflate stream. The stream is terminated with a full flush, such that
+// the next chunk can be appended to it, or, if `last`, with the final block. On a zlib error, `chunk.error` is set.
+void DeflateChunk( uint8 const* src, dip::uint size, int level, bool last, GzipChunk& chunk ) {
+   DeflateStream stream( level );
+   if( !stream.IsInitialized() ) {
+      chunk.error = true;
+      return;
+   }
+   chunk.size = size;
+   chunk.crc = crc32( 0L, Z_NULL, 0 );
+   chunk.data.resize( deflateBound( stream.get(), static_cast< uLong >( size )) + 64 );
+   dip::uint used = 0;
+   dip::uint remaining = size;
+   do {
+      uInt nIn = static_cast< uInt >( std::min( remaining, ZLIB_MAX_BLOCK ));
+      chunk.crc = crc32( chunk.crc, src, nIn );
+      stream->next_in = const_cast< Bytef* >( src ); // older versions of zlib don't have `const` in there
+      stream->avail_in = nIn;
+      src += nIn;
+      remaining -= nIn;
+      int flush = remaining > 0 ? Z_NO_FLUSH : ( last ? Z_FINISH : Z_FULL_FLUSH );
+      uInt nOut;
+      do {
+         if( chunk.data.size() - used < 1024 ) {
+            chunk.data.resize( chunk.data.size() + GZIP_CHUNK_SIZE / 4 );
+         }
+         nOut = static_cast< uInt >( std::min( chunk.data.size() - used, ZLIB_MAX_BLOCK ));
+         stream->next_out = chunk.data.data() + used;
+         stream->avail_out = nOut;
+         int err = deflate( stream.get(), flush );
+         if(( err != Z_OK ) && ( err != Z_STREAM_END ) && ( err != Z_BUF_ERROR )) {
+            chunk.error = true;
+            return;
+         }
+         used += nOut - stream->avail_out;
+      } while( stream->avail_out == 0 );
+   } while( remaining > 0 );
+   chunk.data.resize( used );
+}
+
+// Writes the pixel data of `image` to the file `filename` (appending if `append`), as a single gzip member that is readable by libics,
+// but compressed in parallel using independent chunks. Image lines are never split across chunks. The tensor
+// dimension of `image` must have been converted to a spatial dimension. Data are written in the linear order
+// given by the image's dimensions, irrespective of its strides. If `indexFilename` is not empty, a chunk index
+// is written to that file: a little-endian 64-bit count of chunks, followed by, for each chunk, the 64-bit
+// offset into the data file where its compressed data starts and the 64-bit offset into the uncompressed
+// pixel data. Decompression (as a raw deflate stream) can start at any of these locations.
+void WriteICSDataChunkedGzip(
+      Image const& image,
+      String const& filename,
+      bool append,
+      int level,
+      String const& indexFilename
+) {
+   DataType dataType = image.DataType();
+   dip::uint sizeOf = dataType.SizeOf();
+   dip::uint nDims = image.Dimensionality();
+   dip::uint lineLength = image.Size( 0 );
+   dip::sint lineStride = image.Stride( 0 );
+   dip::uint lineBytes = lineLength * sizeOf;
+   dip::uint nLines = image.NumberOfPixels() / lineLength;
+   dip::uint linesPerChunk = std::max< dip::uint >( 1, GZIP_CHUNK_SIZE / lineBytes );
+   dip::uint nChunks = div_ceil( nLines, linesPerChunk );
+   bool contiguous = image.HasNormalStrides(); // chunks are contiguous in memory
+   auto linePointer = [ & ]( dip::uint line ) {
+      dip::sint offset = 0;
+      for( dip::uint ii = 1; ii < nDims; ++ii ) {
+         offset += static_cast< dip::sint >( line % image.Size( ii )) * image.Stride( ii );
+         line /= image.Size( ii );
+      }
+      return static_cast< uint8 const* >( image.Pointer( offset ));
+   };
+
+   std::ofstream file( filename, std::ios::binary | ( append ? std::ios::app : std::ios::trunc ));
+   if( !file ) {
+      DIP_THROW_RUNTIME( "Couldn't open ICS data file for writing" );
+   }
+   file.seekp( 0, std::ios::end );
+   // gzip header: magic, deflate, no flags, no time stamp, no extra flags, unknown OS
+   char const header[ 10 ] = { '\x1F', '\x8B', 8, 0, 0, 0, 0, 0, 0, '\xFF' };
+   file.write( header, 10 );
+   dip::uint64 compressedOffset = static_cast< dip::uint64 >( file.tellp() );
+   std::vector< dip::uint64 > index;
+   index.reserve( 2 * nChunks );
+   uLong crc = crc32( 0L, Z_NULL, 0 );
+
+   // we compress `batchSize` chunks in parallel, then write them to file in order
+   dip::uint nThreads = std::min( GetNumberOfThreads(), nChunks );
+   dip::uint batchSize = 2 * nThreads;
+   std::vector< GzipChunk > chunks( batchSize );
+   std::exception_ptr exception;
+   for( dip::uint first = 0; first < nChunks; first += batchSize ) {
+      dip::uint n = std::min( batchSize, nChunks - first );
+      #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+      {
+         std::vector< uint8 > buffer;
+         #pragma omp for schedule( dynamic )
+         for( dip::sint jj = 0; jj < static_cast< dip::sint >( n ); ++jj ) {
+            try {
+               dip::uint chunk = first + static_cast< dip::uint >( jj );
+               dip::uint firstLine = chunk * linesPerChunk;
+               dip::uint chunkLines = std::min( linesPerChunk, nLines - firstLine );
+               uint8 const* src;
+               if( contiguous ) {
+                  src = static_cast< uint8 const* >( image.Origin() ) + firstLine * lineBytes;
+               } else {
+                  buffer.resize( linesPerChunk * lineBytes );
+                  for( dip::uint ii = 0; ii < chunkLines; ++ii ) {
+                     detail::CopyBuffer( linePointer( firstLine + ii ), dataType, lineStride, 1,
+                                         buffer.data() + ii * lineBytes, dataType, 1, 1, lineLength, 1 );
+                  }
+                  src = buffer.data();
+               }
+               DeflateChunk( src, chunkLines * lineBytes, level, chunk == nChunks - 1, chunks[ static_cast< dip::uint >( jj ) ] );
+            } catch( ... ) {
+               #pragma omp critical
+               exception = std::current_exception();
+            }
+         }
+      }
+      if( exception ) {
+         std::rethrow_exception( exception );
+      }
+      for( dip::uint jj = 0; jj < n; ++jj ) {
+         GzipChunk& chunk = chunks[ jj ];
+         if( chunk.error ) {
+            DIP_THROW_RUNTIME( "Couldn't compress pixel data" );
+         }
+         index.push_back( compressedOffset );
+         index.push_back( static_cast< dip::uint64 >(( first + jj ) * linesPerChunk * lineBytes ));
+         file.write( reinterpret_cast< char const* >( chunk.data.data() ), static_cast< std::streamsize >( chunk.data.size() ));
+         compressedOffset += chunk.data.size();
+         crc = crc32_combine( crc, chunk.crc, static_cast< z_off_t >( chunk.size ));
+         chunk.data = {};
+      }
+   }
+
+   // gzip trailer: CRC-32 and uncompressed size (modulo 2^32)
+   PutLittleEndian( file, crc, 4 );
+   PutLittleEndian( file, image.NumberOfPixels() * sizeOf, 4 );
+   if( !file ) {
+      DIP_THROW_RUNTIME( "Couldn't write pixel data to ICS file" );
+   }
+   file.close();
+
+   // write the index
+   if( !indexFilename.empty() ) {
+      std::ofstream indexFile( indexFilename, std::ios::binary | std::ios::trunc );
+      PutLittleEndian( indexFile, nChunks, 8 );
+      for( auto v : index ) {
+         PutLittleEndian( indexFile, v, 8 );
+      }
+      if( !indexFile ) {
+         DIP_THROW_RUNTIME( "Couldn't write gzip chunk index file" );
+      }
+   }
+}
+
+#endif // DIP__HAS_ZLIB
+
 void ImageWriteICS(
       Image const& c_image,
       String const& filename,
@@ -675,6 +1074,7 @@ void ImageWriteICS(
    bool oldStyle = false; // true if v1
    bool compress = true;
    bool fast = false;
+   bool index = false;
    for( auto& option : options ) {
       if( option == "v1" ) {
          oldStyle = true;
@@ -686,10 +1086,16 @@ void ImageWriteICS(
          compress = true;
       } else if( option == "fast" ) {
          fast = true;
+      } else if( option == "index" ) {
+         index = true;
       } else {
          DIP_THROW_INVALID_FLAG( option );
       }
    }
+   DIP_THROW_IF( index && !compress, "The \"index\" option requires compressed output" );
+#ifndef DIP__HAS_ZLIB
+   DIP_THROW_IF( index, "The \"index\" option requires DIPlib to be compiled with zlib" );
+#endif
 
    // should we reorder dimensions?
    if( fast ) {
@@ -700,35 +1106,11 @@ void ImageWriteICS(
 
    // find info on image
    Ics_DataType dt;
-   dip::uint maxSignificantBits;
-   switch( c_image.DataType() ) {
-      case DT_BIN:      dt = Ics_uint8;     maxSignificantBits = 1;  break;
-      case DT_UINT8:    dt = Ics_uint8;     maxSignificantBits = 8;  break;
-      case DT_UINT16:   dt = Ics_uint16;    maxSignificantBits = 16; break;
-      case DT_UINT32:   dt = Ics_uint32;    maxSignificantBits = 32; break;
-      case DT_UINT64:   dt = Ics_uint64;    maxSignificantBits = 64; break;
-      case DT_SINT8:    dt = Ics_sint8;     maxSignificantBits = 8;  break;
-      case DT_SINT16:   dt = Ics_sint16;    maxSignificantBits = 16; break;
-      case DT_SINT32:   dt = Ics_sint32;    maxSignificantBits = 32; break;
-      case DT_SINT64:   dt = Ics_sint64;    maxSignificantBits = 64; break;
-      case DT_SFLOAT:   dt = Ics_real32;    maxSignificantBits = 32; break;
-      case DT_DFLOAT:   dt = Ics_real64;    maxSignificantBits = 64; break;
-      case DT_SCOMPLEX: dt = Ics_complex32; maxSignificantBits = 32; break;
-      case DT_DCOMPLEX: dt = Ics_complex64; maxSignificantBits = 64; break;
-      default:
-         DIP_THROW( E::DATA_TYPE_NOT_SUPPORTED ); // Should not happen
-   }
-   if( significantBits == 0 ) {
-      significantBits = maxSignificantBits;
-   } else {
-      significantBits = std::min( significantBits, maxSignificantBits );
-   }
+   DIP_STACK_TRACE_THIS( dt = DataTypeToICS( c_image.DataType(), significantBits ));
 
    // Quick copy of the image, with tensor dimension moved to the end
    Image image = c_image.QuickCopy();
-   bool isTensor = false;
    if( image.TensorElements() > 1 ) {
-      isTensor = true;
       image.TensorToSpatial(); // last dimension
    }
 
@@ -736,34 +1118,9 @@ void ImageWriteICS(
    IcsFile icsFile( filename, oldStyle ? "w1" : "w2" );
 
    // set info on image
-   int nDims = static_cast< int >( image.Dimensionality() );
-   CALL_ICS( IcsSetLayout( icsFile, dt, nDims, image.Sizes().data() ), "Couldn't write to ICS file" );
-   if( nDims >= 5 ) {
-      // By default, 5th dimension is called "probe", but this is turned into a tensor dimension...
-      CALL_ICS( IcsSetOrder( icsFile, 4, "dim_4", nullptr ), "Couldn't write to ICS file" );
-   }
-   CALL_ICS( IcsSetSignificantBits( icsFile, significantBits ), "Couldn't write to ICS file" );
-   if( c_image.IsColor() ) {
-      CALL_ICS( IcsSetOrder( icsFile, nDims - 1, c_image.ColorSpace().c_str(), nullptr ), "Couldn't write to ICS file" );
-   } else if( isTensor ) {
-      CALL_ICS( IcsSetOrder( icsFile, nDims - 1, "tensor", nullptr ), "Couldn't write to ICS file" );
-   }
-   if( c_image.HasPixelSize() ) {
-      if( isTensor ) { nDims--; }
-      for( int ii = 0; ii < nDims; ii++ ) {
-         auto pixelSize = c_image.PixelSize( static_cast< dip::uint >( ii ));
-         CALL_ICS( IcsSetPosition( icsFile, ii, 0.0, pixelSize.magnitude, pixelSize.units.String().c_str() ), "Couldn't write to ICS file" );
-      }
-      if( isTensor ) {
-         CALL_ICS( IcsSetPosition( icsFile, nDims, 0.0, 1.0, nullptr ), "Couldn't write to ICS file" );
-      }
-   }
-   if( isTensor ) {
-      String tensorShape = c_image.Tensor().TensorShapeAsString() + "\t" +
-                           std::to_string( c_image.Tensor().Rows() ) + "\t" +
-                           std::to_string( c_image.Tensor().Columns() );
-      CALL_ICS( IcsAddHistory( icsFile, "tensor", tensorShape.c_str() ), "Couldn't write metadata to ICS file" );
-   }
+   DIP_STACK_TRACE_THIS( WriteICSLayout( icsFile, dt, image.Sizes(), significantBits, c_image.Tensor(),
+                                         c_image.IsColor() ? c_image.ColorSpace() : String{},
+                                         c_image.HasPixelSize() ? c_image.PixelSize() : PixelSize{} ));
 
    // set type of compression
    CALL_ICS( IcsSetCompression( icsFile, compress ? IcsCompr_gzip : IcsCompr_uncompressed, 9 ),
@@ -782,6 +1139,17 @@ void ImageWriteICS(
       }
       std::memcpy( ics->dim, dim, sizeof( Ics_DataRepresentation ) * nd ); // Copy only the dimensions we've set.
    }
+#ifdef DIP__HAS_ZLIB
+   if( compress ) {
+      // libics writes the header, we compress the pixel data ourselves (in parallel)
+      DIP_STACK_TRACE_THIS( WriteICSHistory( icsFile, history ));
+      icsFile.CloseHeaderOnly();
+      String const& dataFileName = icsFile.DataFileName();
+      DIP_STACK_TRACE_THIS( WriteICSDataChunkedGzip( image, dataFileName, !oldStyle, 9,
+                                                     index ? dataFileName + ".idx" : String{} ));
+      return;
+   }
+#endif
    if( image.HasNormalStrides() ) {
       CALL_ICS( IcsSetData( icsFile, image.Origin(), image.NumberOfPixels() * image.DataType().SizeOf() ), "Couldn't write data to ICS file" );
    } else {
@@ -790,63 +1158,238 @@ void ImageWriteICS(
                 "Couldn't write data to ICS file" );
    }
 
-   // tag the data
-   CALL_ICS( IcsAddHistory( icsFile, "software", "DIPlib " DIP_VERSION_STRING ), "Couldn't write metadata to ICS file" );
+   // tag the data and write history lines
+   DIP_STACK_TRACE_THIS( WriteICSHistory( icsFile, history ));
 
-   // write history lines
-   for( auto const& line : history ) {
-      auto error = IcsAddHistory( icsFile, nullptr, line.c_str() );
-      if(( error == IcsErr_LineOverflow ) || // history line is too long
-         ( error == IcsErr_IllParameter )) { // history line contains illegal characters
-         // Ignore these errors, the history line will not be written.
+   // write everything to file by closing it
+   icsFile.Close();
+}
+
+
+void ImageCreateICS(
+      Image const& image,
+      String const& filename,
+      StringArray const& history,
+      dip::uint significantBits
+) {
+   DIP_THROW_IF( image.Dimensionality() < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
+   Ics_DataType dt;
+   DIP_STACK_TRACE_THIS( dt = DataTypeToICS( image.DataType(), significantBits ));
+   UnsignedArray sizes = image.Sizes();
+   if( image.TensorElements() > 1 ) {
+      sizes.push_back( image.TensorElements() ); // tensor dimension at the end
+   }
+   dip::uint nBytes = image.NumberOfPixels() * image.TensorElements() * image.DataType().SizeOf();
+
+   // create the data file, without writing any data to it
+   String headerName = FileCompareExtension( filename, "ics" ) ? filename : filename + ".ics";
+   String dataName = FileAddExtension( headerName, "ids" );
+   {
+      std::ofstream dataFile( dataName, std::ios::binary | std::ios::trunc );
+      if( !dataFile ) {
+         DIP_THROW_RUNTIME( "Couldn't create ICS data file" );
+      }
+      dataFile.seekp( static_cast< std::streamoff >( nBytes - 1 ));
+      dataFile.put( 0 );
+      if( !dataFile ) {
+         DIP_THROW_RUNTIME( "Couldn't create ICS data file" );
       }
-      CALL_ICS( error, "Couldn't write metadata to ICS file" );
    }
 
-   // write everything to file by closing it
+   // write the header, which refers to the data file
+   IcsFile icsFile( headerName, "w2" );
+   DIP_STACK_TRACE_THIS( WriteICSLayout( icsFile, dt, sizes, significantBits, image.Tensor(),
+                                         image.IsColor() ? image.ColorSpace() : String{},
+                                         image.HasPixelSize() ? image.PixelSize() : PixelSize{} ));
+   CALL_ICS( IcsSetSource( icsFile, dataName.c_str(), 0 ), "Couldn't write to ICS file" );
+   CALL_ICS( IcsSetCompression( icsFile, IcsCompr_uncompressed, 0 ), "Couldn't write to ICS file" );
+   DIP_STACK_TRACE_THIS( WriteICSHistory( icsFile, history ));
+   icsFile.Close();
+}
+
+struct ICSTileWriter::Impl {
+   FileInformation fileInformation;
+   UnsignedArray fileSizes;      // sizes in the order they appear in the file, including the tensor dimension
+   UnsignedArray order;          // image dimension ii is file dimension order[ii]
+   UnsignedArray fileStrides;    // strides on file, in bytes, in the order of the file dimensions
+   dip::uint offset;             // offset of the first pixel in the data file, in bytes
+   std::fstream dataFile;
+};
+
+ICSTileWriter::ICSTileWriter( String const& filename ) : impl_( new Impl ) {
+   // open the ICS file and get file information
+   IcsFile icsFile( filename, "r" );
+   GetICSInfoData data;
+   DIP_STACK_TRACE_THIS( data = GetICSInfo( icsFile ));
+   ICS* ics = icsFile;
+   DIP_THROW_IF( ics->compression != IcsCompr_uncompressed, "Tiles can only be written to uncompressed ICS files" );
+   DIP_THROW_IF( !HasNativeByteOrder( ics ), "Tiles can only be written to ICS files with the native byte order" );
+   impl_->fileInformation = std::move( data.fileInformation );
+   impl_->fileSizes = std::move( data.fileSizes );
+   impl_->order = std::move( data.order );
+   impl_->offset = ics->srcOffset;
+   dip::uint nFileDims = impl_->fileSizes.size();
+   impl_->fileStrides.resize( nFileDims );
+   impl_->fileStrides[ 0 ] = impl_->fileInformation.dataType.SizeOf();
+   for( dip::uint ii = 1; ii < nFileDims; ++ii ) {
+      impl_->fileStrides[ ii ] = impl_->fileStrides[ ii - 1 ] * impl_->fileSizes[ ii - 1 ];
+   }
+   impl_->dataFile.open( GetICSDataFileName( ics ), std::ios::in | std::ios::out | std::ios::binary );
+   if( !impl_->dataFile ) {
+      DIP_THROW_RUNTIME( "Couldn't open ICS data file for writing" );
+   }
    icsFile.Close();
 }
 
+ICSTileWriter::~ICSTileWriter() = default;
+
+void ICSTileWriter::Write( Image const& tile, UnsignedArray const& origin ) {
+   DIP_THROW_IF( !tile.IsForged(), E::IMAGE_NOT_FORGED );
+   FileInformation const& info = impl_->fileInformation;
+   dip::uint nDims = info.sizes.size();
+   DIP_THROW_IF( tile.Dimensionality() != nDims, E::DIMENSIONALITIES_DONT_MATCH );
+   DIP_THROW_IF( tile.TensorElements() != info.tensorElements, E::NTENSORELEM_DONT_MATCH );
+   DIP_THROW_IF( origin.size() != nDims, E::ARRAY_PARAMETER_WRONG_LENGTH );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      DIP_THROW_IF( origin[ ii ] + tile.Size( ii ) > info.sizes[ ii ], E::INDEX_OUT_OF_RANGE );
+   }
+
+   // prepare the tile, with the tensor dimension as the last spatial dimension, as `order` expects
+   Image image = tile.QuickCopy();
+   DataType dataType = info.dataType;
+   if( dataType == DT_BIN ) {
+      dataType = DT_UINT8; // They're the same on file, this avoids a copy of binary images
+   }
+   if( image.DataType() != dataType ) {
+      image.Convert( dataType );
+   }
+   UnsignedArray imageOrigin = origin;
+   if( impl_->order.size() > nDims ) {
+      image.TensorToSpatial();
+      imageOrigin.push_back( 0 );
+   }
+   dip::uint nFileDims = imageOrigin.size();
+
+   // reorder the dimensions of the tile to match those on file, and make it contiguous in that order
+   UnsignedArray perm( nFileDims );
+   UnsignedArray fileOrigin( nFileDims );
+   for( dip::uint ii = 0; ii < nFileDims; ++ii ) {
+      perm[ impl_->order[ ii ]] = ii;
+      fileOrigin[ impl_->order[ ii ]] = imageOrigin[ ii ];
+   }
+   image.PermuteDimensions( perm );
+   if( !image.HasNormalStrides() ) {
+      image = image.Copy();
+   }
+
+   // the tile is written in runs that are contiguous on file: the first dimension, plus following dimensions
+   // as long as the tile covers the full image along the previous ones
+   dip::uint runDims = 1;
+   dip::uint runBytes = image.Size( 0 ) * dataType.SizeOf();
+   while(( runDims < nFileDims ) && ( image.Size( runDims - 1 ) == impl_->fileSizes[ runDims - 1 ] )) {
+      runBytes *= image.Size( runDims );
+      ++runDims;
+   }
+   dip::uint nRuns = image.NumberOfPixels() * dataType.SizeOf() / runBytes;
+   char const* src = static_cast< char const* >( image.Origin() );
+   UnsignedArray coords( nFileDims, 0 );
+   std::fstream& dataFile = impl_->dataFile;
+   for( dip::uint run = 0; run < nRuns; ++run ) {
+      dip::uint position = impl_->offset;
+      for( dip::uint ii = 0; ii < nFileDims; ++ii ) {
+         position += ( fileOrigin[ ii ] + coords[ ii ] ) * impl_->fileStrides[ ii ];
+      }
+      dataFile.seekp( static_cast< std::streamoff >( position ));
+      dataFile.write( src, static_cast< std::streamsize >( runBytes ));
+      src += runBytes;
+      for( dip::uint ii = runDims; ii < nFileDims; ++ii ) {
+         if( ++coords[ ii ] < image.Size( ii )) {
+            break;
+         }
+         coords[ ii ] = 0;
+      }
+   }
+   dataFile.flush();
+   if( !dataFile ) {
+      DIP_THROW_RUNTIME( "Couldn't write to ICS data file" );
+   }
+}
+
+void ImageWriteICSTile(
+      Image const& tile,
+      String const& filename,
+      UnsignedArray const& origin
+) {
+   ICSTileWriter writer( filename );
+   writer.Write( tile, origin );
+}
+
 } // namespace dip
 
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
 #include "diplib/testing.h"
+#include "diplib/generation.h"
 
 DOCTEST_TEST_CASE( "[DIPlib] testing ICS file reading and writing" ) {
    dip::Image image = dip::ImageReadICS( DIP__EXAMPLES_DIR "/chromo3d.ics" );
    image.SetPixelSize( dip::PhysicalQuantityArray{ 6 * dip::Units::Micrometer(), 300 * dip::Units::Nanometer() } );
-
-   dip::ImageWriteICS( image, "test1.ics", { "line1", "line2 is good" }, 7, { "v1", "uncompressed" } );
-   dip::Image result = dip::ImageReadICS( "test1", dip::RangeArray{}, {} );
+   dip::testing::TemporaryFiles files;
+   dip::String test1 = files.Name( "test1.ics" );
+   files.Name( "test1.ids" );
+   dip::String test1f = files.Name( "test1f.ics" );
+   files.Name( "test1f.ids" );
+   dip::String test2 = files.Name( "test2.ics" );
+   files.Name( "test2.ids" );
+   dip::String test2f = files.Name( "test2f.ics" );
+   files.Name( "test2f.ids" );
+   dip::String test3 = files.Name( "test3.ics" );
+   dip::String test4 = files.Name( "test4.ics" );
+   files.Name( "test4.ids" );
+   files.Name( "test4.ics.idx" );
+
+   dip::ImageWriteICS( image, test1, { "line1", "line2 is good" }, 7, { "v1", "uncompressed" } );
+   dip::Image result = dip::ImageReadICS( test1, dip::RangeArray{}, {} );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result, dip::Option::CompareImagesMode::FULL ));
 
-   dip::ImageWriteICS( image, "test1f.ics", { "line1", "line2 is good" }, 7, { "v1", "uncompressed", "fast" } );
-   result = dip::ImageReadICS( "test1f", dip::RangeArray{}, {}, "fast" );
+   dip::ImageWriteICS( image, test1f, { "line1", "line2 is good" }, 7, { "v1", "uncompressed", "fast" } );
+   result = dip::ImageReadICS( test1f, dip::RangeArray{}, {}, "fast" );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result, dip::Option::CompareImagesMode::FULL ));
 
-   result = dip::ImageReadICS( "test1f", dip::RangeArray{}, {} );
+   result = dip::ImageReadICS( test1f, dip::RangeArray{}, {} );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result, dip::Option::CompareImagesMode::FULL ));
 
-   result = dip::ImageReadICS( "test1", dip::RangeArray{}, {}, "fast" );
+   result = dip::ImageReadICS( test1, dip::RangeArray{}, {}, "fast" );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result, dip::Option::CompareImagesMode::FULL ));
 
    // Turn it on its side so the image to write has non-standard strides
    image.SwapDimensions( 0, 2 );
 
-   dip::ImageWriteICS( image, "test2.ics", { "key\tvalue" }, 7, { "v1", "uncompressed" } );
-   result = dip::ImageReadICS( "test2", dip::RangeArray{}, {} );
+   dip::ImageWriteICS( image, test2, { "key\tvalue" }, 7, { "v1", "uncompressed" } );
+   result = dip::ImageReadICS( test2, dip::RangeArray{}, {} );
+   DOCTEST_CHECK( dip::testing::CompareImages( image, result, dip::Option::CompareImagesMode::FULL ));
+
+   dip::ImageWriteICS( image, test2f, { "key\tvalue" }, 7, { "v1", "uncompressed", "fast" } );
+   result = dip::ImageReadICS( test2f, dip::RangeArray{}, {}, "fast" );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result, dip::Option::CompareImagesMode::FULL ));
 
-   dip::ImageWriteICS( image, "test2f.ics", { "key\tvalue" }, 7, { "v1", "uncompressed", "fast" } );
-   result = dip::ImageReadICS( "test2f", dip::RangeArray{}, {}, "fast" );
+   result = dip::ImageReadICS( test2f, dip::RangeArray{}, {} );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result, dip::Option::CompareImagesMode::FULL ));
 
-   result = dip::ImageReadICS( "test2f", dip::RangeArray{}, {} );
+   result = dip::ImageReadICS( test2, dip::RangeArray{}, {}, "fast" );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result, dip::Option::CompareImagesMode::FULL ));
 
-   result = dip::ImageReadICS( "test2", dip::RangeArray{}, {}, "fast" );
+   // Memory-mapped reading, also of an ROI
+   result = dip::ImageReadICS( test2, dip::RangeArray{}, {}, "mmap" );
+   DOCTEST_CHECK( result.IsExternalData() );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result, dip::Option::CompareImagesMode::FULL ));
+   dip::RangeArray roi{ dip::Range{ 2, 10, 3 }, dip::Range{ -1, 0 }, dip::Range{ 5, 40 } };
+   result = dip::ImageReadICS( test2f, roi, {}, "mmap" );
+   DOCTEST_CHECK( result.IsExternalData() );
+   DOCTEST_CHECK( dip::testing::CompareImages( image.At( roi ), result ));
+   result.Fill( 0 ); // Modifying the mapped data doesn't modify the file
+   result = dip::ImageReadICS( test2f, roi, {}, "mmap" );
+   DOCTEST_CHECK( dip::testing::CompareImages( image.At( roi ), result ));
 
    // Test writing a 64-bit integer image
    image = dip::Image( { 32, 24 }, 1, dip::DT_SINT64 );
@@ -855,8 +1398,8 @@ DOCTEST_TEST_CASE( "[DIPlib] testing ICS file reading and writing" ) {
    image.At( 1 ) = 9876543210ll;
    image.At( 10 ) = 0;
    DOCTEST_REQUIRE( image.DataType() == dip::DT_SINT64 );
-   dip::ImageWriteICS( image, "test3.ics" );
-   result = dip::ImageReadICS( "test3.ics" );
+   dip::ImageWriteICS( image, test3 );
+   result = dip::ImageReadICS( test3 );
    DOCTEST_CHECK( result.DataType() == dip::DT_SINT64 );
    DOCTEST_CHECK( result.At( 0 ).As< dip::sint64 >() == 0 );
    DOCTEST_CHECK( result.At( 1 ).As< dip::sint64 >() == 9876543210ll );
@@ -864,6 +1407,20 @@ DOCTEST_TEST_CASE( "[DIPlib] testing ICS file reading and writing" ) {
    DOCTEST_CHECK( result.At( 9 ).As< dip::sint64 >() == 1234567890ll );
    DOCTEST_CHECK( result.At( 10 ).As< dip::sint64 >() == 0 );
    DOCTEST_CHECK( result.At( 11 ).As< dip::sint64 >() == 1234567890ll );
+
+   // Test compressed writing of an image that is split into multiple chunks
+   image = dip::CreateRadiusCoordinate( { 1200, 1100 } );
+   DOCTEST_REQUIRE( image.DataType() == dip::DT_SFLOAT );
+   dip::ImageWriteICS( image, test4, {}, 0, { "index" } );
+   result = dip::ImageReadICS( test4 );
+   DOCTEST_CHECK( dip::testing::CompareImages( image, result ));
+   std::ifstream indexFile( test4 + ".idx", std::ios::binary | std::ios::ate );
+   DOCTEST_CHECK( indexFile.tellg() == 8 + 2 * 8 * 2 ); // 1200 * 1100 * 4 bytes = 2 chunks
+   image.SwapDimensions( 0, 1 ); // non-contiguous lines
+   dip::ImageWriteICS( image, test4, {}, 0, { "v1" } );
+   result = dip::ImageReadICS( test4 );
+   DOCTEST_CHECK( dip::testing::CompareImages( image, result ));
+   DOCTEST_CHECK_THROWS( dip::ImageWriteICS( image, test4, {}, 0, { "index", "uncompressed" } ));
 }
 
 #endif // DIP__ENABLE_DOCTEST
@@ -872,6 +1429,7 @@ DOCTEST_TEST_CASE( "[DIPlib] testing ICS file reading and writing" ) {
 
 #include "diplib.h"
 #include "diplib/file_io.h"
+#include "file_io_support.h"
 
 namespace dip {
 
@@ -897,6 +1455,26 @@ void ImageWriteICS( Image const&, String const&, StringArray const&, dip::uint,
    DIP_THROW( NOT_AVAILABLE );
 }
 
+void ImageCreateICS( Image const&, String const&, StringArray const&, dip::uint ) {
+   DIP_THROW( NOT_AVAILABLE );
+}
+
+void ImageWriteICSTile( Image const&, String const&, UnsignedArray const& ) {
+   DIP_THROW( NOT_AVAILABLE );
+}
+
+struct ICSTileWriter::Impl {};
+
+ICSTileWriter::ICSTileWriter( String const& ) {
+   DIP_THROW( NOT_AVAILABLE );
+}
+
+ICSTileWriter::~ICSTileWriter() = default;
+
+void ICSTileWriter::Write( Image const&, UnsignedArray const& ) {
+   DIP_THROW( NOT_AVAILABLE );
+}
+
 }
 
 #endif // DIP__HAS_ICS
@@ -0,0 +1,189 @@
+/*
+ * DIPlib 3.0
+ * This file contains functions for tile-wise processing of ICS files.
+ *
+ * (c)2026, DIPlib contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diplib.h"
+#include "diplib/file_io.h"
+#include "file_io_support.h"
+
+namespace dip {
+
+namespace {
+
+// Calls `function( origin, sizes )` for each tile of size `tileSizes` in an image of size `imageSizes`.
+// Tiles at the end of each dimension can be smaller.
+template< typename F >
+void ForEachTile( UnsignedArray const& imageSizes, UnsignedArray const& tileSizes, F const& function ) {
+   dip::uint nDims = imageSizes.size();
+   UnsignedArray origin( nDims, 0 );
+   UnsignedArray sizes( nDims );
+   while( true ) {
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         sizes[ ii ] = std::min( tileSizes[ ii ], imageSizes[ ii ] - origin[ ii ] );
+      }
+      function( origin, sizes );
+      dip::uint ii = 0;
+      for( ; ii < nDims; ++ii ) {
+         origin[ ii ] += tileSizes[ ii ];
+         if( origin[ ii ] < imageSizes[ ii ] ) {
+            break;
+         }
+         origin[ ii ] = 0;
+      }
+      if( ii == nDims ) {
+         break;
+      }
+   }
+}
+
+UnsignedArray CheckTileSizes( UnsignedArray tileSizes, dip::uint nDims ) {
+   ArrayUseParameter( tileSizes, nDims, dip::uint( 512 ));
+   for( auto s : tileSizes ) {
+      DIP_THROW_IF( s == 0, E::INVALID_PARAMETER );
+   }
+   return tileSizes;
+}
+
+} // namespace
+
+void ImageFilterICSTiles(
+      String const& inFilename,
+      String const& outFilename,
+      TileFilterFunction const& filter,
+      UnsignedArray tileSizes,
+      UnsignedArray halo
+) {
+   FileInformation info;
+   DIP_STACK_TRACE_THIS( info = ImageReadICSInfo( inFilename ));
+   UnsignedArray const& imageSizes = info.sizes;
+   dip::uint nDims = imageSizes.size();
+   DIP_STACK_TRACE_THIS( tileSizes = CheckTileSizes( tileSizes, nDims ));
+   DIP_STACK_TRACE_THIS( ArrayUseParameter( halo, nDims, dip::uint( 0 )));
+
+   std::unique_ptr< ICSTileWriter > writer; // created together with the output file, keeps it open
+   UnsignedArray readOrigin( nDims );
+   UnsignedArray readSizes( nDims );
+   RangeArray crop( nDims );
+   DIP_START_STACK_TRACE
+      ForEachTile( imageSizes, tileSizes, [ & ]( UnsignedArray const& origin, UnsignedArray const& sizes ) {
+         // The region to read: the tile plus the halo, clipped to the image domain
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            readOrigin[ ii ] = origin[ ii ] > halo[ ii ] ? origin[ ii ] - halo[ ii ] : 0;
+            readSizes[ ii ] = std::min( origin[ ii ] + sizes[ ii ] + halo[ ii ], imageSizes[ ii ] ) - readOrigin[ ii ];
+            dip::sint start = static_cast< dip::sint >( origin[ ii ] - readOrigin[ ii ] );
+            crop[ ii ] = Range{ start, start + static_cast< dip::sint >( sizes[ ii ] ) - 1 };
+         }
+         Image in;
+         ImageReadICS( in, inFilename, readOrigin, readSizes );
+         in.Protect(); // Make sure `filter` doesn't write to our input
+         Image out;
+         filter( in, out );
+         DIP_THROW_IF( !out.IsForged(), E::IMAGE_NOT_FORGED );
+         DIP_THROW_IF( out.Sizes() != in.Sizes(), E::SIZES_DONT_MATCH );
+         out = out.At( crop );
+         if( !writer ) {
+            Image properties;
+            properties.SetSizes( imageSizes );
+            properties.SetTensorSizes( out.TensorElements() );
+            properties.ReshapeTensor( out.Tensor() );
+            properties.SetDataType( out.DataType() );
+            properties.SetPixelSize( info.pixelSize );
+            properties.SetColorSpace( out.ColorSpace() );
+            ImageCreateICS( properties, outFilename );
+            writer = std::make_unique< ICSTileWriter >( outFilename );
+         }
+         writer->Write( out, origin );
+      } );
+   DIP_END_STACK_TRACE
+}
+
+void ImageForEachICSTile(
+      String const& filename,
+      TileFunction const& function,
+      UnsignedArray tileSizes
+) {
+   FileInformation info;
+   DIP_STACK_TRACE_THIS( info = ImageReadICSInfo( filename ));
+   DIP_STACK_TRACE_THIS( tileSizes = CheckTileSizes( tileSizes, info.sizes.size() ));
+   DIP_START_STACK_TRACE
+      ForEachTile( info.sizes, tileSizes, [ & ]( UnsignedArray const& origin, UnsignedArray const& sizes ) {
+         Image tile;
+         ImageReadICS( tile, filename, origin, sizes );
+         function( tile, origin );
+      } );
+   DIP_END_STACK_TRACE
+}
+
+} // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#ifdef DIP__HAS_ICS
+#include "doctest.h"
+#include "diplib/linear.h"
+#include "diplib/statistics.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE( "[DIPlib] testing tile-wise processing of ICS files" ) {
+   dip::Image image = dip::ImageReadICS( DIP__EXAMPLES_DIR "/chromo3d.ics" );
+   dip::testing::TemporaryFiles files;
+   dip::String inName = files.Name( "tiles_in.ics" );
+   files.Name( "tiles_in.ids" );
+   dip::String outName = files.Name( "tiles_out.ics" );
+   files.Name( "tiles_out.ids" );
+   dip::ImageWriteICS( image, inName, {}, 0, { "uncompressed" } );
+   auto filter = []( dip::Image const& in, dip::Image& out ) {
+      dip::Gauss( in, out, { 2 }, { 0 }, "FIR" );
+   };
+   dip::ImageFilterICSTiles( inName, outName, filter, { 64, 50, 7 }, { 7 } );
+   dip::Image result = dip::ImageReadICS( outName );
+   dip::Image expected;
+   filter( image, expected );
+   DOCTEST_CHECK( dip::testing::CompareImages( result, expected, 1e-4 ));
+
+   // Tiles that span the full image width are written in larger runs
+   dip::ImageFilterICSTiles( inName, outName, filter, { 1000, 20, 7 }, { 7 } );
+   result = dip::ImageReadICS( outName );
+   DOCTEST_CHECK( dip::testing::CompareImages( result, expected, 1e-4 ));
+
+   // Tiles written to a file where the tensor dimension comes first
+   dip::Image color( { 40, 30 }, 3, dip::DT_UINT8 ); // tensor stride is 1
+   color.Fill( 0 );
+   dip::String colorName = files.Name( "tiles_color.ics" );
+   files.Name( "tiles_color.ids" );
+   dip::ImageWriteICS( color, colorName, {}, 0, { "v1", "uncompressed", "fast" } );
+   dip::Image tile( { 10, 5 }, 3, dip::DT_UINT8 );
+   tile = { 1, 2, 3 };
+   dip::ImageWriteICSTile( tile, colorName, { 20, 10 } );
+   color.At( dip::Range{ 20, 29 }, dip::Range{ 10, 14 } ).Copy( tile );
+   result = dip::ImageReadICS( colorName );
+   DOCTEST_CHECK( dip::testing::CompareImages( result, color ));
+
+   // Compute the sum over tiles
+   dip::dfloat sum = 0;
+   dip::uint count = 0;
+   dip::ImageForEachICSTile( inName, [ & ]( dip::Image const& tile, dip::UnsignedArray const& ) {
+      sum += dip::Sum( tile ).As< dip::dfloat >();
+      count += tile.NumberOfPixels();
+   }, { 100 } );
+   DOCTEST_CHECK( count == image.NumberOfPixels() );
+   DOCTEST_CHECK( sum == dip::Sum( image ).As< dip::dfloat >() );
+}
+
+#endif // DIP__HAS_ICS
+#endif // DIP__ENABLE_DOCTEST
@@ -22,6 +22,8 @@
 
 #include "diplib.h"
 #include "diplib/file_io.h"
+#include "diplib/multithreading.h"
+#include "file_io_support.h"
 
 #include "jpeglib.h"
 #include <setjmp.h>
@@ -37,6 +39,9 @@ struct my_error_mgr {
 };
 using my_error_ptr = struct my_error_mgr*;
 
+// Note that every function that calls into libjpeg must first call `setjmp` on the `setjmp_buffer` of its
+// `JpegInput` or `JpegOutput` object, the jump target must not be in a function that has returned. Also, the
+// `longjmp` skips destructors, so objects with non-trivial destructors must be created before calling `setjmp`.
 void my_error_exit( j_common_ptr cinfo ) {
    // cinfo->err really points to a my_error_mgr struct, so coerce pointer
    my_error_ptr myerr = reinterpret_cast<my_error_ptr>(cinfo->err);
@@ -67,7 +72,11 @@ class JpegInput {
          jerr_.pub.error_exit = my_error_exit;
          jerr_.pub.output_message = my_output_message;
          if( setjmp( jerr_.setjmp_buffer )) {
-            // If we get here, the JPEG code has signaled an error.
+            // If we get here, the JPEG code has signaled an error. The destructor won't be called, clean up here.
+            if( initialized_ ) {
+               jpeg_destroy_decompress( &cinfo_ );
+            }
+            std::fclose( infile_ );
             DIP_THROW_RUNTIME( "Error reading JPEG file." );
          }
          jpeg_create_decompress( &cinfo_ );
@@ -90,6 +99,8 @@ class JpegInput {
       // Retrieve jpeg_decompress_struct
       jpeg_decompress_struct& cinfo() { return cinfo_; }
       j_decompress_ptr cinfoptr() { return &cinfo_; }
+      // Retrieve the jump buffer for error handling
+      jmp_buf& ErrorJumpBuffer() { return jerr_.setjmp_buffer; }
       // Retrieve file name
       String const& FileName() const { return filename_; }
    private:
@@ -138,6 +149,8 @@ class JpegOutput {
       // Retrieve jpeg_decompress_struct
       jpeg_compress_struct& cinfo() { return cinfo_; }
       j_compress_ptr cinfoptr() { return &cinfo_; }
+      // Retrieve the jump buffer for error handling
+      jmp_buf& ErrorJumpBuffer() { return jerr_.setjmp_buffer; }
    private:
       FILE* outfile_ = nullptr;
       jpeg_compress_struct cinfo_;
@@ -171,11 +184,124 @@ FileInformation GetJPEGInfo( JpegInput& jpeg ) {
    return fileInformation;
 }
 
+// Sets up the decompressor to produce an image reduced by a factor `scale`, returns the sizes of that image
+UnsignedArray PrepareJPEGDecompress( JpegInput& jpeg, dip::uint scale ) {
+   DIP_THROW_IF(( scale != 1 ) && ( scale != 2 ) && ( scale != 4 ) && ( scale != 8 ), E::INVALID_PARAMETER );
+   if( setjmp( jpeg.ErrorJumpBuffer() )) {
+      // If we get here, the JPEG code has signaled an error.
+      DIP_THROW_RUNTIME( "Error reading JPEG file." );
+   }
+   jpeg.cinfo().out_color_space = jpeg.cinfo().num_components > 1 ? JCS_RGB : JCS_GRAYSCALE;
+   jpeg.cinfo().scale_num = 1;
+   jpeg.cinfo().scale_denom = static_cast< unsigned int >( scale );
+   jpeg_calc_output_dimensions( jpeg.cinfoptr() );
+   return { jpeg.cinfo().output_width, jpeg.cinfo().output_height };
+}
+
+// Decodes the scanlines selected by `roiSpec` into `out`. Called by `ReadJPEGData` after `setjmp`: libjpeg can
+// `longjmp` out of this function, so it must not create objects with non-trivial destructors.
+void DecodeJPEGScanlines( JpegInput& jpeg, Image& out, RoiSpec const& roiSpec, JSAMPLE* buffer ) {
+   dip::uint nchan = static_cast< dip::uint >( jpeg.cinfo().output_components );
+   dip::uint8* imagedata = static_cast< dip::uint8* >( out.Origin() );
+   dip::sint xStride = out.Stride( 0 );
+   dip::sint yStride = out.Stride( 1 );
+   dip::sint tStride = out.TensorStride();
+   jpeg_start_decompress( jpeg.cinfoptr() );
+   Range const& xRange = roiSpec.roi[ 0 ];
+   Range const& yRange = roiSpec.roi[ 1 ];
+   dip::sint xStep = static_cast< dip::sint >( xRange.step * nchan );
+   for( dip::uint ii = 0; ii <= yRange.Last(); ++ii ) {
+      JSAMPLE* indata = buffer;
+      jpeg_read_scanlines( jpeg.cinfoptr(), &indata, 1 );
+      if(( ii < yRange.Offset() ) || (( ii - yRange.Offset() ) % yRange.step != 0 )) {
+         continue;
+      }
+      indata += xRange.Offset() * nchan;
+      dip::uint8* outdata = imagedata;
+      if( nchan > 1 ) {
+         for( dip::uint jj = 0; jj < roiSpec.sizes[ 0 ]; ++jj ) {
+            for( dip::uint kk = 0; kk < nchan; ++kk ) {
+               *( outdata + static_cast< dip::sint >( kk ) * tStride ) = indata[ kk ];
+            }
+            indata += xStep;
+            outdata += xStride;
+         }
+      } else {
+         for( dip::uint jj = 0; jj < roiSpec.sizes[ 0 ]; ++jj ) {
+            *outdata = *indata;
+            indata += xStep;
+            outdata += xStride;
+         }
+      }
+      imagedata += yStride;
+   }
+   if( jpeg.cinfo().output_scanline < jpeg.cinfo().output_height ) {
+      jpeg_abort_decompress( jpeg.cinfoptr() ); // We don't need the remaining scanlines
+   } else {
+      jpeg_finish_decompress( jpeg.cinfoptr() );
+   }
+}
+
+// Decodes the scanlines selected by `roiSpec` into `out`, which must be forged with the sizes in `roiSpec`.
+// Scanlines above the ROI must still be decoded, but decoding stops after the last scanline in the ROI.
+// `PrepareJPEGDecompress` must have been called first.
+void ReadJPEGData( JpegInput& jpeg, Image& out, RoiSpec const& roiSpec ) {
+   dip::uint nchan = static_cast< dip::uint >( jpeg.cinfo().output_components ); // computed by jpeg_calc_output_dimensions()
+   std::vector< JSAMPLE > buffer( jpeg.cinfo().output_width * static_cast< unsigned >( nchan )); // casting to unsigned rather than dip::uint to shut up GCC warning.
+   // No local variables are modified after `setjmp`, their values would be indeterminate after a `longjmp`
+   if( setjmp( jpeg.ErrorJumpBuffer() )) {
+      // If we get here, the JPEG code has signaled an error.
+      DIP_THROW_RUNTIME( "Error reading JPEG file." );
+   }
+   DecodeJPEGScanlines( jpeg, out, roiSpec, buffer.data() );
+}
+
+// Writes `image` (of type `DT_UINT8`) to the JPEG file. Called by `ImageWriteJPEG` after `setjmp`: libjpeg can
+// `longjmp` out of this function, so it must not create objects with non-trivial destructors.
+void EncodeJPEGScanlines( JpegOutput& jpeg, Image const& image, int quality, JSAMPLE* buffer ) {
+   int nchan = static_cast< int >( image.TensorElements() );
+   dip::uint8 const* imagedata = static_cast< dip::uint8 const* >( image.Origin() );
+   dip::sint xStride = image.Stride( 0 );
+   dip::sint yStride = image.Stride( 1 );
+   dip::sint tStride = image.TensorStride();
+
+   // Set image properties
+   jpeg.cinfo().image_width = static_cast< JDIMENSION >( image.Size( 0 ));
+   jpeg.cinfo().image_height = static_cast< JDIMENSION >( image.Size( 1 ));
+   jpeg.cinfo().input_components = nchan;
+   jpeg.cinfo().in_color_space = nchan > 1 ? JCS_RGB : JCS_GRAYSCALE;
+   jpeg_set_defaults( jpeg.cinfoptr());
+   jpeg_set_quality( jpeg.cinfoptr(), quality, FALSE );
+   jpeg.cinfo().density_unit = 2; // dots per cm
+   jpeg.cinfo().X_density = static_cast< UINT16 >( 0.01 / image.PixelSize( 0 ).RemovePrefix().magnitude ); // let's assume it's meter
+   jpeg.cinfo().Y_density = static_cast< UINT16 >( 0.01 / image.PixelSize( 1 ).RemovePrefix().magnitude );
+
+   // Write data
+   jpeg_start_compress( jpeg.cinfoptr(), TRUE );
+   for( dip::uint ii = 0; ii < image.Size( 1 ); ++ii ) {
+      JSAMPLE* outdata = buffer;
+      dip::uint8 const* indata = imagedata;
+      for( dip::uint jj = 0; jj < image.Size( 0 ); ++jj ) {
+         for( int kk = 0; kk < nchan; ++kk ) {
+            *outdata = *( indata + kk * tStride );
+            ++outdata;
+         }
+         indata += xStride;
+      }
+      outdata = buffer;
+      jpeg_write_scanlines( jpeg.cinfoptr(), &outdata, 1 );
+      imagedata += yStride;
+   }
+   jpeg_finish_compress( jpeg.cinfoptr());
+}
+
 } // namespace
 
 FileInformation ImageReadJPEG(
       Image& out,
-      String const& filename
+      String const& filename,
+      dip::uint scale,
+      RangeArray const& roi
 ) {
    // Open the file
    JpegInput jpeg( filename );
@@ -183,43 +309,87 @@ FileInformation ImageReadJPEG(
    // Get info
    FileInformation info = GetJPEGInfo( jpeg );
 
+   // Check & fix ROI information, which refers to the scaled image
+   FileInformation scaledInfo = info;
+   DIP_STACK_TRACE_THIS( scaledInfo.sizes = PrepareJPEGDecompress( jpeg, scale ));
+   RoiSpec roiSpec;
+   DIP_STACK_TRACE_THIS( roiSpec = CheckAndConvertRoi( roi, {}, scaledInfo, 2 ));
+
    // Allocate image
-   int nchan = jpeg.cinfo().num_components;
-   jpeg.cinfo().out_color_space = nchan > 1 ? JCS_RGB : JCS_GRAYSCALE;
-   out.ReForge( info.sizes, info.tensorElements, DT_UINT8, Option::AcceptDataTypeChange::DONT_ALLOW );
-   out.SetPixelSize( info.pixelSize );
+   out.ReForge( roiSpec.sizes, info.tensorElements, DT_UINT8, Option::AcceptDataTypeChange::DONT_ALLOW );
+   PixelSize pixelSize = info.pixelSize;
+   pixelSize.Scale( static_cast< dfloat >( scale ));
+   out.SetPixelSize( pixelSize );
    out.SetColorSpace( info.colorSpace );
 
    // Read data
-   jpeg_start_decompress( jpeg.cinfoptr() );
-   std::vector< JSAMPLE > buffer( info.sizes[ 0 ] * static_cast< unsigned >( nchan )); // casting to unsigned rather than dip::uint to shut up GCC warning.
-   dip::uint8* imagedata = static_cast< dip::uint8* >( out.Origin() );
-   auto stride = out.Strides();
-   auto tStride = out.TensorStride();
-   for( dip::uint ii = 0; ii < info.sizes[ 1 ]; ++ii ) {
-      JSAMPLE* indata = buffer.data();
-      jpeg_read_scanlines( jpeg.cinfoptr(), &indata, 1 );
-      dip::uint8* outdata = imagedata;
-      if( nchan > 1 ) {
-         for( dip::uint jj = 0; jj < info.sizes[ 0 ]; ++jj ) {
-            for( int kk = 0; kk < nchan; ++kk ) {
-               *( outdata + kk * tStride ) = *indata;
-               ++indata;
+   ReadJPEGData( jpeg, out, roiSpec );
+
+   // Apply the mirroring to the output image
+   out.Mirror( roiSpec.mirror );
+
+   return info;
+}
+
+void ImageReadJPEGSeries(
+      Image& out,
+      StringArray const& filenames,
+      dip::uint scale,
+      RangeArray const& roi
+) {
+   DIP_THROW_IF( filenames.size() < 1, E::ARRAY_PARAMETER_EMPTY );
+
+   // The first image determines the sizes of the output
+   FileInformation info;
+   UnsignedArray scaledSizes;
+   RoiSpec roiSpec;
+   {
+      JpegInput jpeg( filenames[ 0 ] );
+      info = GetJPEGInfo( jpeg );
+      FileInformation scaledInfo = info;
+      DIP_STACK_TRACE_THIS( scaledInfo.sizes = scaledSizes = PrepareJPEGDecompress( jpeg, scale ));
+      DIP_STACK_TRACE_THIS( roiSpec = CheckAndConvertRoi( roi, {}, scaledInfo, 2 ));
+   }
+
+   // Prepare the output image
+   UnsignedArray sizes = roiSpec.sizes;
+   sizes.push_back( filenames.size() );
+   out.ReForge( sizes, info.tensorElements, DT_UINT8, Option::AcceptDataTypeChange::DONT_ALLOW );
+   PixelSize pixelSize = info.pixelSize;
+   pixelSize.Scale( static_cast< dfloat >( scale ));
+   pixelSize.Set( 2, PhysicalQuantity::Pixel() );
+   out.SetPixelSize( pixelSize );
+   out.SetColorSpace( info.colorSpace );
+
+   // Decode the images in parallel, each directly into its slice of the output
+   dip::uint nThreads = std::min( GetNumberOfThreads(), filenames.size() );
+   std::exception_ptr exception;
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      #pragma omp for schedule( dynamic )
+      for( dip::sint ii = 0; ii < static_cast< dip::sint >( filenames.size() ); ++ii ) {
+         try {
+            JpegInput jpeg( filenames[ static_cast< dip::uint >( ii ) ] );
+            if(( static_cast< dip::uint >( jpeg.cinfo().num_components ) != info.tensorElements ) ||
+               ( PrepareJPEGDecompress( jpeg, scale ) != scaledSizes )) {
+               DIP_THROW_RUNTIME( "Images in series do not have consistent sizes" );
             }
-            outdata += stride[ 0 ];
-         }
-      } else {
-         for( dip::uint jj = 0; jj < info.sizes[ 0 ]; ++jj ) {
-            *outdata = *indata;
-            ++indata;
-            outdata += stride[ 0 ];
+            Image slice = out.At( Range{}, Range{}, Range{ ii } );
+            ReadJPEGData( jpeg, slice, roiSpec );
+         } catch( ... ) {
+            #pragma omp critical
+            exception = std::current_exception();
          }
       }
-      imagedata += stride[ 1 ];
    }
-   jpeg_finish_decompress( jpeg.cinfoptr() );
+   if( exception ) {
+      std::rethrow_exception( exception );
+   }
 
-   return info;
+   // Apply the mirroring to the output image
+   BooleanArray mirror = roiSpec.mirror;
+   mirror.push_back( false );
+   out.Mirror( mirror );
 }
 
 FileInformation ImageReadJPEGInfo( String const& filename ) {
@@ -243,52 +413,81 @@ void ImageWriteJPEG(
       dip::uint jpegLevel
 ) {
    DIP_THROW_IF( image.Dimensionality() != 2, E::DIMENSIONALITY_NOT_SUPPORTED );
-   jpegLevel = clamp< dip::uint >( jpegLevel, 1, 100 );
+   int const quality = static_cast< int >( clamp< dip::uint >( jpegLevel, 1, 100 ));
 
    // Open the file
    JpegOutput jpeg( filename );
 
-   // Set image properties
-   int nchan = static_cast< int >( image.TensorElements() );
-   jpeg.cinfo().image_width = static_cast< JDIMENSION >( image.Size( 0 ));
-   jpeg.cinfo().image_height = static_cast< JDIMENSION >( image.Size( 1 ));
-   jpeg.cinfo().input_components = nchan;
-   jpeg.cinfo().in_color_space = nchan > 1 ? JCS_RGB : JCS_GRAYSCALE;
-   jpeg_set_defaults( jpeg.cinfoptr());
-   jpeg_set_quality( jpeg.cinfoptr(), static_cast< int >( jpegLevel ), FALSE );
-   jpeg.cinfo().density_unit = 2; // dots per cm
-   jpeg.cinfo().X_density = static_cast< UINT16 >( 0.01 / image.PixelSize( 0 ).RemovePrefix().magnitude ); // let's assume it's meter
-   jpeg.cinfo().Y_density = static_cast< UINT16 >( 0.01 / image.PixelSize( 1 ).RemovePrefix().magnitude );
-
    // Convert the image to uint8 if necessary
    Image image_u8 = image.QuickCopy();
    image_u8.Convert( DT_UINT8 );
-
-   // Write data
-   jpeg_start_compress( jpeg.cinfoptr(), TRUE );
-   std::vector< JSAMPLE > buffer( image.Size( 0 ) * static_cast< dip::uint >( nchan ));
-   dip::uint8* imagedata = static_cast< dip::uint8* >( image_u8.Origin() );
-   auto stride = image_u8.Strides();
-   auto tStride = image_u8.TensorStride();
-   for( dip::uint ii = 0; ii < image.Size( 1 ); ++ii ) {
-      JSAMPLE* outdata = buffer.data();
-      dip::uint8* indata = imagedata;
-      for( dip::uint jj = 0; jj < image.Size( 0 ); ++jj ) {
-         for( int kk = 0; kk < nchan; ++kk ) {
-            *outdata = *( indata + kk * tStride );
-            ++outdata;
-         }
-         indata += stride[ 0 ];
-      }
-      outdata = buffer.data();
-      jpeg_write_scanlines( jpeg.cinfoptr(), &outdata, 1 );
-      imagedata += stride[ 1 ];
+   std::vector< JSAMPLE > buffer( image.Size( 0 ) * image.TensorElements() );
+   // No local variables are modified after `setjmp`, their values would be indeterminate after a `longjmp`
+   if( setjmp( jpeg.ErrorJumpBuffer() )) {
+      // If we get here, the JPEG code has signaled an error.
+      DIP_THROW_RUNTIME( "Error writing JPEG file." );
    }
-   jpeg_finish_compress( jpeg.cinfoptr());
+   EncodeJPEGScanlines( jpeg, image_u8, quality, buffer.data() );
 }
 
 } // namespace dip
 
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/statistics.h"
+#include "diplib/testing.h"
+#include <fstream>
+
+DOCTEST_TEST_CASE( "[DIPlib] testing JPEG file reading with scaling and ROI" ) {
+   dip::Image image = dip::CreateRadiusCoordinate( { 256, 200 } );
+   image.Convert( dip::DT_UINT8 );
+   dip::testing::TemporaryFiles files;
+   dip::String test1 = files.Name( "test1.jpg" );
+   dip::String test2 = files.Name( "test2.jpg" );
+   dip::String broken = files.Name( "broken.jpg" );
+   dip::ImageWriteJPEG( image, test1, 100 );
+   dip::Image full = dip::ImageReadJPEG( test1 );
+   DOCTEST_REQUIRE( full.Sizes() == image.Sizes() );
+
+   // A ROI yields exactly the same pixels as the full image
+   dip::RangeArray roi{ dip::Range{ 10, 99, 3 }, dip::Range{ 20, 59, 2 }};
+   dip::Image result = dip::ImageReadJPEG( test1, 1, roi );
+   DOCTEST_CHECK( dip::testing::CompareImages( full.At( roi ), result ));
+   roi = { dip::Range{ 99, 10 }, dip::Range{ 20, 59, 2 }};
+   result = dip::ImageReadJPEG( test1, 1, roi );
+   DOCTEST_CHECK( dip::testing::CompareImages( full.At( roi ), result ));
+
+   // A reduced-resolution image has approximately the same mean
+   result = dip::ImageReadJPEG( test1, 4 );
+   DOCTEST_CHECK( result.Size( 0 ) == dip::div_ceil( image.Size( 0 ), dip::uint( 4 )));
+   DOCTEST_CHECK( result.Size( 1 ) == dip::div_ceil( image.Size( 1 ), dip::uint( 4 )));
+   DOCTEST_CHECK( dip::Mean( result ).As< dip::dfloat >() == doctest::Approx( dip::Mean( full ).As< dip::dfloat >() ).epsilon( 0.02 ));
+
+   // A series read in parallel matches individual reads
+   dip::ImageWriteJPEG( image.At( dip::Range{ -1, 0 }, dip::Range{} ), test2, 90 );
+   dip::Image series = dip::ImageReadJPEGSeries( { test1, test2, test1 }, 2, { dip::Range{ 5, 60 }} );
+   DOCTEST_REQUIRE( series.Dimensionality() == 3 );
+   DOCTEST_CHECK( series.Size( 2 ) == 3 );
+   result = dip::ImageReadJPEG( test2, 2, { dip::Range{ 5, 60 }} );
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Image( series.At( dip::Range{}, dip::Range{}, dip::Range{ 1 } )).Squeeze(), result ));
+   result = dip::ImageReadJPEG( test1, 2, { dip::Range{ 5, 60 }} );
+   DOCTEST_CHECK( dip::testing::CompareImages( dip::Image( series.At( dip::Range{}, dip::Range{}, dip::Range{ 2 } )).Squeeze(), result ));
+
+   // A broken file in a series causes an exception, not a crash
+   {
+      std::ifstream in( test1, std::ios::binary );
+      std::vector< char > data( 200 );
+      in.read( data.data(), static_cast< std::streamsize >( data.size() ));
+      std::ofstream out( broken, std::ios::binary | std::ios::trunc );
+      out.write( data.data(), static_cast< std::streamsize >( data.size() ));
+   }
+   DOCTEST_CHECK_THROWS( dip::ImageReadJPEGSeries( { test1, broken, test1, test2 } ));
+   DOCTEST_CHECK_THROWS( dip::ImageReadJPEG( broken ));
+}
+
+#endif // DIP__ENABLE_DOCTEST
+
 #else // DIP__HAS_JPEG
 
 #include "diplib.h"
@@ -298,7 +497,11 @@ namespace dip {
 
 static const char* NOT_AVAILABLE = "DIPlib was compiled without JPEG support.";
 
-FileInformation ImageReadJPEG( Image&, String const& ) {
+FileInformation ImageReadJPEG( Image&, String const&, dip::uint, RangeArray const& ) {
+   DIP_THROW( NOT_AVAILABLE );
+}
+
+void ImageReadJPEGSeries( Image&, StringArray const&, dip::uint, RangeArray const& ) {
    DIP_THROW( NOT_AVAILABLE );
 }
 
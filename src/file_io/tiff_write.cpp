@@ -22,6 +22,7 @@
 
 #include "diplib.h"
 #include "diplib/file_io.h"
+#include "diplib/geometry.h"
 
 #include <tiffio.h>
 
@@ -35,15 +36,16 @@ static const char* TIFF_WRITE_TAG = "Error writing tag to TIFF file";
 
 class TiffFile {
    public:
-      explicit TiffFile( String const& filename ) {
+      explicit TiffFile( String const& filename, bool bigTiff = false ) {
          // Set error and warning handlers, these are library-wide!
          TIFFSetErrorHandler( nullptr );
          TIFFSetWarningHandler( nullptr );
          // Open the file for writing
+         char const* mode = bigTiff ? "w8" : "w";
          if( FileHasExtension( filename )) {
-            tiff_ = TIFFOpen( filename.c_str(), "w" );
+            tiff_ = TIFFOpen( filename.c_str(), mode );
          } else {
-            tiff_ = TIFFOpen( FileAddExtension( filename, "tif" ).c_str(), "w" );
+            tiff_ = TIFFOpen( FileAddExtension( filename, "tif" ).c_str(), mode );
          }
          if( tiff_ == nullptr ) {
             DIP_THROW_RUNTIME( "Could not open the specified file" );
@@ -203,15 +205,39 @@ void FillBufferMultiChannelN(
    }
 }
 
+void FillBuffer(
+      uint8* dest,
+      uint8 const* src,
+      dip::uint width,
+      dip::uint height,
+      Image const& image
+) {
+   dip::uint tensorElements = image.TensorElements();
+   IntegerArray const& strides = image.Strides();
+   dip::uint sizeOf = image.DataType().SizeOf();
+   if( tensorElements == 1 ) {
+      if( image.DataType().IsBinary() ) {
+         FillBuffer1( dest, src, width, height, strides );
+      } else if( sizeOf == 1 ) {
+         FillBuffer8( dest, src, width, height, strides );
+      } else {
+         FillBufferN( dest, src, width, height, strides, sizeOf );
+      }
+   } else {
+      if( sizeOf == 1 ) {
+         FillBufferMultiChannel8( dest, src, tensorElements, width, height, image.TensorStride(), strides );
+      } else {
+         FillBufferMultiChannelN( dest, src, tensorElements, width, height, image.TensorStride(), strides, sizeOf );
+      }
+   }
+}
+
 void WriteTIFFStrips(
       Image const& image,
       TiffFile& tiff
 ) {
-   dip::uint tensorElements = image.TensorElements();
    dip::uint imageWidth = image.Size( 0 );
    uint32 imageLength = static_cast< uint32 >( image.Size( 1 ));
-   dip::sint tensorStride = image.TensorStride();
-   IntegerArray const& strides = image.Strides();
    dip::uint sizeOf = image.DataType().SizeOf();
    bool binary = image.DataType().IsBinary();
 
@@ -222,9 +248,9 @@ void WriteTIFFStrips(
    tmsize_t scanline = TIFFScanlineSize( tiff );
    if( binary ) {
       DIP_ASSERT( static_cast< dip::uint >( scanline ) == div_ceil< dip::uint >( image.Size( 0 ), 8 ));
-      DIP_ASSERT( tensorElements == 1 );
+      DIP_ASSERT( image.TensorElements() == 1 );
    } else {
-      DIP_ASSERT( static_cast< dip::uint >( scanline ) == image.Size( 0 ) * tensorElements * sizeOf );
+      DIP_ASSERT( static_cast< dip::uint >( scanline ) == image.Size( 0 ) * image.TensorElements() * sizeOf );
    }
    if( image.HasNormalStrides() && !binary ) {
       // Simple writing
@@ -245,21 +271,7 @@ void WriteTIFFStrips(
       uint8* data = static_cast< uint8* >( image.Origin() );
       for( uint32 row = 0; row < imageLength; row += rowsPerStrip ) {
          uint32 nrow = row + rowsPerStrip > imageLength ? imageLength - row : rowsPerStrip;
-         if( tensorElements == 1 ) {
-            if( binary) {
-               FillBuffer1( buf.data(), data, imageWidth, nrow, strides );
-            } else if( sizeOf == 1 ) {
-               FillBuffer8( buf.data(), data, imageWidth, nrow, strides );
-            } else {
-               FillBufferN( buf.data(), data, imageWidth, nrow, strides, sizeOf );
-            }
-         } else {
-            if( sizeOf == 1 ) {
-               FillBufferMultiChannel8( buf.data(), data, tensorElements, imageWidth, nrow, tensorStride, strides );
-            } else {
-               FillBufferMultiChannelN( buf.data(), data, tensorElements, imageWidth, nrow, tensorStride, strides, sizeOf );
-            }
-         }
+         FillBuffer( buf.data(), data, imageWidth, nrow, image );
          if( TIFFWriteEncodedStrip( tiff, strip, buf.data(), nrow * scanline ) < 0 ) {
             DIP_THROW_RUNTIME( "Error writing data" );
          }
@@ -269,18 +281,54 @@ void WriteTIFFStrips(
    }
 }
 
-} // namespace
-
-void ImageWriteTIFF(
+void WriteTIFFTiles(
       Image const& image,
-      String const& filename,
-      String const& compression,
-      dip::uint jpegLevel
+      TiffFile& tiff,
+      uint32 tileSize
 ) {
-   DIP_THROW_IF( !image.IsForged(), E::IMAGE_NOT_FORGED );
-   DIP_THROW_IF( image.Dimensionality() != 2, E::DIMENSIONALITY_NOT_SUPPORTED );
-   // TODO: Implement writing of 3D images as a stack of 2D images
+   WRITE_TIFF_TAG( tiff, TIFFTAG_TILEWIDTH, tileSize );
+   WRITE_TIFF_TAG( tiff, TIFFTAG_TILELENGTH, tileSize );
+   uint32 imageWidth = static_cast< uint32 >( image.Size( 0 ));
+   uint32 imageLength = static_cast< uint32 >( image.Size( 1 ));
+   dip::sint sizeOf = static_cast< dip::sint >( image.DataType().SizeOf() );
+   IntegerArray const& strides = image.Strides();
+
+   // Tiles are always written through an intermediate buffer; partial tiles at the right and
+   // bottom edges are padded with zeros
+   dip::uint tileRowSize = static_cast< dip::uint >( TIFFTileRowSize( tiff ));
+   std::vector< uint8 > buf( static_cast< dip::uint >( TIFFTileSize( tiff )));
+   DIP_ASSERT( buf.size() == tileRowSize * tileSize );
+   uint8* data = static_cast< uint8* >( image.Origin() );
+   for( uint32 row = 0; row < imageLength; row += tileSize ) {
+      uint32 nrow = std::min( tileSize, imageLength - row );
+      for( uint32 col = 0; col < imageWidth; col += tileSize ) {
+         uint32 ncol = std::min( tileSize, imageWidth - col );
+         if(( nrow < tileSize ) || ( ncol < tileSize )) {
+            std::fill( buf.begin(), buf.end(), uint8( 0 ));
+         }
+         uint8* src = data + ( static_cast< dip::sint >( col ) * strides[ 0 ] + static_cast< dip::sint >( row ) * strides[ 1 ] ) * sizeOf;
+         for( uint32 ii = 0; ii < nrow; ++ii ) {
+            FillBuffer( buf.data() + ii * tileRowSize, src, ncol, 1, image );
+            src += strides[ 1 ] * sizeOf;
+         }
+         ttile_t tile = TIFFComputeTile( tiff, col, row, 0, 0 );
+         if( TIFFWriteEncodedTile( tiff, tile, buf.data(), static_cast< tmsize_t >( buf.size() )) < 0 ) {
+            DIP_THROW_RUNTIME( "Error writing data" );
+         }
+      }
+   }
+}
 
+// Writes the tags and pixel data for one image file directory. `scale` is the subsampling factor of
+// `image` with respect to the full-resolution image, and is used to set the resolution tags.
+void WriteTIFFDirectory(
+      Image const& image,
+      TiffFile& tiff,
+      uint16 compmode,
+      dip::uint jpegLevel,
+      uint32 tileSize,
+      dip::dfloat scale
+) {
    // Get image info and quit if we can't write
    DIP_THROW_IF(( image.Size( 0 ) > std::numeric_limits< uint32 >::max() ) ||
                 ( image.Size( 1 ) > std::numeric_limits< uint32 >::max() ), "Image size too large for TIFF file" );
@@ -315,10 +363,10 @@ void ImageWriteTIFF(
             break;
       }
    }
-   uint16 compmode = CompressionTranslate( compression );
 
-   // Create the TIFF file and set the tags
-   TiffFile tiff( filename );
+   if( scale != 1.0 ) {
+      WRITE_TIFF_TAG( tiff, TIFFTAG_SUBFILETYPE, uint32( FILETYPE_REDUCEDIMAGE ));
+   }
 
    if( image.DataType().IsBinary() ) {
       WRITE_TIFF_TAG( tiff, TIFFTAG_PHOTOMETRIC, uint16( PHOTOMETRIC_MINISBLACK ));
@@ -353,23 +401,112 @@ void ImageWriteTIFF(
       WRITE_TIFF_TAG( tiff, TIFFTAG_JPEGCOLORMODE, int( JPEGCOLORMODE_RGB ));
    }
 
-   DIP_STACK_TRACE_THIS( WriteTIFFStrips( image, tiff ));
+   if( tileSize > 0 ) {
+      DIP_STACK_TRACE_THIS( WriteTIFFTiles( image, tiff, tileSize ));
+   } else {
+      DIP_STACK_TRACE_THIS( WriteTIFFStrips( image, tiff ));
+   }
 
    TIFFSetField( tiff, TIFFTAG_SOFTWARE, "DIPlib " DIP_VERSION_STRING );
 
    auto ps = image.PixelSize( 0 );
    if( ps.units.HasSameDimensions( Units::Meter() )) {
       ps.RemovePrefix();
-      TIFFSetField( tiff, TIFFTAG_XRESOLUTION, static_cast< float >( 0.01 / ps.magnitude ));
+      TIFFSetField( tiff, TIFFTAG_XRESOLUTION, static_cast< float >( 0.01 / ( ps.magnitude * scale )));
    }
    ps = image.PixelSize( 1 );
    if( ps.units.HasSameDimensions( Units::Meter() )) {
       ps.RemovePrefix();
-      TIFFSetField( tiff, TIFFTAG_YRESOLUTION, static_cast< float >( 0.01 / ps.magnitude ));
+      TIFFSetField( tiff, TIFFTAG_YRESOLUTION, static_cast< float >( 0.01 / ( ps.magnitude * scale )));
    }
    TIFFSetField( tiff, TIFFTAG_RESOLUTIONUNIT, uint16( RESUNIT_CENTIMETER ));
 }
 
+} // namespace
+
+void ImageWriteTIFF(
+      Image const& image,
+      String const& filename,
+      String const& compression,
+      dip::uint jpegLevel,
+      StringSet const& options
+) {
+   DIP_THROW_IF( !image.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( image.Dimensionality() != 2, E::DIMENSIONALITY_NOT_SUPPORTED );
+   // TODO: Implement writing of 3D images as a stack of 2D images
+
+   // Parse options
+   bool bigTiff = false;
+   bool tiled = false;
+   bool pyramid = false;
+   for( auto& option : options ) {
+      if( option == S::BIGTIFF ) {
+         bigTiff = true;
+      } else if( option == S::TILED ) {
+         tiled = true;
+      } else if( option == S::PYRAMID ) {
+         tiled = true;
+         pyramid = true;
+      } else {
+         DIP_THROW_INVALID_FLAG( option );
+      }
+   }
+   DIP_THROW_IF( tiled && image.DataType().IsBinary(), "Tiled TIFF format not supported for binary images" );
+   uint16 compmode = CompressionTranslate( compression );
+   uint32 tileSize = tiled ? 256 : 0;
+
+   // Number of reduced-resolution levels: we halve the image until it fits in a single tile
+   dip::uint nLevels = 0;
+   if( pyramid ) {
+      dip::uint size = std::max( image.Size( 0 ), image.Size( 1 ));
+      while( size > tileSize ) {
+         size /= 2;
+         ++nLevels;
+      }
+      DIP_THROW_IF( nLevels > std::numeric_limits< uint16 >::max(), "Too many pyramid levels for TIFF file" );
+   }
+
+   // Files of 4 GiB or larger need BigTIFF, we leave a safety margin for the headers and for data that
+   // doesn't compress well. The pyramid adds at most 1/3 to the data size.
+   if( !bigTiff ) {
+      dip::uint dataSize = image.NumberOfSamples() * image.DataType().SizeOf();
+      if( pyramid ) {
+         dataSize += dataSize / 3;
+      }
+      bigTiff = dataSize > 0xF0000000u;
+   }
+
+   // Create the TIFF file
+   TiffFile tiff( filename, bigTiff );
+
+   // Write the full-resolution image, with the SubIFD tag pointing to the reduced-resolution levels
+   if( nLevels > 0 ) {
+      std::vector< uint64 > subIFDs( nLevels, 0 ); // The offsets are filled in by libtiff
+      if( !TIFFSetField( tiff, TIFFTAG_SUBIFD, static_cast< uint16 >( nLevels ), subIFDs.data() )) {
+         DIP_THROW_RUNTIME( TIFF_WRITE_TAG );
+      }
+   }
+   DIP_STACK_TRACE_THIS( WriteTIFFDirectory( image, tiff, compmode, jpegLevel, tileSize, 1.0 ));
+
+   // Write the reduced-resolution levels, each computed from the previous one
+   if( nLevels > 0 ) {
+      if( !TIFFWriteDirectory( tiff )) {
+         DIP_THROW_RUNTIME( "Error writing data" );
+      }
+      Image level = image.QuickCopy();
+      dip::dfloat scale = 1.0;
+      for( dip::uint ii = 0; ii < nLevels; ++ii ) {
+         // Sampling at 2x+0.5 with linear interpolation averages 2x2 blocks of pixels
+         DIP_STACK_TRACE_THIS( level = Resampling( level, { 0.5 }, { -0.5 }, S::LINEAR ));
+         scale *= 2.0;
+         DIP_STACK_TRACE_THIS( WriteTIFFDirectory( level, tiff, compmode, jpegLevel, tileSize, scale ));
+         if( !TIFFWriteDirectory( tiff )) {
+            DIP_THROW_RUNTIME( "Error writing data" );
+         }
+      }
+   }
+}
+
 } // namespace dip
 
 #ifdef DIP__ENABLE_DOCTEST
@@ -379,9 +516,12 @@ void ImageWriteTIFF(
 DOCTEST_TEST_CASE( "[DIPlib] testing TIFF file reading and writing" ) {
    dip::Image image = dip::ImageReadTIFF( DIP__EXAMPLES_DIR "/fractal1.tiff" );
    image.SetPixelSize( dip::PhysicalQuantityArray{ 6 * dip::Units::Micrometer(), 300 * dip::Units::Nanometer() } );
+   dip::testing::TemporaryFiles files;
+   dip::String test1 = files.Name( "test1.tif" );
+   dip::String test2 = files.Name( "test2.tif" );
 
-   dip::ImageWriteTIFF( image, "test1.tif" );
-   dip::Image result = dip::ImageReadTIFF( "test1" );
+   dip::ImageWriteTIFF( image, test1 );
+   dip::Image result = dip::ImageReadTIFF( test1 );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result ));
 
    // Try reading it into an image with non-standard strides
@@ -391,14 +531,53 @@ DOCTEST_TEST_CASE( "[DIPlib] testing TIFF file reading and writing" ) {
    strides[ 1 ] = 1;
    result.SetStrides( strides );
    result.Forge();
-   dip::ImageReadTIFF( result, "test1" );
+   dip::ImageReadTIFF( result, test1 );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result ));
 
    // Turn it on its side so the image to write has non-standard strides
    image.SwapDimensions( 0, 1 );
-   dip::ImageWriteTIFF( image, "test2.tif" );
-   result = dip::ImageReadTIFF( "test2" );
+   dip::ImageWriteTIFF( image, test2 );
+   result = dip::ImageReadTIFF( test2 );
+   DOCTEST_CHECK( dip::testing::CompareImages( image, result ));
+}
+
+DOCTEST_TEST_CASE( "[DIPlib] testing BigTIFF and pyramidal TIFF file writing" ) {
+   dip::Image image = dip::ImageReadTIFF( DIP__EXAMPLES_DIR "/fractal1.tiff" ); // 900x718 pixels
+   dip::testing::TemporaryFiles files;
+   dip::String test3 = files.Name( "test3.tif" );
+   dip::String test4 = files.Name( "test4.tif" );
+
+   dip::ImageWriteTIFF( image, test3, "", 80, { dip::S::BIGTIFF } );
+   dip::Image result = dip::ImageReadTIFF( test3 );
    DOCTEST_CHECK( dip::testing::CompareImages( image, result ));
+
+   dip::ImageWriteTIFF( image, test4, "LZW", 80, { dip::S::PYRAMID } );
+   result = dip::ImageReadTIFF( test4 );
+   DOCTEST_CHECK( dip::testing::CompareImages( image, result ));
+
+   // The reduced-resolution levels are stored as SubIFDs
+   TIFF* tiff = TIFFOpen( test4.c_str(), "r" );
+   DOCTEST_REQUIRE( tiff != nullptr );
+   uint16 nSubIFDs = 0;
+   uint64* offsets = nullptr;
+   DOCTEST_REQUIRE( TIFFGetField( tiff, TIFFTAG_SUBIFD, &nSubIFDs, &offsets ));
+   DOCTEST_CHECK( nSubIFDs == 2 ); // 450x359 and 225x179 pixels
+   std::vector< uint64 > subIFDs( offsets, offsets + nSubIFDs );
+   DOCTEST_REQUIRE( TIFFSetSubDirectory( tiff, subIFDs[ 0 ] ));
+   uint32 width = 0;
+   uint32 length = 0;
+   uint32 subFileType = 0;
+   TIFFGetField( tiff, TIFFTAG_IMAGEWIDTH, &width );
+   TIFFGetField( tiff, TIFFTAG_IMAGELENGTH, &length );
+   TIFFGetField( tiff, TIFFTAG_SUBFILETYPE, &subFileType );
+   DOCTEST_CHECK( width == image.Size( 0 ) / 2 );
+   DOCTEST_CHECK( length == image.Size( 1 ) / 2 );
+   DOCTEST_CHECK( subFileType == FILETYPE_REDUCEDIMAGE );
+   DOCTEST_CHECK( TIFFIsTiled( tiff ));
+   TIFFClose( tiff );
+
+   // Tiled binary images are not supported
+   DOCTEST_CHECK_THROWS( dip::ImageWriteTIFF( image > 100, test4, "", 80, { dip::S::TILED } ));
 }
 
 #endif // DIP__ENABLE_DOCTEST
@@ -412,7 +591,7 @@ namespace dip {
 
 static const char* NOT_AVAILABLE = "DIPlib was compiled without TIFF support.";
 
-void ImageWriteTIFF( Image const&, String const&, String const&, dip::uint ) {
+void ImageWriteTIFF( Image const&, String const&, String const&, dip::uint, StringSet const& ) {
    DIP_THROW( NOT_AVAILABLE );
 }
 
@@ -28,6 +28,8 @@
 #include "diplib/overload.h"
 #include "diplib/multithreading.h"
 
+#include <unordered_map>
+
 namespace dip {
 
 using CountType = Histogram::CountType;
@@ -138,8 +140,12 @@ namespace {
 
 class dip__HistogramBase : public Framework::ScanLineFilter {
    public:
-      dip__HistogramBase( Image& image ) : image_( image ) {}
+      dip__HistogramBase( Image& image, bool sparse = false ) : image_( image ), sparse_( sparse ) {}
       virtual void SetNumberOfThreads( dip::uint threads ) override {
+         if( sparse_ ) {
+            sparseArray_.resize( threads - 1 );
+            return;
+         }
          for( dip::uint ii = 1; ii < threads; ++ii ) {
             imageArray_.emplace_back( image_ );       // makes a copy; image_ is not yet forged, so data is not shared.
          }
@@ -150,10 +156,28 @@ class dip__HistogramBase : public Framework::ScanLineFilter {
          for( auto const& img : imageArray_ ) {
             image_ += img;
          }
+         if( !sparseArray_.empty() ) {
+            if( !image_.IsForged() ) {
+               image_.Forge();
+               image_.Fill( 0 );
+            }
+            // `image_` strides are always normal, the keys are offsets into its data segment.
+            CountType* data = static_cast< CountType* >( image_.Origin() );
+            for( auto const& bins : sparseArray_ ) {
+               for( auto const& bin : bins ) {
+                  data[ bin.first ] += bin.second;
+               }
+            }
+         }
       }
    protected:
+      // A sparse partial histogram: maps the offset of each occupied bin to its count.
+      using SparseHistogram = std::unordered_map< dip::uint, CountType >;
+
       Image& image_;
       ImageArray imageArray_;
+      bool sparse_;
+      std::vector< SparseHistogram > sparseArray_;
 };
 
 template< typename TPI >
@@ -222,6 +246,48 @@ class dip__JointImageHistogram : public dip__HistogramBase {
          return ( tensorInput_ ? tensorElements : 2 ) * 6;
       }
       virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         if( params.thread == 0 || !sparse_ ) {
+            Image& image = params.thread == 0 ? image_ : imageArray_[ params.thread - 1 ];
+            if( !image.IsForged() ) {
+               image.Forge();
+               image.Fill( 0 );
+//#if defined(_OPENMP)
+               // For some reason, MATLAB crashes the second time that `mdhistogram` is called,
+               // when using multi-threading. This tiny sleep prevented the crash in the past.
+               // A `std::cout <<` call also prevented the crash. However, MATLAB is crashing again.
+               // Now we are simply never calling this function multi-threaded in DIPimage. Keeping
+               // this hack here in comments for future reference.
+               // Some people say that these crashes are an issue of compatibility between OpenMP
+               // libraries (MATLAB links against Intel's they say).
+               //using namespace std::chrono_literals;
+               //std::this_thread::sleep_for(10ns);
+//#endif
+            }
+            CountType* data = static_cast< CountType* >( image.Origin() );
+            Accumulate( params, [ data ]( dip::uint offset ) { ++data[ offset ]; } );
+         } else {
+            SparseHistogram& bins = sparseArray_[ params.thread - 1 ];
+            Accumulate( params, [ &bins ]( dip::uint offset ) { ++bins[ offset ]; } );
+         }
+      }
+      dip__JointImageHistogram( Image& image, Histogram::ConfigurationArray const& configuration, bool tensorInput, bool sparse ) :
+            dip__HistogramBase( image, sparse ), configuration_( configuration ), tensorInput_( tensorInput ) {
+         // `image_` is not yet forged, but will have normal strides
+         binStrides_.resize( configuration_.size() );
+         dip::uint stride = 1;
+         for( dip::uint ii = 0; ii < configuration_.size(); ++ii ) {
+            binStrides_[ ii ] = stride;
+            stride *= configuration_[ ii ].nBins;
+         }
+      }
+   private:
+      Histogram::ConfigurationArray const& configuration_;
+      bool tensorInput_;
+      UnsignedArray binStrides_;
+
+      // Calls `increment` with the offset of the bin for each input pixel
+      template< typename F >
+      void Accumulate( Framework::ScanLineFilterParameters const& params, F increment ) {
          std::vector< TPI const* > in;
          std::vector< dip::sint > stride;
          dip::uint nDims;
@@ -245,52 +311,15 @@ class dip__JointImageHistogram : public dip__HistogramBase {
             maskBuffer = 2;
          }
          auto bufferLength = params.bufferLength;
-         Image& image = params.thread == 0 ? image_ : imageArray_[ params.thread - 1 ];
-         if( !image.IsForged() ) {
-            image.Forge();
-            image.Fill( 0 );
-//#if defined(_OPENMP)
-            // For some reason, MATLAB crashes the second time that `mdhistogram` is called,
-            // when using multi-threading. This tiny sleep prevented the crash in the past.
-            // A `std::cout <<` call also prevented the crash. However, MATLAB is crashing again.
-            // Now we are simply never calling this function multi-threaded in DIPimage. Keeping
-            // this hack here in comments for future reference.
-            // Some people say that these crashes are an issue of compatibility between OpenMP
-            // libraries (MATLAB links against Intel's they say).
-            //using namespace std::chrono_literals;
-            //std::this_thread::sleep_for(10ns);
-//#endif
-         }
-         CountType* data = static_cast< CountType* >( image.Origin() );
+         bin const* mask = nullptr;
+         dip::sint maskStride = 0;
          if( params.inBuffer.size() > maskBuffer ) {
             // We have a mask image.
-            bin const* mask = static_cast< bin const* >( params.inBuffer[ maskBuffer ].buffer );
-            auto maskStride = params.inBuffer[ maskBuffer ].stride;
-            for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
-               if( *mask ) {
-                  bool include = true;
-                  for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                     if( configuration_[ jj ].IsOutOfRange( static_cast< dfloat >( *( in[ jj ] )))) {
-                        include = false;
-                        break;
-                     }
-                  }
-                  if( include ) {
-                     dip::sint offset = 0;
-                     for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                        offset += image_.Stride( jj ) * configuration_[ jj ].FindBin( static_cast< dfloat >( *( in[ jj ] )));
-                     }
-                     ++data[ offset ];
-                  }
-               }
-               for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                  in[ jj ] += stride[ jj ];
-               }
-               mask += maskStride;
-            }
-         } else {
-            // We don't have a mask image.
-            for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+            mask = static_cast< bin const* >( params.inBuffer[ maskBuffer ].buffer );
+            maskStride = params.inBuffer[ maskBuffer ].stride;
+         }
+         for( dip::uint ii = 0; ii < bufferLength; ++ii ) {
+            if( !mask || *mask ) {
                bool include = true;
                for( dip::uint jj = 0; jj < nDims; ++jj ) {
                   if( configuration_[ jj ].IsOutOfRange( static_cast< dfloat >( *( in[ jj ] )))) {
@@ -299,25 +328,35 @@ class dip__JointImageHistogram : public dip__HistogramBase {
                   }
                }
                if( include ) {
-                  dip::sint offset = 0;
+                  dip::uint offset = 0;
                   for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                     offset += image_.Stride( jj ) * configuration_[ jj ].FindBin( static_cast< dfloat >( *( in[ jj ] )));
+                     offset += binStrides_[ jj ] * static_cast< dip::uint >( configuration_[ jj ].FindBin( static_cast< dfloat >( *( in[ jj ] ))));
                   }
-                  ++data[ offset ];
-               }
-               for( dip::uint jj = 0; jj < nDims; ++jj ) {
-                  in[ jj ] += stride[ jj ];
+                  increment( offset );
                }
             }
+            for( dip::uint jj = 0; jj < nDims; ++jj ) {
+               in[ jj ] += stride[ jj ];
+            }
+            mask += maskStride;
          }
       }
-      dip__JointImageHistogram( Image& image, Histogram::ConfigurationArray const& configuration, bool tensorInput ) :
-            dip__HistogramBase( image ), configuration_( configuration ), tensorInput_( tensorInput ) {}
-   private:
-      Histogram::ConfigurationArray const& configuration_;
-      bool tensorInput_;
 };
 
+// Decides how to compute a joint histogram with `nBins` bins over `nPixels` pixels, with `opsPerPixel` operations
+// per pixel. Each thread but the first needs its own partial histogram, which must be added into the output. If
+// dense partial histograms make this reduction too expensive, we use sparse ones, which cost at most one entry
+// per pixel processed by the thread.
+bool UseSparsePartialHistograms( dip::uint nBins, dip::uint nPixels, dip::uint opsPerPixel ) {
+   dip::uint nThreads = GetNumberOfThreads();
+   if( nThreads <= 1 ) {
+      return false;
+   }
+   dip::uint parallelOperations = nPixels * opsPerPixel;
+   dip::uint sequentialOperations = ( nThreads - 1 ) * ( nBins * 2 + 10000 );
+   return parallelOperations / nThreads + sequentialOperations + threadingThreshold > parallelOperations;
+}
+
 } // namespace
 
 void Histogram::ScalarImageHistogram( Image const& input, Image const& mask, Histogram::Configuration& configuration ) {
@@ -353,17 +392,10 @@ void Histogram::TensorImageHistogram( Image const& input, Image const& mask, His
    }
    data_.SetSizes( sizes );
    data_.SetDataType( DT_COUNT );
+   bool sparse = UseSparsePartialHistograms( data_.NumberOfPixels(), input.NumberOfPixels(), ndims * 6 );
    std::unique_ptr< dip__HistogramBase >scanLineFilter;
-   DIP_OVL_NEW_REAL( scanLineFilter, dip__JointImageHistogram, ( data_, configuration, true ), input.DataType() );
-   Framework::ScanOptions opts;
-   if( GetNumberOfThreads() > 1 ) {
-      dip::uint parallelOperations = input.NumberOfPixels() * ndims * 6;
-      dip::uint sequentialOperations = ( GetNumberOfThreads() - 1 ) * ( data_.NumberOfPixels() * 2 + 10000 );
-      if( parallelOperations / GetNumberOfThreads() + sequentialOperations + threadingThreshold > parallelOperations ) {
-         opts = Framework::ScanOption::NoMultiThreading; // Turn off multithreading if we'll do a lot of work to reduce.
-      }
-   }
-   DIP_STACK_TRACE_THIS( Framework::ScanSingleInput( input, mask, input.DataType(), *scanLineFilter, opts ));
+   DIP_OVL_NEW_REAL( scanLineFilter, dip__JointImageHistogram, ( data_, configuration, true, sparse ), input.DataType() );
+   DIP_STACK_TRACE_THIS( Framework::ScanSingleInput( input, mask, input.DataType(), *scanLineFilter ));
    scanLineFilter->Reduce();
 }
 
@@ -378,8 +410,9 @@ void Histogram::JointImageHistogram( Image const& input1, Image const& input2, I
    data_.SetSizes( sizes );
    data_.SetDataType( DT_COUNT );
    DataType dtype = DataType::SuggestDyadicOperation( input1.DataType(), input2.DataType() );
+   bool sparse = UseSparsePartialHistograms( data_.NumberOfPixels(), input1.NumberOfPixels(), 2 * 6 );
    std::unique_ptr< dip__HistogramBase >scanLineFilter;
-   DIP_OVL_NEW_REAL( scanLineFilter, dip__JointImageHistogram, ( data_, configuration, false ), dtype );
+   DIP_OVL_NEW_REAL( scanLineFilter, dip__JointImageHistogram, ( data_, configuration, false, sparse ), dtype );
    ImageConstRefArray inar{ input1, input2 };
    DataTypeArray inBufT{ dtype, dtype };
    Image mask;
@@ -394,15 +427,7 @@ void Histogram::JointImageHistogram( Image const& input1, Image const& input2, I
       inBufT.push_back( mask.DataType() );
    }
    ImageRefArray outar{};
-   Framework::ScanOptions opts;
-   if( GetNumberOfThreads() > 1 ) {
-      dip::uint parallelOperations = input1.NumberOfPixels() * 2 * 6;
-      dip::uint sequentialOperations = ( GetNumberOfThreads() - 1 ) * ( data_.NumberOfPixels() * 2 + 10000 );
-      if( parallelOperations / GetNumberOfThreads() + sequentialOperations + threadingThreshold > parallelOperations ) {
-         opts = Framework::ScanOption::NoMultiThreading; // Turn off multithreading if we'll do a lot of work to reduce.
-      }
-   }
-   DIP_STACK_TRACE_THIS( Framework::Scan( inar, outar, inBufT, {}, {}, {}, *scanLineFilter, opts ));
+   DIP_STACK_TRACE_THIS( Framework::Scan( inar, outar, inBufT, {}, {}, {}, *scanLineFilter ));
    scanLineFilter->Reduce();
 }
 
@@ -595,6 +620,9 @@ Histogram& Histogram::Smooth( FloatArray sigma ) {
 #ifdef DIP__ENABLE_DOCTEST
 #include "doctest.h"
 #include "diplib/random.h"
+#include "diplib/segmentation.h"
+#include "diplib/multithreading.h"
+#include "diplib/testing.h"
 
 DOCTEST_TEST_CASE( "[DIPlib] testing dip::Histogram" ) {
    dip::Image zero( {}, 1, dip::DT_SFLOAT );
@@ -715,4 +743,55 @@ DOCTEST_TEST_CASE( "[DIPlib] testing dip::Histogram" ) {
    DOCTEST_CHECK( tensorCov[ 5 ] == 0.0 ); // covariance 2nd & 3rd
 }
 
+DOCTEST_TEST_CASE( "[DIPlib] testing sparse multi-dimensional histograms" ) {
+   // Two clusters of colors, the histogram has few occupied bins
+   dip::Image colorIm( { 300, 300 }, 3, dip::DT_UINT8 );
+   {
+      dip::Random random( 0 );
+      dip::GaussianRandomGenerator normDist( random );
+      dip::ImageIterator< dip::uint8 > it( colorIm );
+      do {
+         dip::dfloat center = it.Coordinates()[ 0 ] < 150 ? 66.0 : 194.0;
+         for( dip::uint ii = 0; ii < 3; ++ii ) {
+            it[ ii ] = dip::clamp_cast< dip::uint8 >( normDist( center, 5.0 ));
+         }
+      } while( ++it );
+   }
+   dip::Histogram::Configuration settings( 0.0, 256.0, 64 );
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Histogram colorH1( colorIm, {}, settings );
+   dip::SetNumberOfThreads( 4 );
+   dip::Histogram colorH4( colorIm, {}, settings ); // uses sparse per-thread histograms
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( colorH4.Count() == colorIm.NumberOfPixels() );
+   DOCTEST_CHECK( dip::testing::CompareImages( colorH1.GetImage(), colorH4.GetImage() ));
+
+   // Clustering of the sparse histogram
+   dip::Image labs;
+   dip::Random random( 0 );
+   dip::CoordinateArray centers = dip::KMeansClustering( colorH4.GetImage(), labs, random, 2 );
+   DOCTEST_REQUIRE( centers.size() == 2 );
+   if( centers[ 0 ][ 0 ] > centers[ 1 ][ 0 ] ) {
+      std::swap( centers[ 0 ], centers[ 1 ] );
+   }
+   for( dip::uint ii = 0; ii < 3; ++ii ) {
+      DOCTEST_CHECK( centers[ 0 ][ ii ] >= 15 ); // the mean bin is close to 16, could be rounded down
+      DOCTEST_CHECK( centers[ 0 ][ ii ] <= 16 );
+      DOCTEST_CHECK( centers[ 1 ][ ii ] >= 47 );
+      DOCTEST_CHECK( centers[ 1 ][ ii ] <= 48 );
+   }
+   centers = dip::MinimumVariancePartitioning( colorH4.GetImage(), labs, 2 );
+   DOCTEST_REQUIRE( centers.size() == 2 );
+   if( centers[ 0 ][ 0 ] > centers[ 1 ][ 0 ] ) {
+      std::swap( centers[ 0 ], centers[ 1 ] );
+   }
+   for( dip::uint ii = 0; ii < 3; ++ii ) {
+      DOCTEST_CHECK( centers[ 0 ][ ii ] >= 15 );
+      DOCTEST_CHECK( centers[ 0 ][ ii ] <= 16 );
+      DOCTEST_CHECK( centers[ 1 ][ ii ] >= 47 );
+      DOCTEST_CHECK( centers[ 1 ][ ii ] <= 48 );
+   }
+}
+
 #endif // DIP__ENABLE_DOCTEST
@@ -37,6 +37,9 @@ void SetNumberOfThreads( dip::uint nThreads ) {
 }
 
 dip::uint GetNumberOfThreads() {
+   if( omp_in_parallel() ) {
+      return 1; // We're already running in parallel, don't start more threads
+   }
    return maxNumberOfThreads;
 }
 
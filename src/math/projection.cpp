@@ -25,6 +25,7 @@
 #include "diplib/overload.h"
 #include "diplib/iterators.h"
 #include "diplib/library/copy_buffer.h"
+#include "diplib/multithreading.h"
 
 namespace dip {
 
@@ -148,12 +149,6 @@ void ProjectionScan(
    // Can we treat the images as if they were 1D?
    // TODO: This is an opportunity for improving performance if the non-processing dimensions in in, mask and out have the same layout and simple stride
 
-   // TODO: Determine the number of threads we'll be using. The size of the data has an influence. As is the number of sub-images that we can generate
-   function.SetNumberOfThreads( 1 );
-
-   // TODO: Start threads, each thread makes its own temp image.
-   dip::uint thread = 0;
-
    // Create view over input image, that spans the processing dimensions
    Image tempIn;
    tempIn.CopyProperties( input );
@@ -196,58 +191,89 @@ void ProjectionScan(
    nDims = jj;
    tempOut.SetSizes( outSizes );
    tempOut.dip__SetOrigin( output.Origin() );
-   // Create a temporary output buffer, to collect a single sample in the data type requested by the calling function
-   bool useOutputBuffer = false;
-   Image outBuffer;
-   if( output.DataType() != outImageType ) {
-      // We need a temporary space for the output sample also, because `function.Project` expects `outImageType`.
-      outBuffer.SetDataType( outImageType );
-      outBuffer.Forge(); // By default it's a single sample.
-      useOutputBuffer = true;
+   // We need a temporary space for the output sample if `output` is not of type `outImageType`,
+   // because `function.Project` expects `outImageType`.
+   bool useOutputBuffer = output.DataType() != outImageType;
+
+   // Determine the number of threads we'll be using. Each thread processes a contiguous set of output pixels.
+   dip::uint nOutPixels = outSizes.product();
+   dip::uint nThreads = 1;
+   if( input.NumberOfSamples() >= threadingThreshold ) {
+      nThreads = std::min( GetNumberOfThreads(), nOutPixels );
    }
-
-   // Iterate over the pixels in the output image. For each, we create a view in the input image.
-   UnsignedArray position( nDims, 0 );
-   for( ;; ) {
-
-      // Do the thing
+   function.SetNumberOfThreads( nThreads );
+
+   std::exception_ptr exception;
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   try {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      dip::uint first = nOutPixels * thread / nThreads;
+      dip::uint last = nOutPixels * ( thread + 1 ) / nThreads;
+      // Each thread makes its own views into the images, and moves them to the first output pixel it processes
+      Image threadIn = tempIn;
+      Image threadMask = tempMask;
+      Image threadOut = tempOut;
+      UnsignedArray position( nDims, 0 );
+      dip::uint index = first;
+      for( dip::uint dd = 0; dd < nDims; ++dd ) {
+         position[ dd ] = index % outSizes[ dd ];
+         index /= outSizes[ dd ];
+         dip::sint pos = static_cast< dip::sint >( position[ dd ] );
+         threadIn.dip__ShiftOrigin( inStride[ dd ] * pos );
+         if( hasMask ) {
+            threadMask.dip__ShiftOrigin( maskStride[ dd ] * pos );
+         }
+         threadOut.dip__ShiftOrigin( outStride[ dd ] * pos );
+      }
+      // Create a temporary output buffer, to collect a single sample in the data type requested by the calling function
+      Image outBuffer;
       if( useOutputBuffer ) {
-         function.Project( tempIn, tempMask, outBuffer.Origin(), thread );
-         // Copy data from output buffer to output image
-         detail::CopyBuffer( outBuffer.Origin(), outBuffer.DataType(), 1, 1,
-                             tempOut.Origin(), tempOut.DataType(), 1, 1, 1, 1 );
-      } else {
-         function.Project( tempIn, tempMask, tempOut.Origin(), thread );
+         outBuffer.SetDataType( outImageType );
+         outBuffer.Forge(); // By default it's a single sample.
       }
 
-      // Next output pixel
-      dip::uint dd;
-      for( dd = 0; dd < nDims; dd++ ) {
-         ++position[ dd ];
-         tempIn.dip__ShiftOrigin( inStride[ dd ]);
-         if( hasMask ) {
-            tempMask.dip__ShiftOrigin( maskStride[ dd ]);
-         }
-         tempOut.dip__ShiftOrigin( outStride[ dd ]);
-         // Check whether we reached the last pixel of the line
-         if( position[ dd ] != outSizes[ dd ] ) {
-            break;
+      // Iterate over the pixels in the output image. For each, we create a view in the input image.
+      for( dip::uint ii = first; ii < last; ++ii ) {
+
+         // Do the thing
+         if( useOutputBuffer ) {
+            function.Project( threadIn, threadMask, outBuffer.Origin(), thread );
+            // Copy data from output buffer to output image
+            detail::CopyBuffer( outBuffer.Origin(), outBuffer.DataType(), 1, 1,
+                                threadOut.Origin(), threadOut.DataType(), 1, 1, 1, 1 );
+         } else {
+            function.Project( threadIn, threadMask, threadOut.Origin(), thread );
          }
-         // Rewind along this dimension
-         tempIn.dip__ShiftOrigin( -inStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
-         if( hasMask ) {
-            tempMask.dip__ShiftOrigin( -maskStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+
+         // Next output pixel
+         for( dip::uint dd = 0; dd < nDims; dd++ ) {
+            ++position[ dd ];
+            threadIn.dip__ShiftOrigin( inStride[ dd ] );
+            if( hasMask ) {
+               threadMask.dip__ShiftOrigin( maskStride[ dd ] );
+            }
+            threadOut.dip__ShiftOrigin( outStride[ dd ] );
+            // Check whether we reached the last pixel of the line
+            if( position[ dd ] != outSizes[ dd ] ) {
+               break;
+            }
+            // Rewind along this dimension
+            threadIn.dip__ShiftOrigin( -inStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            if( hasMask ) {
+               threadMask.dip__ShiftOrigin( -maskStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            }
+            threadOut.dip__ShiftOrigin( -outStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
+            position[ dd ] = 0;
+            // Continue loop to increment along next dimension
          }
-         tempOut.dip__ShiftOrigin( -outStride[ dd ] * static_cast< dip::sint >( position[ dd ] ));
-         position[ dd ] = 0;
-         // Continue loop to increment along next dimension
-      }
-      if( dd == nDims ) {
-         break;            // We're done!
       }
+   } catch( ... ) {
+      #pragma omp critical
+      exception = std::current_exception();
+   }
+   if( exception ) {
+      std::rethrow_exception( exception );
    }
-
-   // TODO: End threads.
 }
 
 } // namespace
@@ -984,6 +1010,77 @@ class ProjectionPercentile : public ProjectionScanFunction {
       dfloat percentile_;
 };
 
+// For 8-bit and 16-bit integer types: finds the percentile with a radix select in O(n). The first pass
+// histograms the most significant byte and finds the bin that contains the requested rank. For 16-bit types,
+// a second pass over the input histograms the least significant byte of the samples in that bin. No buffer
+// of samples is needed.
+template< typename TPI >
+class ProjectionPercentileRadix : public ProjectionScanFunction {
+      static_assert( sizeof( TPI ) <= 2, "ProjectionPercentileRadix is meant for 8-bit and 16-bit integer types" );
+      using TPU = typename std::make_unsigned< TPI >::type;
+      // Maps signed values to unsigned keys with the same ordering
+      static constexpr TPU signBit = std::is_signed< TPI >::value ? static_cast< TPU >( 1u << ( 8 * sizeof( TPI ) - 1 )) : TPU( 0 );
+      static TPU Key( TPI v ) { return static_cast< TPU >( static_cast< TPU >( v ) ^ signBit ); }
+      using Histogram = std::array< dip::uint, 256 >;
+      static constexpr dip::uint shift = 8 * ( sizeof( TPI ) - 1 );
+   public:
+      ProjectionPercentileRadix( dfloat percentile ) : percentile_( percentile ) {}
+      virtual void Project( Image const& in, Image const& mask, void* out, dip::uint /*thread*/ ) override {
+         Histogram histogram{};
+         ForEachSample( in, mask, [ & ]( TPI v ) { ++histogram[ Key( v ) >> shift ]; } );
+         dip::uint N = std::accumulate( histogram.begin(), histogram.end(), dip::uint( 0 ));
+         if( N == 0 ) {
+            *static_cast< TPI* >( out ) = TPI{};
+            return;
+         }
+         dip::uint rank = static_cast< dip::uint >( round_cast( static_cast< dfloat >( N - 1 ) * percentile_ / 100.0 ));
+         dip::uint key = FindBin( histogram, rank ) << shift;
+         if( shift > 0 ) {
+            dip::uint high = key >> shift;
+            histogram.fill( 0 );
+            ForEachSample( in, mask, [ & ]( TPI v ) {
+               TPU k = Key( v );
+               if(( k >> shift ) == high ) {
+                  ++histogram[ k & 0xFFu ];
+               }
+            } );
+            key |= FindBin( histogram, rank );
+         }
+         *static_cast< TPI* >( out ) = static_cast< TPI >( static_cast< TPU >( key ^ signBit ));
+      }
+   private:
+      dfloat percentile_;
+
+      // Returns the bin that contains the sample with rank `rank`, and updates `rank` to be the rank within that bin
+      static dip::uint FindBin( Histogram const& histogram, dip::uint& rank ) {
+         dip::uint bin = 0;
+         while( rank >= histogram[ bin ] ) {
+            rank -= histogram[ bin ];
+            ++bin;
+         }
+         return bin;
+      }
+
+      template< typename F >
+      static void ForEachSample( Image const& in, Image const& mask, F function ) {
+         if( mask.IsForged() ) {
+            JointImageIterator< TPI, bin > it( { in, mask } );
+            it.OptimizeAndFlatten();
+            do {
+               if( it.template Sample< 1 >() ) {
+                  function( it.template Sample< 0 >() );
+               }
+            } while( ++it );
+         } else {
+            ImageIterator< TPI > it( in );
+            it.OptimizeAndFlatten();
+            do {
+               function( *it );
+            } while( ++it );
+         }
+      }
+};
+
 } // namespace
 
 void Percentile(
@@ -1000,7 +1097,23 @@ void Percentile(
       Maximum( in, mask, out, process );
    } else {
       std::unique_ptr< ProjectionScanFunction > lineFilter;
-      DIP_OVL_NEW_NONCOMPLEX( lineFilter, ProjectionPercentile, ( percentile ), in.DataType() );
+      switch( in.DataType() ) {
+         case DT_UINT8:
+            lineFilter.reset( new ProjectionPercentileRadix< dip::uint8 >( percentile ));
+            break;
+         case DT_SINT8:
+            lineFilter.reset( new ProjectionPercentileRadix< dip::sint8 >( percentile ));
+            break;
+         case DT_UINT16:
+            lineFilter.reset( new ProjectionPercentileRadix< dip::uint16 >( percentile ));
+            break;
+         case DT_SINT16:
+            lineFilter.reset( new ProjectionPercentileRadix< dip::sint16 >( percentile ));
+            break;
+         default:
+            DIP_OVL_NEW_NONCOMPLEX( lineFilter, ProjectionPercentile, ( percentile ), in.DataType() );
+            break;
+      }
       ProjectionScan( in, mask, out, in.DataType(), process, *lineFilter );
    }
 }
@@ -1013,8 +1126,18 @@ void MedianAbsoluteDeviation(
 ) {
    Image in = c_in;
    Median( in, mask, out, process );
-   Image tmp = Subtract( in, out, DataType::SuggestSigned( out.DataType() ));
+   DataType dt = DataType::SuggestSigned( out.DataType() );
+   Image tmp = Subtract( in, out, dt );
    Abs( tmp, tmp );
+   if( in.DataType().IsInteger() && ( in.DataType().SizeOf() <= 2 )) {
+      // The absolute deviations fit in an unsigned integer of the same size as the input, for which
+      // `Median` doesn't need to copy the data
+      tmp.Convert( in.DataType().SizeOf() == 1 ? DT_UINT8 : DT_UINT16 );
+      Image mad = Median( tmp, mask, process );
+      out.ReForge( mad, dt, Option::AcceptDataTypeChange::DO_ALLOW );
+      out.Copy( mad );
+      return;
+   }
    Median( tmp, mask, out, process ); // Might need to reallocate `out` again, as `tmp` has a different data type than `out`.
 }
 
@@ -1440,4 +1563,73 @@ DOCTEST_TEST_CASE("[DIPlib] testing the projection functions") {
    DOCTEST_CHECK( out.At( 0, 0, 0 ) == dip::Image::Pixel( { 4, 2, 3 } )); // not {4,3,4}
 }
 
+#include "diplib/generation.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the multi-threaded projection") {
+   dip::Image img{ dip::UnsignedArray{ 50, 40, 60 }, 2, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random, 0.0, 100.0 );
+   dip::Image mask = img[ 0 ] > 50;
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::Image max1 = dip::Maximum( img, {}, { false, false, true } );
+   dip::Image mean1 = dip::Mean( img, mask, "", { true, false, true } );
+   dip::Image median1 = dip::Median( img, {}, { false, true, false } );
+   dip::SetNumberOfThreads( 3 );
+   dip::Image max3 = dip::Maximum( img, {}, { false, false, true } );
+   dip::Image mean3 = dip::Mean( img, mask, "", { true, false, true } );
+   dip::Image median3 = dip::Median( img, {}, { false, true, false } );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( dip::testing::CompareImages( max1, max3 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( mean1, mean3 ));
+   DOCTEST_CHECK( dip::testing::CompareImages( median1, median3 ));
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the percentile projection on 8-bit and 16-bit images") {
+   dip::Image img{ dip::UnsignedArray{ 30, 20, 100 }, 1, dip::DT_SFLOAT };
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random, -30000.0, 30000.0 );
+   dip::Image mask = img > 1000;
+   for( dip::DataType dt : { dip::DT_UINT8, dip::DT_SINT8, dip::DT_UINT16, dip::DT_SINT16 } ) {
+      dip::Image in = dip::Convert( dip::Image( img ), dt ); // Values saturate in the 8-bit types
+      dip::Image ref = dip::Convert( in, dip::DT_SFLOAT );
+      for( dip::dfloat percentile : { 5.0, 50.0, 83.0 } ) {
+         dip::Image out = dip::Percentile( in, {}, percentile, { false, false, true } );
+         DOCTEST_CHECK( out.DataType() == dt );
+         DOCTEST_CHECK( dip::testing::CompareImages( out, dip::Percentile( ref, {}, percentile, { false, false, true } ), dip::Option::CompareImagesMode::APPROX ));
+         out = dip::Percentile( in, mask, percentile, { true, false, true } );
+         DOCTEST_CHECK( dip::testing::CompareImages( out, dip::Percentile( ref, mask, percentile, { true, false, true } ), dip::Option::CompareImagesMode::APPROX ));
+      }
+      dip::Image out = dip::MedianAbsoluteDeviation( in, mask, { true, true, false } );
+      DOCTEST_CHECK( out.DataType() == dip::DataType::SuggestSigned( dt ));
+      DOCTEST_CHECK( dip::testing::CompareImages( out, dip::MedianAbsoluteDeviation( ref, mask, { true, true, false } ), dip::Option::CompareImagesMode::APPROX ));
+   }
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the percentile projection on 16-bit images with known values") {
+   // 1001 samples 0, 37, 74, ... 37000 in reverse order along the projected dimension: the 10th percentile
+   // has rank 100, the median has rank 500. Many samples share the most significant byte.
+   dip::Image img( { 2, 1001 }, 1, dip::DT_UINT16 );
+   dip::Image signedImg( { 2, 1001 }, 1, dip::DT_SINT16 );
+   for( dip::uint ii = 0; ii < 1001; ++ii ) {
+      dip::uint value = 37 * ( 1000 - ii );
+      img.At( 0, ii ) = value;
+      img.At( 1, ii ) = value;
+      signedImg.At( 0, ii ) = static_cast< dip::sint >( value ) - 18500;
+      signedImg.At( 1, ii ) = static_cast< dip::sint >( value ) - 18500;
+   }
+   dip::Image out = dip::Percentile( img, {}, 10.0, { false, true } );
+   DOCTEST_CHECK( out.At( 0, 0 ) == 3700 );
+   DOCTEST_CHECK( out.At( 1, 0 ) == 3700 );
+   out = dip::Median( img, {}, { false, true } );
+   DOCTEST_CHECK( out.At( 0, 0 ) == 18500 );
+   out = dip::Percentile( signedImg, {}, 10.0, { false, true } );
+   DOCTEST_CHECK( out.At( 0, 0 ) == -14800 );
+   out = dip::Median( signedImg, {}, { false, true } );
+   DOCTEST_CHECK( out.At( 1, 0 ) == 0 );
+}
+
 #endif // DIP__ENABLE_DOCTEST
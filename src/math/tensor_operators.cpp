@@ -17,6 +17,8 @@
  * limitations under the License.
  */
 
+#include <array>
+
 #include "diplib/math.h"
 #include "diplib/framework.h"
 #include "diplib/overload.h"
@@ -520,6 +522,139 @@ void Rank( Image const& in, Image& out ) {
                                           Framework::ScanOption::ExpandTensorInBuffer ));
 }
 
+namespace {
+
+// Closed-form eigenvalues of symmetric 2x2 and 3x3 matrices. Eigenvalues are sorted by magnitude, largest
+// first, as in `dip::SymmetricEigenDecomposition`.
+
+inline void MagnitudeSort( dfloat& a, dfloat& b ) {
+   dfloat ta = a;
+   dfloat tb = b;
+   bool swap = std::abs( ta ) < std::abs( tb );
+   a = swap ? tb : ta;
+   b = swap ? ta : tb;
+}
+
+inline void SymmetricEigenvalues2(
+      dfloat xx, dfloat yy, dfloat xy,
+      dfloat& lambda0, dfloat& lambda1
+) {
+   dfloat mean = ( xx + yy ) / 2;
+   dfloat half = ( xx - yy ) / 2;
+   dfloat d = std::sqrt( half * half + xy * xy );
+   // `d` is non-negative, so `mean + d` has the larger magnitude if `mean` is non-negative
+   bool positive = mean >= 0;
+   lambda0 = positive ? mean + d : mean - d;
+   lambda1 = positive ? mean - d : mean + d;
+}
+
+// Trigonometric solution, see O.K. Smith, "Eigenvalues of a symmetric 3 × 3 matrix",
+// Communications of the ACM 4(4):168, 1961.
+inline void SymmetricEigenvalues3(
+      dfloat xx, dfloat yy, dfloat zz, dfloat xy, dfloat xz, dfloat yz,
+      dfloat& lambda0, dfloat& lambda1, dfloat& lambda2
+) {
+   dfloat q = ( xx + yy + zz ) / 3;
+   xx -= q;
+   yy -= q;
+   zz -= q;
+   dfloat p = std::sqrt(( xx * xx + yy * yy + zz * zz + 2 * ( xy * xy + xz * xz + yz * yz )) / 6 );
+   // B = ( A - q I ) / p, r = det( B ) / 2
+   dfloat ip = p > 0 ? 1 / p : 0;
+   xx *= ip;
+   yy *= ip;
+   zz *= ip;
+   xy *= ip;
+   xz *= ip;
+   yz *= ip;
+   dfloat r = ( xx * ( yy * zz - yz * yz ) - xy * ( xy * zz - yz * xz ) + xz * ( xy * yz - yy * xz )) / 2;
+   r = clamp( r, -1.0, 1.0 ); // rounding errors can bring `r` out of range
+   dfloat phi = std::acos( r ) / 3;
+   lambda0 = q + 2 * p * std::cos( phi );
+   lambda2 = q + 2 * p * std::cos( phi + ( 2.0 * pi / 3.0 ));
+   lambda1 = 3 * q - lambda0 - lambda2;
+   MagnitudeSort( lambda0, lambda1 );
+   MagnitudeSort( lambda1, lambda2 );
+   MagnitudeSort( lambda0, lambda1 );
+}
+
+enum class EigenvalueSelection { all, largest, smallest };
+
+// Reads the packed `dip::Tensor::Shape::SYMMETRIC_MATRIX` storage directly, so that the input buffer does
+// not need to be expanded to a full matrix. `TPI` is `sfloat` or `dfloat`, computation is always in double
+// precision: the trigonometric solution loses too much precision in single precision for tensors with two
+// nearly equal eigenvalues.
+template< typename TPI >
+class SymmetricEigenvaluesLineFilter : public Framework::ScanLineFilter {
+   public:
+      SymmetricEigenvaluesLineFilter( dip::uint n, EigenvalueSelection selection ) : n_( n ), selection_( selection ) {
+         DIP_ASSERT(( n == 2 ) || ( n == 3 ));
+      }
+      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint ) override {
+         return n_ == 2 ? 30 : 150;
+      }
+      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
+         dip::uint const bufferLength = params.bufferLength;
+         TPI const* in = static_cast< TPI const* >( params.inBuffer[ 0 ].buffer );
+         dip::sint const inStride = params.inBuffer[ 0 ].stride;
+         dip::sint const inTStride = params.inBuffer[ 0 ].tensorStride;
+         TPI* out = static_cast< TPI* >( params.outBuffer[ 0 ].buffer );
+         dip::sint const outStride = params.outBuffer[ 0 ].stride;
+         dip::sint const outTStride = params.outBuffer[ 0 ].tensorStride;
+         bool const all = selection_ == EigenvalueSelection::all;
+         bool const largest = selection_ == EigenvalueSelection::largest;
+         if( n_ == 2 ) {
+            for( dip::uint ii = 0; ii < bufferLength; ++ii, in += inStride, out += outStride ) {
+               dfloat lambda0, lambda1;
+               SymmetricEigenvalues2( in[ 0 ], in[ inTStride ], in[ 2 * inTStride ], lambda0, lambda1 );
+               if( all ) {
+                  out[ 0 ] = static_cast< TPI >( lambda0 );
+                  out[ outTStride ] = static_cast< TPI >( lambda1 );
+               } else {
+                  out[ 0 ] = static_cast< TPI >( largest ? lambda0 : lambda1 );
+               }
+            }
+         } else {
+            for( dip::uint ii = 0; ii < bufferLength; ++ii, in += inStride, out += outStride ) {
+               dfloat lambda0, lambda1, lambda2;
+               SymmetricEigenvalues3( in[ 0 ], in[ inTStride ], in[ 2 * inTStride ],
+                                      in[ 3 * inTStride ], in[ 4 * inTStride ], in[ 5 * inTStride ],
+                                      lambda0, lambda1, lambda2 );
+               if( all ) {
+                  out[ 0 ] = static_cast< TPI >( lambda0 );
+                  out[ outTStride ] = static_cast< TPI >( lambda1 );
+                  out[ 2 * outTStride ] = static_cast< TPI >( lambda2 );
+               } else {
+                  out[ 0 ] = static_cast< TPI >( largest ? lambda0 : lambda2 );
+               }
+            }
+         }
+      }
+   private:
+      dip::uint n_;
+      EigenvalueSelection selection_;
+};
+
+// Computes the eigenvalues of a real-valued, symmetric 2x2 or 3x3 tensor image. The output is of type
+// `dip::DT_SFLOAT` or `dip::DT_DFLOAT`, and is also used as buffer type to avoid conversions.
+void SymmetricEigenvalues( Image const& in, Image& out, EigenvalueSelection selection ) {
+   dip::uint n = in.TensorRows();
+   DataType outtype = DataType::SuggestFlex( in.DataType() );
+   std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
+   if( outtype == DT_DFLOAT ) {
+      scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
+            new SymmetricEigenvaluesLineFilter< dfloat >( n, selection ));
+   } else {
+      scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
+            new SymmetricEigenvaluesLineFilter< sfloat >( n, selection ));
+   }
+   dip::uint nOut = selection == EigenvalueSelection::all ? n : 1;
+   ImageRefArray outar{ out };
+   DIP_STACK_TRACE_THIS( Framework::Scan( { in }, outar, { outtype }, { outtype }, { outtype }, { nOut }, *scanLineFilter ));
+}
+
+} // namespace
+
 void Eigenvalues( Image const& in, Image& out ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.Tensor().IsSquare(), "The eigenvalues can only be computed from square matrices" );
@@ -528,6 +663,9 @@ void Eigenvalues( Image const& in, Image& out ) {
    } else if( in.TensorShape() == Tensor::Shape::DIAGONAL_MATRIX ) {
       DIP_STACK_TRACE_THIS( out.Copy( in.Diagonal() ));
       DIP_STACK_TRACE_THIS( SortTensorElementsByMagnitude( out ));
+   } else if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !in.DataType().IsComplex() ) &&
+             (( in.TensorRows() == 2 ) || ( in.TensorRows() == 3 ))) {
+      DIP_STACK_TRACE_THIS( SymmetricEigenvalues( in, out, EigenvalueSelection::all ));
    } else {
       dip::uint n = in.TensorRows();
       DataType intype = in.DataType();
@@ -536,23 +674,9 @@ void Eigenvalues( Image const& in, Image& out ) {
       DataType outtype;
       std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
       if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
-         switch( n ) {
-            case 2:
-               scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-                     []( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition2( pin, pout ); }, 400 * 2 // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
-               );
-               break;
-            case 3:
-               scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-                     []( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition3( pin, pout ); }, 400 * 3 // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
-               );
-               break;
-            default:
-               scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-                     [ n ]( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition( n, pin, pout ); }, 400 * n // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
-               );
-               break;
-         }
+         scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
+               [ n ]( auto const& pin, auto const& pout ) { SymmetricEigenDecomposition( n, pin, pout ); }, 400 * n // strange: it's much faster than EigenDecomposition, but parallelism is beneficial at same point.
+         );
          inbuffertype = outbuffertype = DT_DFLOAT;
          outtype = DataType::SuggestFlex( intype );
       } else {
@@ -626,46 +750,6 @@ class SelectEigenvalueLineFilter : public Framework::ScanLineFilter {
       std::vector< std::vector< TPO >> buffers_; // one for each thread
 };
 
-template< typename TPI, typename TPO, typename F >
-class SelectEigenvalueLineFilterN : public Framework::ScanLineFilter {
-   public:
-      SelectEigenvalueLineFilterN( F function, dip::uint n, bool first ) : function_( function ), n_( n ), first_( first ) {}
-      virtual dip::uint GetNumberOfOperations( dip::uint, dip::uint, dip::uint tensorElements ) override {
-         return ( typeid( TPI ) == typeid( dfloat ) ? 400 : 800 ) * tensorElements;
-      }
-      virtual void Filter( Framework::ScanLineFilterParameters const& params ) override {
-         dip::uint const bufferLength = params.bufferLength;
-         ConstLineIterator< TPI > in(
-               static_cast< TPI const* >( params.inBuffer[ 0 ].buffer ),
-               bufferLength,
-               params.inBuffer[ 0 ].stride,
-               params.inBuffer[ 0 ].tensorLength,
-               params.inBuffer[ 0 ].tensorStride
-         );
-         LineIterator< TPO > out(
-               static_cast< TPO* >( params.outBuffer[ 0 ].buffer ),
-               bufferLength,
-               params.outBuffer[ 0 ].stride,
-               params.outBuffer[ 0 ].tensorLength, // == 1
-               params.outBuffer[ 0 ].tensorStride
-         );
-         std::array< TPO, 3 > buf; // NOTE!!! `function_` is either `SymmetricEigenDecomposition2` or `SymmetricEigenDecomposition3`
-         TPO* bufPtr = buf.data();
-         if( !first_ ) {
-            bufPtr += n_ - 1;
-         }
-         // Compute
-         do {
-            function_( in.begin(), buf.data(), nullptr );
-            *out = *bufPtr;
-         } while( ++in, ++out );
-      }
-   private:
-      F function_;
-      dip::uint n_;
-      bool first_;
-};
-
 void SelectEigenvalue( Image const& in, Image& out, bool first ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( !in.Tensor().IsSquare(), "The eigenvalues can only be computed from square matrices" );
@@ -673,6 +757,9 @@ void SelectEigenvalue( Image const& in, Image& out, bool first ) {
       out = in;
    } else if( in.TensorShape() == Tensor::Shape::DIAGONAL_MATRIX ) {
       DIP_STACK_TRACE_THIS( MaximumAbsTensorElement( in, out ));
+   } else if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !in.DataType().IsComplex() ) &&
+             (( in.TensorRows() == 2 ) || ( in.TensorRows() == 3 ))) {
+      DIP_STACK_TRACE_THIS( SymmetricEigenvalues( in, out, first ? EigenvalueSelection::largest : EigenvalueSelection::smallest ));
    } else {
       dip::uint n = in.TensorRows();
       DataType intype = in.DataType();
@@ -681,22 +768,9 @@ void SelectEigenvalue( Image const& in, Image& out, bool first ) {
       DataType outtype;
       std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
       if(( in.TensorShape() == Tensor::Shape::SYMMETRIC_MATRIX ) && ( !intype.IsComplex() )) {
-         using funcType0 = void ( * )( ConstSampleIterator< dfloat >, SampleIterator< dfloat >, SampleIterator< dfloat > );
          using funcType = void ( * )( dip::uint, ConstSampleIterator< dfloat >, SampleIterator< dfloat >, SampleIterator< dfloat > );
-         switch( n ) {
-            case 2:
-               scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
-                     new SelectEigenvalueLineFilterN< dfloat, dfloat, funcType0 >( &SymmetricEigenDecomposition2, 2, first ));
-               break;
-            case 3:
-               scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
-                     new SelectEigenvalueLineFilterN< dfloat, dfloat, funcType0 >( &SymmetricEigenDecomposition3, 3, first ));
-               break;
-            default:
-               scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
-                     new SelectEigenvalueLineFilter< dfloat, dfloat, funcType >( &SymmetricEigenDecomposition, n, first ));
-               break;
-         }
+         scanLineFilter = static_cast< std::unique_ptr< Framework::ScanLineFilter >>(
+               new SelectEigenvalueLineFilter< dfloat, dfloat, funcType >( &SymmetricEigenDecomposition, n, first ));
          inbuffertype = DT_DFLOAT;
          outbuffertype = DT_DFLOAT;
          outtype = DataType::SuggestFlex( intype );
@@ -792,6 +866,45 @@ void EigenDecomposition( Image const& in, Image& out, Image& eigenvectors ) {
    }
 }
 
+namespace {
+
+// For 2x2 and 3x3 matrices, `dip::SymmetricEigenDecomposition2` and `dip::SymmetricEigenDecomposition3`
+// use fixed-size matrices, avoiding memory allocations for each pixel.
+template< dip::uint N >
+void SymmetricEigenDecompositionN( ConstSampleIterator< dfloat > in, dfloat* lambdas, dfloat* vectors ) {
+   if( N == 2 ) {
+      SymmetricEigenDecomposition2( in, lambdas, vectors );
+   } else {
+      SymmetricEigenDecomposition3( in, lambdas, vectors );
+   }
+}
+
+template< dip::uint N >
+std::unique_ptr< Framework::ScanLineFilter > NewLargestEigenvectorN() {
+   return NewTensorMonadicScanLineFilter< dfloat, dfloat >(
+         []( auto const& pin, auto const& pout ) {
+            std::array< dfloat, N > lambdas;
+            std::array< dfloat, N * N > vectors;
+            SymmetricEigenDecompositionN< N >( pin, lambdas.data(), vectors.data() );
+            std::copy( vectors.begin(), vectors.begin() + N, pout );
+         }, 300 * N
+   );
+}
+
+template< dip::uint N >
+std::unique_ptr< Framework::ScanLineFilter > NewSmallestEigenvectorN() {
+   return NewTensorMonadicScanLineFilter< dfloat, dfloat >(
+         []( auto const& pin, auto const& pout ) {
+            std::array< dfloat, N > lambdas;
+            std::array< dfloat, N * N > vectors;
+            SymmetricEigenDecompositionN< N >( pin, lambdas.data(), vectors.data() );
+            std::copy( vectors.end() - N, vectors.end(), pout );
+         }, 300 * N
+   );
+}
+
+} // namespace
+
 void LargestEigenvector( Image const& in, Image& out ) {
    DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( in.TensorShape() != Tensor::Shape::SYMMETRIC_MATRIX, "The image is not a symmetric matrix" );
@@ -799,9 +912,19 @@ void LargestEigenvector( Image const& in, Image& out ) {
    dip::uint n = in.TensorRows();
    DataType dataType = DataType::SuggestFlex( in.DataType() );
    std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
-   scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-         [ n ]( auto const& pin, auto const& pout ) { LargestEigenvector( n, pin, pout ); }, 600 * n // cost of decomposition???
-   );
+   switch( n ) {
+      case 2:
+         scanLineFilter = NewLargestEigenvectorN< 2 >();
+         break;
+      case 3:
+         scanLineFilter = NewLargestEigenvectorN< 3 >();
+         break;
+      default:
+         scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
+               [ n ]( auto const& pin, auto const& pout ) { LargestEigenvector( n, pin, pout ); }, 600 * n // cost of decomposition???
+         );
+         break;
+   }
    ImageRefArray outar{ out };
    DIP_STACK_TRACE_THIS( Framework::Scan( { in }, outar, { DT_DFLOAT }, { DT_DFLOAT }, { dataType },
                                           { n }, *scanLineFilter, Framework::ScanOption::ExpandTensorInBuffer ));
@@ -814,9 +937,19 @@ void SmallestEigenvector( Image const& in, Image& out ) {
    dip::uint n = in.TensorRows();
    DataType dataType = DataType::SuggestFlex( in.DataType() );
    std::unique_ptr< Framework::ScanLineFilter > scanLineFilter;
-   scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
-         [ n ]( auto const& pin, auto const& pout ) { SmallestEigenvector( n, pin, pout ); }, 600 * n // cost of decomposition???
-   );
+   switch( n ) {
+      case 2:
+         scanLineFilter = NewSmallestEigenvectorN< 2 >();
+         break;
+      case 3:
+         scanLineFilter = NewSmallestEigenvectorN< 3 >();
+         break;
+      default:
+         scanLineFilter = NewTensorMonadicScanLineFilter< dfloat, dfloat >(
+               [ n ]( auto const& pin, auto const& pout ) { SmallestEigenvector( n, pin, pout ); }, 600 * n // cost of decomposition???
+         );
+         break;
+   }
    ImageRefArray outar{ out };
    DIP_STACK_TRACE_THIS( Framework::Scan( { in }, outar, { DT_DFLOAT }, { DT_DFLOAT }, { dataType },
                                           { n }, *scanLineFilter, Framework::ScanOption::ExpandTensorInBuffer ));
@@ -1162,3 +1295,56 @@ void GeometricMeanTensorElement( Image const& in, Image& out ) {
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/random.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the closed-form symmetric eigenvalues") {
+   dip::Random random( 0 );
+   for( dip::uint n = 2; n <= 3; ++n ) {
+      dip::uint nElem = n * ( n + 1 ) / 2;
+      dip::Image in( { 25, 20 }, nElem, dip::DT_DFLOAT );
+      in.ReshapeTensor( dip::Tensor( dip::Tensor::Shape::SYMMETRIC_MATRIX, n, n ));
+      in.Fill( 0 );
+      dip::UniformNoise( in, in, random, -10.0, 10.0 );
+      // A few (nearly) degenerate tensors
+      dip::Image::Pixel iso( dip::FloatArray( nElem, 0.0 ), dip::DT_DFLOAT );
+      in.At( 0, 0 ) = iso;
+      for( dip::uint ii = 0; ii < n; ++ii ) {
+         iso[ ii ] = 3.0;
+      }
+      in.At( 1, 0 ) = iso;
+      iso[ n ] = 1e-7;
+      in.At( 2, 0 ) = iso;
+      iso[ 0 ] = -5.0;
+      in.At( 3, 0 ) = iso;
+      dip::Image out = dip::Eigenvalues( in );
+      dip::Image largest = dip::LargestEigenvalue( in );
+      dip::Image smallest = dip::SmallestEigenvalue( in );
+      dip::Image outf = dip::Eigenvalues( dip::Convert( in, dip::DT_SFLOAT ));
+      DOCTEST_CHECK( outf.DataType() == dip::DT_SFLOAT );
+      DOCTEST_REQUIRE( out.TensorElements() == n );
+      DOCTEST_REQUIRE( out.DataType() == dip::DT_DFLOAT );
+      std::vector< dip::dfloat > matrix( nElem );
+      std::vector< dip::dfloat > lambdas( n );
+      for( dip::uint jj = 0; jj < in.NumberOfPixels(); ++jj ) {
+         dip::Image::Pixel pixel = in.At( jj );
+         for( dip::uint kk = 0; kk < nElem; ++kk ) {
+            matrix[ kk ] = pixel[ kk ].As< dip::dfloat >();
+         }
+         dip::SymmetricEigenDecompositionPacked( n, matrix.data(), lambdas.data() );
+         dip::Image::Pixel result = out.At( jj );
+         for( dip::uint kk = 0; kk < n; ++kk ) {
+            DOCTEST_CHECK( result[ kk ].As< dip::dfloat >() == doctest::Approx( lambdas[ kk ] ).epsilon( 1e-7 ).scale( 10.0 ));
+            DOCTEST_CHECK( outf.At( jj )[ kk ].As< dip::dfloat >() == doctest::Approx( lambdas[ kk ] ).epsilon( 1e-5 ).scale( 10.0 ));
+         }
+         DOCTEST_CHECK( largest.At( jj ).As< dip::dfloat >() == result[ 0 ].As< dip::dfloat >() );
+         DOCTEST_CHECK( smallest.At( jj ).As< dip::dfloat >() == result[ n - 1 ].As< dip::dfloat >() );
+      }
+   }
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -33,6 +33,8 @@ class FeatureCircularity : public PolygonBased {
          return out;
       }
 
+      virtual bool IsThreadSafe() const override { return true; }
+
       virtual void Measure( Polygon const& polygon, Measurement::ValueIterator output ) override {
          output[ 0 ] = polygon.RadiusStatistics().Circularity();
       }
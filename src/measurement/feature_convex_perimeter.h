@@ -41,6 +41,8 @@ class FeatureConvexPerimeter : public ConvexHullBased {
          return out;
       }
 
+      virtual bool IsThreadSafe() const override { return true; }
+
       virtual void Measure( ConvexHull const& convexHull, Measurement::ValueIterator output ) override {
          output[ 0 ] = convexHull.Perimeter() * scale_;
       }
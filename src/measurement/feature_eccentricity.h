@@ -32,6 +32,8 @@ class FeatureEccentricity : public PolygonBased {
          return out;
       }
 
+      virtual bool IsThreadSafe() const override { return true; }
+
       virtual void Measure( Polygon const& polygon, Measurement::ValueIterator output ) override {
          *output = polygon.CovarianceMatrix().Eig().Eccentricity();
       }
@@ -51,6 +51,8 @@ class FeatureFeret : public ConvexHullBased {
          return out;
       }
 
+      virtual bool IsThreadSafe() const override { return true; }
+
       virtual void Measure( ConvexHull const& convexHull, Measurement::ValueIterator output ) override {
          FeretValues feret = convexHull.Feret();
          output[ 0 ] = feret.maxDiameter * scale_;
@@ -41,6 +41,8 @@ class FeaturePerimeter : public ChainCodeBased {
          return out;
       }
 
+      virtual bool IsThreadSafe() const override { return true; }
+
       virtual void Measure( ChainCode const& chainCode, Measurement::ValueIterator output ) override {
          *output = ( chainCode.Length() + pi ) * scale_;
       }
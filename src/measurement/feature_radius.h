@@ -50,6 +50,8 @@ class FeatureRadius : public PolygonBased {
          return out;
       }
 
+      virtual bool IsThreadSafe() const override { return true; }
+
       virtual void Measure( Polygon const& polygon, Measurement::ValueIterator output ) override {
          RadiusValues radius = polygon.RadiusStatistics();
          output[ 0 ] = radius.Maximum() * scale_;
@@ -41,6 +41,8 @@ class FeatureSolidArea : public PolygonBased {
          return out;
       }
 
+      virtual bool IsThreadSafe() const override { return true; }
+
       virtual void Measure( Polygon const& polygon, Measurement::ValueIterator output ) override {
          *output = polygon.Area() + 0.5;
       }
@@ -19,12 +19,13 @@
  */
 
 #include <array>
-#include <map>
+#include <unordered_map>
 
 #include "diplib.h"
 #include "diplib/chain_code.h"
 #include "diplib/regions.h"
 #include "diplib/overload.h"
+#include "diplib/multithreading.h"
 
 namespace dip {
 
@@ -34,8 +35,41 @@ constexpr VertexInteger ChainCode::deltas8[8];
 
 namespace {
 
-struct ObjectData { dip::uint index; bool done; };
-using ObjectIdList = std::map< dip::uint, ObjectData >; // key is the objectID (label)
+constexpr dip::uint NOT_FOUND = std::numeric_limits< dip::uint >::max();
+
+// Maps object IDs (labels) to indices into the output array. Labels are usually small integers (as
+// produced by `dip::Label`), in which case we use a look-up table. Otherwise we use a hash map.
+class ObjectIdToIndex {
+   public:
+      ObjectIdToIndex( UnsignedArray const& objectIDs, dip::uint nPixels ) {
+         dip::uint maxID = objectIDs.empty() ? 0 : *std::max_element( objectIDs.begin(), objectIDs.end() );
+         useTable_ = maxID <= std::max( nPixels, dip::uint( 1 ) << 16 );
+         if( useTable_ ) {
+            table_.resize( maxID + 1, NOT_FOUND );
+            for( dip::uint ii = 0; ii < objectIDs.size(); ++ii ) {
+               if( table_[ objectIDs[ ii ]] == NOT_FOUND ) { // if an ID is repeated, we use the first one
+                  table_[ objectIDs[ ii ]] = ii;
+               }
+            }
+         } else {
+            for( dip::uint ii = 0; ii < objectIDs.size(); ++ii ) {
+               map_.emplace( objectIDs[ ii ], ii );
+            }
+         }
+      }
+      // Returns `NOT_FOUND` if the object ID is not in the list
+      dip::uint operator()( dip::uint id ) const {
+         if( useTable_ ) {
+            return id < table_.size() ? table_[ id ] : NOT_FOUND;
+         }
+         auto it = map_.find( id );
+         return it == map_.end() ? NOT_FOUND : it->second;
+      }
+   private:
+      bool useTable_;
+      std::vector< dip::uint > table_;
+      std::unordered_map< dip::uint, dip::uint > map_;
+};
 
 template< typename TPI >
 static ChainCode dip__OneChainCode(
@@ -97,8 +131,8 @@ static ChainCode dip__OneChainCode(
 template< typename TPI >
 static ChainCodeArray dip__ChainCodes(
       Image const& labels,
-      ObjectIdList& objectIDs,
-      dip::uint nObjects, // potentially different from the number of entries in objectIDs, if there were repeated elements in the original list.
+      ObjectIdToIndex const& objectIndex,
+      dip::uint nObjects, // potentially different from the number of distinct IDs, if there were repeated elements in the original list.
       dip::uint connectivity,
       ChainCode::CodeTable const& codeTable
 ) {
@@ -106,33 +140,83 @@ static ChainCodeArray dip__ChainCodes(
    TPI* data = static_cast< TPI* >( labels.Origin() );
    ChainCodeArray ccArray( nObjects );  // output array
    VertexInteger dims = { static_cast< dip::sint >( labels.Size( 0 ) - 1 ), static_cast< dip::sint >( labels.Size( 1 ) - 1 ) }; // our local copy of `dims` now contains the largest coordinates
+   dip::uint width = labels.Size( 0 );
    IntegerArray const& strides = labels.Strides();
 
-   // Find first pixel of requested label
-   dip::uint label = 0;
-   VertexInteger coord;
-   for( coord.y = 0; coord.y <= dims.y; ++coord.y ) {
-      dip::sint pos = coord.y * strides[ 1 ];
-      for( coord.x = 0; coord.x <= dims.x; ++coord.x ) {
-         bool process = false;
-         dip::uint index = 0;
-         dip::uint newlabel = data[ pos ];
-         if( ( newlabel != 0 ) && ( newlabel != label ) ) {
-            // Check whether newlabel is start of not processed object
-            auto it = objectIDs.find( newlabel );
-            if( ( it != objectIDs.end() ) && !it->second.done ) {
-               it->second.done = true;
-               index = it->second.index;
-               label = newlabel;
-               process = true;
+   // First we find the start pixel for each object: the first pixel in the image (in linear order) with
+   // its label. Image lines are distributed over threads, each thread records the first pixel it sees for
+   // each object. Next, the chain code for each object is traced. Objects are independent, and are also
+   // distributed over threads.
+   dip::uint nThreads = GetNumberOfThreads();
+   if( nThreads > 1 ) {
+      // Scanning the image costs a few operations per pixel, tracing the contours much less.
+      if( labels.NumberOfPixels() * 4 < threadingThreshold ) {
+         nThreads = 1;
+      }
+   }
+   std::vector< std::vector< dip::uint >> starts( nThreads ); // linear index to the start pixel for each object
+   std::exception_ptr exception;
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      std::vector< dip::uint >& threadStarts = starts[ thread ];
+      try {
+         threadStarts.resize( nObjects, NOT_FOUND );
+      } catch( ... ) {
+         #pragma omp critical
+         if( !exception ) {
+            exception = std::current_exception();
+         }
+      }
+      #pragma omp barrier
+      if( !exception ) {
+         // Find the first pixel of each requested label
+         #pragma omp for schedule( static )
+         for( dip::sint y = 0; y <= dims.y; ++y ) {
+            TPI const* ptr = data + y * strides[ 1 ];
+            dip::uint label = 0;
+            for( dip::sint x = 0; x <= dims.x; ++x, ptr += strides[ 0 ] ) {
+               dip::uint newlabel = *ptr;
+               if(( newlabel != 0 ) && ( newlabel != label )) {
+                  label = newlabel;
+                  dip::uint index = objectIndex( label );
+                  if(( index != NOT_FOUND ) && ( threadStarts[ index ] == NOT_FOUND )) {
+                     // Each thread processes lines in order, so this is the first pixel for this thread
+                     threadStarts[ index ] = static_cast< dip::uint >( y ) * width + static_cast< dip::uint >( x );
+                  }
+               }
+            }
+         }
+         // Merge the start pixels found by the threads
+         #pragma omp single
+         for( dip::uint ii = 1; ii < nThreads; ++ii ) {
+            for( dip::uint jj = 0; jj < nObjects; ++jj ) {
+               starts[ 0 ][ jj ] = std::min( starts[ 0 ][ jj ], starts[ ii ][ jj ] );
             }
          }
-         if( process ) {
-            ccArray[ index ] = dip__OneChainCode< TPI >( data + pos, coord, dims, connectivity, codeTable, true );
+         // Trace the chain code for each object
+         #pragma omp for schedule( dynamic, 16 )
+         for( dip::sint ii = 0; ii < static_cast< dip::sint >( nObjects ); ++ii ) {
+            dip::uint start = starts[ 0 ][ static_cast< dip::uint >( ii ) ];
+            if( start == NOT_FOUND ) {
+               continue; // this object is not in the image, or its ID was repeated in the list
+            }
+            try {
+               VertexInteger coord = { static_cast< dip::sint >( start % width ), static_cast< dip::sint >( start / width ) };
+               dip::sint offset = coord.x * strides[ 0 ] + coord.y * strides[ 1 ];
+               ccArray[ static_cast< dip::uint >( ii ) ] = dip__OneChainCode< TPI >( data + offset, coord, dims, connectivity, codeTable, true );
+            } catch( ... ) {
+               #pragma omp critical
+               if( !exception ) {
+                  exception = std::current_exception();
+               }
+            }
          }
-         pos += strides[ 0 ];
       }
    }
+   if( exception ) {
+      std::rethrow_exception( exception );
+   }
    return ccArray;
 }
 
@@ -151,26 +235,19 @@ ChainCodeArray GetImageChainCodes(
    // Initialize freeman codes
    ChainCode::CodeTable codeTable = ChainCode::PrepareCodeTable( connectivity, labels.Strides() );
 
-   // Create a map for the object IDs
-   ObjectIdList objectIdList;
-   dip::uint nObjects;
+   // Create a look-up table for the object IDs
+   UnsignedArray allObjectIDs;
    if( objectIDs.empty() ) {
-      UnsignedArray allObjectIDs = GetObjectLabels( labels, Image(), S::EXCLUDE );
-      for( dip::uint ii = 0; ii < allObjectIDs.size(); ++ii ) {
-         objectIdList.emplace( allObjectIDs[ ii ], ObjectData{ ii, false } );
-      }
-      nObjects = allObjectIDs.size();
-   } else {
-      for( dip::uint ii = 0; ii < objectIDs.size(); ++ii ) {
-         objectIdList.emplace( objectIDs[ ii ], ObjectData{ ii, false } );
-      }
-      nObjects = objectIDs.size();
+      allObjectIDs = GetObjectLabels( labels, Image(), S::EXCLUDE );
    }
+   UnsignedArray const& ids = objectIDs.empty() ? allObjectIDs : objectIDs;
+   ObjectIdToIndex objectIndex( ids, labels.NumberOfPixels() );
+   dip::uint nObjects = ids.size();
 
    // Get the chain code for each label
    ChainCodeArray ccArray;
    DIP_OVL_CALL_ASSIGN_UINT( ccArray,
-                             dip__ChainCodes, ( labels, objectIdList, nObjects, connectivity, codeTable ),
+                             dip__ChainCodes, ( labels, objectIndex, nObjects, connectivity, codeTable ),
                              labels.DataType() );
    return ccArray;
 }
@@ -311,4 +388,93 @@ DOCTEST_TEST_CASE("[DIPlib] testing ChainCode::Offset") {
    }
 }
 
+#include "diplib/random.h"
+#include "diplib/generation.h"
+#include "diplib/linear.h"
+#include "diplib/multithreading.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the multi-threaded GetImageChainCodes") {
+   dip::Image img( { 300, 200 }, 1, dip::DT_SFLOAT );
+   img.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( img, img, random );
+   dip::Gauss( img, img, { 1.5 } );
+   dip::Image labels = dip::Label( img > 0.5, 2 );
+   dip::UnsignedArray objectIDs = dip::GetObjectLabels( labels, {}, dip::S::EXCLUDE );
+   DOCTEST_REQUIRE( objectIDs.size() > 100 );
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   dip::ChainCodeArray cc1 = dip::GetImageChainCodes( labels );
+   dip::SetNumberOfThreads( 3 );
+   dip::ChainCodeArray cc3 = dip::GetImageChainCodes( labels );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_REQUIRE( cc1.size() == objectIDs.size() );
+   DOCTEST_REQUIRE( cc3.size() == objectIDs.size() );
+   bool equal = true;
+   for( dip::uint ii = 0; ii < cc1.size(); ++ii ) {
+      equal &= cc1[ ii ].objectID == objectIDs[ ii ];
+      equal &= cc1[ ii ].objectID == cc3[ ii ].objectID;
+      equal &= cc1[ ii ].start == cc3[ ii ].start;
+      equal &= cc1[ ii ].codes.size() == cc3[ ii ].codes.size();
+      if( equal ) {
+         for( dip::uint jj = 0; jj < cc1[ ii ].codes.size(); ++jj ) {
+            equal &= cc1[ ii ].codes[ jj ] == cc3[ ii ].codes[ jj ];
+         }
+      }
+   }
+   DOCTEST_CHECK( equal );
+   // The start pixel is the first pixel of the object in linear order
+   dip::ChainCode const& cc = cc1[ 10 ];
+   dip::uint32 const* ptr = static_cast< dip::uint32 const* >( labels.Origin() );
+   dip::uint first = 0;
+   while( ptr[ first ] != cc.objectID ) {
+      ++first;
+   }
+   DOCTEST_CHECK( cc.start.x == static_cast< dip::sint >( first % labels.Size( 0 )));
+   DOCTEST_CHECK( cc.start.y == static_cast< dip::sint >( first / labels.Size( 0 )));
+   // Requested IDs that are repeated or not present in the image result in empty chain codes
+   dip::ChainCodeArray cc4 = dip::GetImageChainCodes( labels, { objectIDs[ 3 ], 1000000, objectIDs[ 3 ] } );
+   DOCTEST_REQUIRE( cc4.size() == 3 );
+   DOCTEST_CHECK( cc4[ 0 ].codes.size() == cc1[ 3 ].codes.size() );
+   DOCTEST_CHECK( cc4[ 1 ].codes.empty() );
+   DOCTEST_CHECK( cc4[ 2 ].codes.empty() );
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing GetImageChainCodes on known objects") {
+   // 300 copies of the little circle from the test above, each with its own label
+   dip::ChainCode circle;
+   circle.codes = { 0, 0, 7, 6, 6, 5, 4, 4, 3, 2, 2, 1 };
+   circle.start = { 1, 0 };
+   circle.is8connected = true;
+   dip::Image object = dip::Convert( circle.Image(), dip::DT_UINT32 );
+   dip::Image labels( { 140, 105 }, 1, dip::DT_UINT32 );
+   labels.Fill( 0 );
+   dip::uint32 id = 0;
+   for( dip::uint y = 0; y < 105; y += 7 ) {
+      for( dip::uint x = 0; x < 140; x += 7 ) {
+         ++id;
+         labels.At( dip::Range( static_cast< dip::sint >( x ), static_cast< dip::sint >( x + object.Size( 0 ) - 1 )),
+                    dip::Range( static_cast< dip::sint >( y ), static_cast< dip::sint >( y + object.Size( 1 ) - 1 ))).Copy( object * id );
+      }
+   }
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 3 );
+   dip::ChainCodeArray cc = dip::GetImageChainCodes( labels );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_REQUIRE( cc.size() == 300 );
+   bool correct = true;
+   for( dip::uint ii = 0; ii < cc.size(); ++ii ) {
+      correct &= cc[ ii ].objectID == ii + 1;
+      correct &= cc[ ii ].start.x == static_cast< dip::sint >( 7 * ( ii % 20 ) + 1 );
+      correct &= cc[ ii ].start.y == static_cast< dip::sint >( 7 * ( ii / 20 ));
+      correct &= cc[ ii ].codes.size() == circle.codes.size();
+      if( correct ) {
+         for( dip::uint jj = 0; jj < circle.codes.size(); ++jj ) {
+            correct &= cc[ ii ].codes[ jj ] == circle.codes[ jj ];
+         }
+      }
+   }
+   DOCTEST_CHECK( correct );
+}
+
 #endif // DIP__ENABLE_DOCTEST
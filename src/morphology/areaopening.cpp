@@ -116,8 +116,8 @@ void dip__AreaOpening(
          }
          default: {
             // Touching two or more labels
-            // Find a small region, if it exists
-            LabelType lab = 0;
+            // Find a small region, if it exists; otherwise use the first region
+            LabelType lab = neighborLabels.Label( 0 );
             for( auto nlab : neighborLabels ) {
                if( regions.Value( nlab ).size < filterSize ) {
                   lab = nlab;
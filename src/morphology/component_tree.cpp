@@ -0,0 +1,434 @@
+/*
+ * DIPlib 3.0
+ * This file contains the definition of dip::ComponentTree (max-tree and min-tree) and attribute filters.
+ *
+ * (c)2026, DIPlib contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diplib.h"
+#include "diplib/morphology.h"
+#include "diplib/boundary.h"
+#include "diplib/iterators.h"
+#include "diplib/neighborlist.h"
+#include "diplib/overload.h"
+#include "watershed_support.h"
+
+namespace dip {
+
+namespace {
+
+// Union-find root finding with path halving. `zpar` is -1 for pixels not yet processed.
+dip::sint FindRoot( std::vector< dip::sint >& zpar, dip::sint p ) {
+   while( zpar[ static_cast< dip::uint >( p ) ] != p ) {
+      dip::sint& q = zpar[ static_cast< dip::uint >( p ) ];
+      q = zpar[ static_cast< dip::uint >( q ) ];
+      p = q;
+   }
+   return p;
+}
+
+// `grey` has normal strides and a 1-pixel border that is not processed. `offsets` contains the offsets of all
+// pixels not in the border, in linear order, and `sorted` the same offsets sorted in processing order.
+template< typename TPI >
+void dip__BuildComponentTree(
+      Image const& grey,
+      std::vector< dip::sint > const& offsets,
+      std::vector< dip::sint > const& sorted,
+      IntegerArray const& neighborOffsets,
+      std::vector< ComponentTree::Node >& nodes,
+      std::vector< dip::uint >& pixelNodes
+) {
+   TPI const* data = static_cast< TPI const* >( grey.Origin() );
+   auto Value = [ data ]( dip::sint p ) { return data[ p ]; };
+   std::vector< dip::sint > parent( grey.NumberOfPixels(), -1 );
+   std::vector< dip::sint > zpar( grey.NumberOfPixels(), -1 );
+   auto Parent = [ &parent ]( dip::sint p ) -> dip::sint& { return parent[ static_cast< dip::uint >( p ) ]; };
+   auto ZPar = [ &zpar ]( dip::sint p ) -> dip::sint& { return zpar[ static_cast< dip::uint >( p ) ]; };
+
+   // Build the tree: pixels are processed from the top of the tree down; each processed neighbor's
+   // component becomes a child of the current pixel
+   for( dip::sint p : sorted ) {
+      Parent( p ) = p;
+      ZPar( p ) = p;
+      for( dip::sint o : neighborOffsets ) {
+         dip::sint n = p + o;
+         if( ZPar( n ) >= 0 ) {
+            dip::sint r = FindRoot( zpar, n );
+            if( r != p ) {
+               Parent( r ) = p;
+               ZPar( r ) = p;
+            }
+         }
+      }
+   }
+
+   // Canonicalize: make every pixel point to the canonical element of its node, and every canonical
+   // element point to the canonical element of its parent node
+   for( auto it = sorted.rbegin(); it != sorted.rend(); ++it ) {
+      dip::sint p = *it;
+      dip::sint q = Parent( p );
+      if( Value( Parent( q )) == Value( q )) {
+         Parent( p ) = Parent( q );
+      }
+   }
+
+   // Number the nodes. Canonical elements are processed after all other pixels in their node, and before
+   // the canonical element of their parent node, so nodes are numbered with children before parents.
+   // We re-use `zpar` to store the node index for each canonical element.
+   auto IsCanonical = [ & ]( dip::sint p ) { return ( Parent( p ) == p ) || ( Value( Parent( p )) != Value( p )); };
+   nodes.clear();
+   for( dip::sint p : sorted ) {
+      if( IsCanonical( p )) {
+         ZPar( p ) = static_cast< dip::sint >( nodes.size() );
+         nodes.push_back( { 0, static_cast< dfloat >( Value( p )), 0 } );
+      }
+   }
+   for( dip::sint p : sorted ) {
+      if( IsCanonical( p )) {
+         nodes[ static_cast< dip::uint >( ZPar( p )) ].parent = static_cast< dip::uint >( ZPar( Parent( p )));
+      }
+   }
+   DIP_ASSERT( nodes.back().parent == nodes.size() - 1 );
+
+   // Assign pixels to nodes and compute areas
+   pixelNodes.resize( offsets.size() );
+   for( dip::uint ii = 0; ii < offsets.size(); ++ii ) {
+      dip::sint p = offsets[ ii ];
+      dip::uint node = static_cast< dip::uint >( IsCanonical( p ) ? ZPar( p ) : ZPar( Parent( p )));
+      pixelNodes[ ii ] = node;
+      ++( nodes[ node ].area );
+   }
+   for( dip::uint ii = 0; ii < nodes.size() - 1; ++ii ) {
+      nodes[ nodes[ ii ].parent ].area += nodes[ ii ].area;
+   }
+}
+
+} // namespace
+
+ComponentTree::ComponentTree( Image const& in, dip::uint connectivity, String const& polarity ) {
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.IsScalar(), E::IMAGE_NOT_SCALAR );
+   DIP_THROW_IF( !in.DataType().IsReal() && !in.DataType().IsBinary(), E::DATA_TYPE_NOT_SUPPORTED );
+   dip::uint nDims = in.Dimensionality();
+   DIP_THROW_IF( nDims < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
+   DIP_THROW_IF( connectivity > nDims, E::ILLEGAL_CONNECTIVITY );
+   DIP_STACK_TRACE_THIS( maxTree_ = BooleanFromString( polarity, S::OPENING, S::CLOSING ));
+   sizes_ = in.Sizes();
+   pixelSize_ = in.PixelSize();
+   dataType_ = in.DataType();
+
+   // Copy the input image into one with normal strides and a 1-pixel border, the border pixels are never processed
+   Image grey;
+   DIP_STACK_TRACE_THIS( ExtendImage( in, grey, { 1 }, { BoundaryCondition::ADD_ZEROS } ));
+   if( grey.DataType().IsBinary() ) {
+      grey.Convert( DT_UINT8 );
+   }
+   DIP_ASSERT( grey.HasNormalStrides() );
+
+   // Offsets to all pixels, in linear order and in processing order
+   std::vector< dip::sint > offsets = CreateOffsetsArray( grey.Sizes(), grey.Strides() );
+   std::vector< dip::sint > sorted = offsets;
+   SortOffsets( grey, sorted, !maxTree_ );
+
+   // Offsets to neighbors
+   NeighborList neighbors( { Metric::TypeCode::CONNECTED, connectivity }, nDims );
+   IntegerArray neighborOffsets = neighbors.ComputeOffsets( grey.Strides() );
+
+   DIP_OVL_CALL_REAL( dip__BuildComponentTree, ( grey, offsets, sorted, neighborOffsets, nodes_, pixelNodes_ ), grey.DataType() );
+}
+
+std::vector< dfloat > ComponentTree::Attribute( String const& attribute ) const {
+   dip::uint nNodes = nodes_.size();
+   dip::uint nDims = sizes_.size();
+   std::vector< dfloat > out( nNodes );
+   // Sign to make differences between levels positive
+   dfloat sign = maxTree_ ? 1.0 : -1.0;
+   if( attribute == "area" ) {
+      for( dip::uint ii = 0; ii < nNodes; ++ii ) {
+         out[ ii ] = static_cast< dfloat >( nodes_[ ii ].area );
+      }
+   } else if( attribute == "volume" ) {
+      // Sum of grey values over the component: the pixels of a node all have the node's level
+      std::vector< dfloat > sum( nNodes );
+      for( dip::uint ii = 0; ii < nNodes; ++ii ) {
+         sum[ ii ] += nodes_[ ii ].level * static_cast< dfloat >( nodes_[ ii ].area );
+         if( ii != Root() ) {
+            sum[ nodes_[ ii ].parent ] -= nodes_[ nodes_[ ii ].parent ].level * static_cast< dfloat >( nodes_[ ii ].area );
+            sum[ nodes_[ ii ].parent ] += sum[ ii ];
+         }
+      }
+      for( dip::uint ii = 0; ii < nNodes; ++ii ) {
+         dfloat parentLevel = nodes_[ nodes_[ ii ].parent ].level;
+         out[ ii ] = sign * ( sum[ ii ] - parentLevel * static_cast< dfloat >( nodes_[ ii ].area ));
+      }
+   } else if( attribute == "height" ) {
+      // Most extreme level in the subtree: children come before parents
+      std::vector< dfloat > extreme( nNodes );
+      for( dip::uint ii = 0; ii < nNodes; ++ii ) {
+         extreme[ ii ] = nodes_[ ii ].level;
+      }
+      for( dip::uint ii = 0; ii < nNodes - 1; ++ii ) {
+         dfloat& parentExtreme = extreme[ nodes_[ ii ].parent ];
+         parentExtreme = maxTree_ ? std::max( parentExtreme, extreme[ ii ] ) : std::min( parentExtreme, extreme[ ii ] );
+      }
+      for( dip::uint ii = 0; ii < nNodes; ++ii ) {
+         out[ ii ] = sign * ( extreme[ ii ] - nodes_[ nodes_[ ii ].parent ].level );
+      }
+   } else if( attribute == "bounding box" ) {
+      // Per node: the lowest and highest coordinate along each dimension
+      std::vector< dip::uint > lowest( nNodes * nDims, std::numeric_limits< dip::uint >::max() );
+      std::vector< dip::uint > highest( nNodes * nDims, 0 );
+      UnsignedArray coords( nDims, 0 );
+      for( dip::uint node : pixelNodes_ ) {
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            lowest[ node * nDims + jj ] = std::min( lowest[ node * nDims + jj ], coords[ jj ] );
+            highest[ node * nDims + jj ] = std::max( highest[ node * nDims + jj ], coords[ jj ] );
+         }
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            if( ++coords[ jj ] < sizes_[ jj ] ) {
+               break;
+            }
+            coords[ jj ] = 0;
+         }
+      }
+      for( dip::uint ii = 0; ii < nNodes; ++ii ) {
+         dip::uint parent = nodes_[ ii ].parent;
+         dip::uint longest = 0;
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            if( ii != Root() ) {
+               lowest[ parent * nDims + jj ] = std::min( lowest[ parent * nDims + jj ], lowest[ ii * nDims + jj ] );
+               highest[ parent * nDims + jj ] = std::max( highest[ parent * nDims + jj ], highest[ ii * nDims + jj ] );
+            }
+            longest = std::max( longest, highest[ ii * nDims + jj ] - lowest[ ii * nDims + jj ] + 1 );
+         }
+         out[ ii ] = static_cast< dfloat >( longest );
+      }
+   } else if( attribute == "elongation" ) {
+      // Per node: the first and second order moments of the coordinates (the upper triangle of the second
+      // order moment matrix, in column-major order)
+      dip::uint nMoments = nDims + nDims * ( nDims + 1 ) / 2;
+      std::vector< dfloat > moments( nNodes * nMoments, 0.0 );
+      UnsignedArray coords( nDims, 0 );
+      for( dip::uint node : pixelNodes_ ) {
+         dfloat* m = moments.data() + node * nMoments;
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            m[ jj ] += static_cast< dfloat >( coords[ jj ] );
+         }
+         m += nDims;
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            for( dip::uint kk = 0; kk <= jj; ++kk ) {
+               *m += static_cast< dfloat >( coords[ jj ] * coords[ kk ] );
+               ++m;
+            }
+         }
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            if( ++coords[ jj ] < sizes_[ jj ] ) {
+               break;
+            }
+            coords[ jj ] = 0;
+         }
+      }
+      std::vector< dfloat > covariance( nDims * nDims );
+      std::vector< dfloat > lambdas( nDims );
+      for( dip::uint ii = 0; ii < nNodes; ++ii ) {
+         dfloat const* m = moments.data() + ii * nMoments;
+         if( ii != Root() ) {
+            dfloat* pm = moments.data() + nodes_[ ii ].parent * nMoments;
+            for( dip::uint jj = 0; jj < nMoments; ++jj ) {
+               pm[ jj ] += m[ jj ];
+            }
+         }
+         // Covariance matrix, each pixel is a unit square (cube) and contributes 1/12 to the variances
+         dfloat n = static_cast< dfloat >( nodes_[ ii ].area );
+         dfloat const* m2 = m + nDims;
+         for( dip::uint jj = 0; jj < nDims; ++jj ) {
+            for( dip::uint kk = 0; kk <= jj; ++kk ) {
+               dfloat c = *m2 / n - ( m[ jj ] / n ) * ( m[ kk ] / n );
+               if( jj == kk ) {
+                  c += 1.0 / 12.0;
+               }
+               covariance[ jj + kk * nDims ] = c;
+               covariance[ kk + jj * nDims ] = c;
+               ++m2;
+            }
+         }
+         SymmetricEigenDecomposition( nDims, covariance.data(), lambdas.data() );
+         out[ ii ] = std::sqrt( lambdas.front() / std::max( lambdas.back(), 1.0 / 12.0 ));
+      }
+   } else {
+      DIP_THROW_INVALID_FLAG( attribute );
+   }
+   return out;
+}
+
+std::vector< dfloat > ComponentTree::MaxRule( std::vector< dfloat > const& attribute ) const {
+   DIP_THROW_IF( attribute.size() != nodes_.size(), E::ARRAY_PARAMETER_WRONG_LENGTH );
+   std::vector< dfloat > out = attribute;
+   for( dip::uint ii = 0; ii < nodes_.size() - 1; ++ii ) {
+      dfloat& parent = out[ nodes_[ ii ].parent ];
+      parent = std::max( parent, out[ ii ] );
+   }
+   return out;
+}
+
+void ComponentTree::Filter( std::vector< dfloat > const& attribute, dfloat threshold, Image& out ) const {
+   std::vector< dfloat > value;
+   DIP_STACK_TRACE_THIS( value = MaxRule( attribute ));
+   // The level of each node after filtering: parents come after children, so we iterate backwards
+   dip::uint nNodes = nodes_.size();
+   std::vector< dfloat > level( nNodes );
+   level[ Root() ] = nodes_[ Root() ].level;
+   for( dip::uint ii = nNodes - 1; ii > 0; ) {
+      --ii;
+      level[ ii ] = value[ ii ] >= threshold ? nodes_[ ii ].level : level[ nodes_[ ii ].parent ];
+   }
+   // Paint the output
+   Image tmp( sizes_, 1, DT_DFLOAT );
+   DIP_ASSERT( tmp.HasNormalStrides() );
+   dfloat* ptr = static_cast< dfloat* >( tmp.Origin() );
+   for( dip::uint node : pixelNodes_ ) {
+      *ptr = level[ node ];
+      ++ptr;
+   }
+   DIP_START_STACK_TRACE
+      out.ReForge( sizes_, 1, dataType_, Option::AcceptDataTypeChange::DO_ALLOW );
+      out.Copy( tmp );
+   DIP_END_STACK_TRACE
+   out.SetPixelSize( pixelSize_ );
+}
+
+void ComponentTree::ExtinctionValues( std::vector< dfloat > const& attribute, Image& out ) const {
+   std::vector< dfloat > value;
+   DIP_STACK_TRACE_THIS( value = MaxRule( attribute ));
+   // For each node, the leaf that dominates its subtree. Children come before parents, so the dominating leaf
+   // is known when a node is reached. The extinction value of a leaf is updated each time its branch climbs
+   // one node up; when it loses the competition with a sibling branch, it is no longer updated.
+   dip::uint nNodes = nodes_.size();
+   constexpr dip::uint NONE = std::numeric_limits< dip::uint >::max();
+   std::vector< dip::uint > dominant( nNodes, NONE );
+   std::vector< dfloat > extinction( nNodes, 0.0 );
+   for( dip::uint ii = 0; ii < nNodes; ++ii ) {
+      if( dominant[ ii ] == NONE ) {
+         dominant[ ii ] = ii; // This is a leaf node
+      }
+      extinction[ dominant[ ii ]] = value[ ii ];
+      if( ii == Root() ) {
+         break;
+      }
+      dip::uint& parentDominant = dominant[ nodes_[ ii ].parent ];
+      if(( parentDominant == NONE ) || ( value[ ii ] > extinction[ parentDominant ] )) {
+         // This child's branch is the largest one seen so far, any previous one goes extinct
+         parentDominant = dominant[ ii ];
+      }
+   }
+   // Paint the output
+   DIP_STACK_TRACE_THIS( out.ReForge( sizes_, 1, DT_DFLOAT, Option::AcceptDataTypeChange::DO_ALLOW ));
+   out.Fill( 0 );
+   out.SetPixelSize( pixelSize_ );
+   ImageIterator< dfloat > it( out );
+   for( dip::uint node : pixelNodes_ ) {
+      if( dominant[ node ] == node ) {
+         *it = extinction[ node ];
+      }
+      ++it;
+   }
+}
+
+} // namespace dip
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/generation.h"
+#include "diplib/linear.h"
+#include "diplib/random.h"
+#include "diplib/testing.h"
+#include "diplib/binary.h"
+
+namespace {
+
+// Area opening by threshold decomposition, as a reference
+dip::Image AreaOpeningReference( dip::Image const& in, dip::uint size, dip::uint connectivity ) {
+   dip::Image out( in.Sizes(), 1, dip::DT_UINT8 );
+   out.Fill( 0 );
+   for( dip::uint t = 1; t < 256; ++t ) {
+      dip::Image bin = dip::BinaryAreaOpening( in >= t, size, connectivity );
+      dip::Add( out, bin, out, dip::DT_UINT8 );
+   }
+   return out;
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("[DIPlib] testing the component tree") {
+   // Attribute opening with area is the area opening
+   dip::Image in( { 64, 50 }, 1, dip::DT_SFLOAT );
+   in.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( in, in, random, 0, 255 );
+   dip::Gauss( in, in, { 2 } );
+   in.Convert( dip::DT_UINT8 );
+   for( dip::uint connectivity = 1; connectivity <= 2; ++connectivity ) {
+      for( auto const& polarity : { dip::S::OPENING, dip::S::CLOSING } ) {
+         dip::ComponentTree tree( in, connectivity, polarity );
+         auto area = tree.Attribute( "area" );
+         for( dip::uint size : { 5u, 30u } ) {
+            dip::Image out1 = tree.Filter( area, static_cast< dip::dfloat >( size ));
+            dip::Image out2;
+            if( polarity == dip::S::OPENING ) {
+               out2 = AreaOpeningReference( in, size, connectivity );
+            } else {
+               out2 = dip::Invert( AreaOpeningReference( dip::Invert( in ), size, connectivity ));
+            }
+            DOCTEST_CHECK( out1.DataType() == dip::DT_UINT8 );
+            DOCTEST_CHECK( dip::testing::CompareImages( out1, out2 ));
+            dip::Image out3 = dip::AreaOpening( in, {}, size, connectivity, polarity );
+            DOCTEST_CHECK( dip::testing::CompareImages( out1, out3 ));
+         }
+      }
+   }
+
+   // Extinction values
+   dip::Image img( { 8 }, 1, dip::DT_UINT8 );
+   dip::uint8* ptr = static_cast< dip::uint8* >( img.Origin() );
+   std::vector< dip::uint8 > values{ 0, 3, 0, 5, 5, 0, 2, 0 };
+   std::copy( values.begin(), values.end(), ptr );
+   dip::ComponentTree tree( img, 1 );
+   DOCTEST_CHECK( tree.NumberOfNodes() == 4 );
+   dip::Image ext = tree.ExtinctionValues( tree.Attribute( "area" ));
+   DOCTEST_CHECK( ext.At( 1 ) == 1 );
+   DOCTEST_CHECK( ext.At( 3 ) == 8 );
+   DOCTEST_CHECK( ext.At( 4 ) == 8 );
+   DOCTEST_CHECK( ext.At( 6 ) == 1 );
+   DOCTEST_CHECK( ext.At( 0 ) == 0 );
+   ext = tree.ExtinctionValues( tree.Attribute( "height" ));
+   DOCTEST_CHECK( ext.At( 1 ) == 3 );
+   DOCTEST_CHECK( ext.At( 3 ) == 5 );
+   DOCTEST_CHECK( ext.At( 6 ) == 2 );
+   auto volume = tree.Attribute( "volume" );
+   DOCTEST_CHECK( volume[ tree.PixelNodes()[ 3 ]] == 10 );
+   DOCTEST_CHECK( volume[ tree.Root() ] == 15 );
+   auto box = tree.Attribute( "bounding box" );
+   DOCTEST_CHECK( box[ tree.PixelNodes()[ 3 ]] == 2 );
+   DOCTEST_CHECK( box[ tree.Root() ] == 8 );
+   auto elongation = tree.Attribute( "elongation" );
+   DOCTEST_CHECK( elongation[ tree.PixelNodes()[ 1 ]] == doctest::Approx( 1.0 ));
+   DOCTEST_CHECK( elongation[ tree.Root() ] == doctest::Approx( 1.0 )); // always 1 in 1D
+   dip::Image out = tree.Filter( box, 2 );
+   DOCTEST_CHECK( out.At( 1 ) == 0 );
+   DOCTEST_CHECK( out.At( 3 ) == 5 );
+   DOCTEST_CHECK( out.At( 6 ) == 0 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -24,6 +24,7 @@
 #include "diplib/math.h"
 #include "diplib/generation.h"
 #include "diplib/overload.h"
+#include "diplib/multithreading.h"
 
 #include "watershed_support.h"
 
@@ -114,6 +115,9 @@ void MakeNeighborLists(
 using PathLenType = uint16;
 constexpr auto DT_PATHLEN = DT_UINT16;
 
+// Maximum total size of the per-thread temporary images in `dip::PathOpening`, in bytes
+constexpr dip::uint maxPathOpeningMemory = dip::uint( 1 ) << 30; // 1 GiB
+
 constexpr uint8 DIP__PO_ACTIVE = 1;
 constexpr uint8 DIP__PO_QUEUED = 2;
 constexpr uint8 DIP__PO_CHANGED = 4;
@@ -443,7 +447,7 @@ void PathOpening(
       }
    }
 
-   // Prepare temporary images
+   // Prepare temporary image, it's used also to sort the offsets
    Image tmp;
    tmp.Copy( in );
    DIP_ASSERT( tmp.HasContiguousData() );
@@ -452,27 +456,6 @@ void PathOpening(
       ovlType = DT_UINT8; // treat binary image as if it were uint8.
    }
 
-   Image active;
-   active.SetStrides( tmp.Strides() );
-   active.ReForge( tmp, DT_BIN );
-   DIP_ASSERT( active.Strides() == tmp.Strides() );
-
-   Image len1, len2, len3, len4;
-   len1.SetStrides( tmp.Strides() );
-   len1.ReForge( tmp, DT_PATHLEN );
-   DIP_ASSERT( len1.Strides() == tmp.Strides() );
-   len2.SetStrides( tmp.Strides() );
-   len2.ReForge( tmp, DT_PATHLEN );
-   DIP_ASSERT( len2.Strides() == tmp.Strides() );
-   if( constrained ) {
-      len3.SetStrides( tmp.Strides() );
-      len3.ReForge( tmp, DT_PATHLEN );
-      DIP_ASSERT( len3.Strides() == tmp.Strides() );
-      len4.SetStrides( tmp.Strides() );
-      len4.ReForge( tmp, DT_PATHLEN );
-      DIP_ASSERT( len4.Strides() == tmp.Strides() );
-   }
-
    // Create sorted offsets array (skipping border)
    std::vector< dip::sint > offsets;
    if( mask.IsForged() ) {
@@ -482,71 +465,20 @@ void PathOpening(
    }
    SortOffsets( tmp, offsets, opening );
 
-   // Create two arrays with offsets to neighbors
-   IntegerArray offsetUp, offsetDown;
-
-   // Loop over all ((3^ndims)-1)/2 directions
-   bool firstOne = true;
+   // Collect all ((3^ndims)-1)/2 directions
+   std::vector< IntegerArray > directions;
    IntegerArray direction( ndims, -1 );
    for( ;; ) {
-
       // Check to see if this direction is "unique":
       // There must be at least one positive value, and the first non-negative value must be positive.
-      bool valid = false;
       for( dip::uint ii = 0; ii < ndims; ++ii ) {
          if( direction[ ii ] != 0 ) {
             if( direction[ ii ] > 0 ) {
-               valid = true;
+               directions.push_back( direction );
             }
             break;
          }
       }
-      if( valid ) {
-
-         // Fill arrays with indices to neighbors
-         MakeNeighborLists( direction, tmp.Strides(), offsetUp, offsetDown );
-
-         // Initialise temporary images
-         if( !firstOne ) {
-            tmp.Copy( in );
-         }
-         if( mask.IsForged() ) {
-            active.Copy( mask );
-         } else {
-            active.Fill( DIP__PO_ACTIVE );
-         }
-         SetBorder( active, Image::Pixel( 0 ) ); // Set border pixels to inactive, we won't process them.
-         len1.Fill( length );
-         len2.Fill( length );
-         if( constrained ) {
-            len3.Fill( length );
-            len4.Fill( length );
-         }
-
-         // Do the data-type-dependent thing
-         if( constrained ) {
-            DIP_OVL_CALL_REAL( dip__ConstrainedPathOpening,
-                               ( tmp, active, len1, len2, len3, len4, offsets, offsetUp, offsetDown, length ),
-                               ovlType );
-         } else {
-            DIP_OVL_CALL_REAL( dip__PathOpening,
-                               ( tmp, active, len1, len2, offsets, offsetUp, offsetDown, length ),
-                               ovlType );
-         }
-
-         // Collect in output
-         if( firstOne ) {
-            out.Copy( tmp );
-            firstOne = false;
-         } else {
-            if( opening ) {
-               Supremum( tmp, out, out );
-            } else {
-               Infimum( tmp, out, out );
-            }
-         }
-      }
-
       // Next
       dip::uint ii = 0;
       for( ; ii < ndims; ++ii ) {
@@ -560,6 +492,136 @@ void PathOpening(
          break;
       }
    }
+   dip::uint nDirections = directions.size();
+
+   // Directions are independent, we distribute them over threads. Each thread has its own temporary images,
+   // and collects the supremum (or infimum) of the results for the directions it processed.
+   dip::uint nThreads = std::min( GetNumberOfThreads(), nDirections );
+   if( nThreads > 1 ) {
+      // Each direction costs on the order of 20 operations per pixel
+      if( nDirections * in.NumberOfPixels() * 20 < threadingThreshold ) {
+         nThreads = 1;
+      }
+      // Each thread has a copy of the image, a binary image, two or four path length images, and its result;
+      // we limit the total size of these temporary images
+      dip::uint bytesPerThread = tmp.NumberOfPixels() * ( 2 * tmp.DataType().SizeOf() + DT_BIN.SizeOf()
+                                                         + ( constrained ? 4 : 2 ) * DT_PATHLEN.SizeOf() );
+      nThreads = std::max( dip::uint( 1 ), std::min( nThreads, maxPathOpeningMemory / bytesPerThread ));
+   }
+   std::vector< Image > results( nThreads );
+   std::exception_ptr exception;
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      Image threadTmp;
+      Image active;
+      Image len1, len2, len3, len4;
+      try {
+         if( thread == 0 ) {
+            threadTmp = tmp.QuickCopy();
+         } else {
+            threadTmp.SetStrides( tmp.Strides() );
+            threadTmp.ReForge( tmp );
+         }
+         DIP_ASSERT( threadTmp.Strides() == tmp.Strides() );
+         active.SetStrides( tmp.Strides() );
+         active.ReForge( tmp, DT_BIN );
+         DIP_ASSERT( active.Strides() == tmp.Strides() );
+         len1.SetStrides( tmp.Strides() );
+         len1.ReForge( tmp, DT_PATHLEN );
+         DIP_ASSERT( len1.Strides() == tmp.Strides() );
+         len2.SetStrides( tmp.Strides() );
+         len2.ReForge( tmp, DT_PATHLEN );
+         DIP_ASSERT( len2.Strides() == tmp.Strides() );
+         if( constrained ) {
+            len3.SetStrides( tmp.Strides() );
+            len3.ReForge( tmp, DT_PATHLEN );
+            DIP_ASSERT( len3.Strides() == tmp.Strides() );
+            len4.SetStrides( tmp.Strides() );
+            len4.ReForge( tmp, DT_PATHLEN );
+            DIP_ASSERT( len4.Strides() == tmp.Strides() );
+         }
+      } catch( ... ) {
+         #pragma omp critical
+         if( !exception ) {
+            exception = std::current_exception();
+         }
+      }
+      #pragma omp barrier
+      if( !exception ) {
+         #pragma omp for schedule( dynamic )
+         for( dip::sint jj = 0; jj < static_cast< dip::sint >( nDirections ); ++jj ) {
+            try {
+               // Fill arrays with indices to neighbors
+               IntegerArray offsetUp, offsetDown;
+               MakeNeighborLists( directions[ static_cast< dip::uint >( jj ) ], tmp.Strides(), offsetUp, offsetDown );
+
+               // Initialise temporary images
+               threadTmp.Copy( in );
+               if( mask.IsForged() ) {
+                  active.Copy( mask );
+               } else {
+                  active.Fill( DIP__PO_ACTIVE );
+               }
+               SetBorder( active, Image::Pixel( 0 ) ); // Set border pixels to inactive, we won't process them.
+               len1.Fill( length );
+               len2.Fill( length );
+               if( constrained ) {
+                  len3.Fill( length );
+                  len4.Fill( length );
+               }
+
+               // Do the data-type-dependent thing
+               if( constrained ) {
+                  DIP_OVL_CALL_REAL( dip__ConstrainedPathOpening,
+                                     ( threadTmp, active, len1, len2, len3, len4, offsets, offsetUp, offsetDown, length ),
+                                     ovlType );
+               } else {
+                  DIP_OVL_CALL_REAL( dip__PathOpening,
+                                     ( threadTmp, active, len1, len2, offsets, offsetUp, offsetDown, length ),
+                                     ovlType );
+               }
+
+               // Collect in this thread's result
+               Image& result = results[ thread ];
+               if( !result.IsForged() ) {
+                  result.Copy( threadTmp );
+               } else {
+                  if( opening ) {
+                     Supremum( threadTmp, result, result );
+                  } else {
+                     Infimum( threadTmp, result, result );
+                  }
+               }
+            } catch( ... ) {
+               #pragma omp critical
+               if( !exception ) {
+                  exception = std::current_exception();
+               }
+            }
+         }
+      }
+   }
+   if( exception ) {
+      std::rethrow_exception( exception );
+   }
+
+   // Collect in output. With dynamic scheduling, any thread (including thread 0) might not have gotten
+   // any directions to process, its result is then not forged
+   bool first = true;
+   for( dip::uint ii = 0; ii < nThreads; ++ii ) {
+      if( !results[ ii ].IsForged() ) {
+         continue;
+      }
+      if( first ) {
+         out.Copy( results[ ii ] );
+         first = false;
+      } else if( opening ) {
+         Supremum( results[ ii ], out, out );
+      } else {
+         Infimum( results[ ii ], out, out );
+      }
+   }
 
    // Finalize the robust method
    if( robust ) {
@@ -713,3 +775,57 @@ void DirectedPathOpening(
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/random.h"
+#include "diplib/testing.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the multi-threaded path opening") {
+   dip::Image in( { 64, 50, 30 }, 1, dip::DT_UINT8 );
+   in.Fill( 0 );
+   dip::Random random( 0 );
+   dip::UniformNoise( in, in, random, 0, 255 );
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   for( auto const& mode : { dip::S::UNCONSTRAINED, dip::S::CONSTRAINED } ) {
+      dip::SetNumberOfThreads( 1 );
+      dip::Image out1 = dip::PathOpening( in, {}, 7, dip::S::OPENING, { mode } );
+      dip::SetNumberOfThreads( 3 );
+      dip::Image out2 = dip::PathOpening( in, {}, 7, dip::S::OPENING, { mode } );
+      DOCTEST_CHECK( dip::testing::CompareImages( out1, out2 ));
+      DOCTEST_CHECK( dip::testing::CompareImages( dip::Supremum( out1, in ), in ));
+   }
+   dip::SetNumberOfThreads( nThreads );
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the path opening on known paths") {
+   // A horizontal and a diagonal path of 10 pixels survive a path opening of length 7,
+   // a vertical path of 4 pixels and an isolated pixel are removed.
+   dip::Image in( { 40, 40 }, 1, dip::DT_UINT8 );
+   in.Fill( 0 );
+   dip::Image expected = in.Copy();
+   for( dip::uint ii = 0; ii < 10; ++ii ) {
+      in.At( 5 + ii, 5 ) = 200;
+      expected.At( 5 + ii, 5 ) = 200;
+      in.At( 20 + ii, 15 + ii ) = 150;
+      expected.At( 20 + ii, 15 + ii ) = 150;
+   }
+   for( dip::uint ii = 0; ii < 4; ++ii ) {
+      in.At( 8, 20 + ii ) = 100;
+   }
+   in.At( 30, 5 ) = 250;
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   // 2D images have 4 directions: with 16 threads requested, there is one thread per direction, and with
+   // dynamic scheduling some threads (possibly thread 0) don't get any directions to process
+   for( dip::uint threads : { 1u, 3u, 16u } ) {
+      dip::SetNumberOfThreads( threads );
+      for( auto const& mode : { dip::S::UNCONSTRAINED, dip::S::CONSTRAINED } ) {
+         dip::Image out = dip::PathOpening( in, {}, 7, dip::S::OPENING, { mode } );
+         DOCTEST_CHECK( dip::testing::CompareImages( out, expected ));
+      }
+   }
+   dip::SetNumberOfThreads( nThreads );
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -19,6 +19,7 @@
  * limitations under the License.
  */
 
+#include <exception>
 #include <functional>
 #include <queue>
 #include <stack>
@@ -37,6 +38,8 @@
 #include "diplib/overload.h"
 #include "diplib/union_find.h"
 #include "diplib/graph.h"
+#include "diplib/random.h"
+#include "diplib/multithreading.h"
 #include "watershed_support.h"
 
 namespace dip {
@@ -892,11 +895,74 @@ void ExactStochasticWatershed(
    DIP_END_STACK_TRACE
 }
 
+// Each iteration of the stochastic watershed uses a copy of the random number generator advanced by this many
+// steps (jump-ahead). An iteration uses about two random numbers per pixel, so these streams never overlap.
+constexpr dip::uint STOCHASTIC_WATERSHED_STREAM_LENGTH = dip::uint( 1 ) << 40u;
+
+// Single-threaded alternative to `dip::FillPoissonPointProcess`: the result depends only on `random`, not on
+// the number of threads used.
+void PoissonPointProcess( Image& out, Random& random, dfloat density ) {
+   BinaryRandomGenerator generator( random );
+   ImageIterator< bin > it( out );
+   do {
+      *it = generator( density );
+   } while( ++it );
+}
+
+// Single-threaded alternative to `dip::UniformNoise`: the result depends only on `random`, not on the number
+// of threads used. `out` is forged and has a floating-point type.
+template< typename TPI >
+void AddUniformNoise( Image& out, Random& random, dfloat noise ) {
+   UniformRandomGenerator generator( random );
+   ImageIterator< TPI > it( out );
+   do {
+      *it = static_cast< TPI >( static_cast< dfloat >( *it ) + generator( 0.0, noise ));
+   } while( ++it );
+}
+
+// One iteration of the stochastic watershed, adds the edges found to `sum`.
+void StochasticWatershedIteration(
+      Image const& in,
+      Image& sum,
+      Image& grid,
+      Image& edges,
+      Image& noisy,
+      Random& random,
+      dfloat density,
+      dfloat noise,
+      String const& seeds
+) {
+   if( seeds == S::POISSON ) {
+      PoissonPointProcess( grid, random, density );
+   } else {
+      FillRandomGrid( grid, random, density, seeds, S::ROTATION );
+   }
+   if( noise > 0.0 ) {
+      noisy.Copy( in );
+      DIP_OVL_CALL_FLOAT( AddUniformNoise, ( noisy, random, noise ), noisy.DataType() );
+   }
+   SeededWatershed( noisy, grid, {}, edges, 1, -1 /* no merging */ );
+   sum += edges;
+}
+
 } // namespace
 
+void StochasticWatershed(
+      Image const& in,
+      Image& out,
+      dip::uint nSeeds,
+      dip::uint nIterations,
+      dfloat noise,
+      String const& seeds
+) {
+   Random random;
+   StochasticWatershed( in, out, random, nSeeds, nIterations, noise, seeds );
+}
+
 void StochasticWatershed(
       Image const& c_in,
       Image& out,
+      Random& random,
       dip::uint nSeeds,
       dip::uint nIterations,
       dfloat noise,
@@ -907,7 +973,6 @@ void StochasticWatershed(
    DIP_THROW_IF( !c_in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
    DIP_THROW_IF( c_in.Dimensionality() < 1, E::DIMENSIONALITY_NOT_SUPPORTED );
    DIP_THROW_IF( nSeeds == 0, E::INVALID_PARAMETER );
-   Random random;
    dfloat density = static_cast< dfloat >( nSeeds ) / static_cast< dfloat >( c_in.NumberOfPixels() );
    if(( seeds == S::EXACT ) || ( nIterations == 0 )) {
       if( noise > 0 ) {
@@ -927,28 +992,94 @@ void StochasticWatershed(
       }
       return;
    }
-   bool poisson = seeds == S::POISSON;
    Image in = c_in;
    if( out.Aliases( in )) {
       out.Strip();
    }
    out.ReForge( in, DT_LABEL, Option::AcceptDataTypeChange::DO_ALLOW );
    out.Fill( 0 );
-   Image grid = in.Similar( DT_BIN );
-   Image edges = in.Similar( DT_BIN );
-   Image noisy = noise > 0.0 ? in.Similar( DataType::SuggestFloat( in.DataType() )) : in.QuickCopy();
-   for( dip::uint iter = 0; iter < nIterations; ++iter ) {
-      if( poisson ) {
-         FillPoissonPointProcess( grid, random, density );
-      } else {
-         FillRandomGrid( grid, random, density, seeds, S::ROTATION );
+
+   // Iterations are independent, we distribute them over threads. Each iteration uses its own random stream,
+   // and the counts are added in integer arithmetic, so the result does not depend on the number of threads.
+   Random base = random;
+   random.Advance( nIterations * STOCHASTIC_WATERSHED_STREAM_LENGTH );
+   dip::uint nThreads = std::min( GetNumberOfThreads(), nIterations );
+   if( nThreads > 1 ) {
+      // Each iteration costs on the order of 20 operations per pixel
+      if( nIterations * in.NumberOfPixels() * 20 < threadingThreshold ) {
+         nThreads = 1;
+      }
+   }
+   std::vector< Image > sums( nThreads );
+   sums[ 0 ] = out.QuickCopy();
+   std::exception_ptr exception;
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      dip::uint thread = static_cast< dip::uint >( omp_get_thread_num() );
+      Image grid;
+      Image edges;
+      Image noisy;
+      try {
+         grid = in.Similar( DT_BIN );
+         edges = in.Similar( DT_BIN );
+         noisy = noise > 0.0 ? in.Similar( DataType::SuggestFloat( in.DataType() )) : in.QuickCopy();
+         if( thread > 0 ) {
+            sums[ thread ] = out.Similar();
+            sums[ thread ].Fill( 0 );
+         }
+      } catch( ... ) {
+         #pragma omp critical
+         if( !exception ) {
+            exception = std::current_exception();
+         }
       }
-      if( noise > 0.0 ) {
-         UniformNoise( in, noisy, random, 0.0, noise );
+      #pragma omp barrier
+      if( !exception ) {
+         #pragma omp for schedule( dynamic )
+         for( dip::sint iter = 0; iter < static_cast< dip::sint >( nIterations ); ++iter ) {
+            try {
+               Random iterRandom = base;
+               iterRandom.Advance( static_cast< dip::uint >( iter ) * STOCHASTIC_WATERSHED_STREAM_LENGTH );
+               StochasticWatershedIteration( in, sums[ thread ], grid, edges, noisy, iterRandom, density, noise, seeds );
+            } catch( ... ) {
+               #pragma omp critical
+               if( !exception ) {
+                  exception = std::current_exception();
+               }
+            }
+         }
       }
-      SeededWatershed( noisy, grid, {}, edges, 1, -1 /* no merging */ );
-      out += edges;
+   }
+   if( exception ) {
+      std::rethrow_exception( exception );
+   }
+   for( dip::uint ii = 1; ii < nThreads; ++ii ) {
+      out += sums[ ii ];
    }
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+#include "diplib/multithreading.h"
+
+DOCTEST_TEST_CASE( "[DIPlib] testing the stochastic watershed" ) {
+   dip::Random random( 42 );
+   dip::Image in( { 64, 50 }, 1, dip::DT_SFLOAT );
+   dip::UniformNoise( in, in, random, 0.0, 100.0 );
+   dip::uint nThreads = dip::GetNumberOfThreads();
+   dip::SetNumberOfThreads( 1 );
+   random.Seed( 7 );
+   dip::Image out1 = dip::StochasticWatershed( in, random, 20, 12, 5.0, "poisson" );
+   dip::SetNumberOfThreads( 3 );
+   random.Seed( 7 );
+   dip::Image out2 = dip::StochasticWatershed( in, random, 20, 12, 5.0, "poisson" );
+   dip::SetNumberOfThreads( nThreads );
+   DOCTEST_CHECK( dip::Count( out1 ) > 0 );
+   DOCTEST_CHECK( dip::Count( out1 != out2 ) == 0 );
+   DOCTEST_CHECK( dip::Maximum( out1 ).As< dip::uint >() <= 12 );
+}
+
+#endif // DIP__ENABLE_DOCTEST
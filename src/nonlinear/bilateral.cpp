@@ -401,6 +401,486 @@ void SeparableBilateralFilter(
 }
 
 
+namespace {
+
+// Copies the data of `in` into a new `DT_DFLOAT` image, or simply copies the header if it's already of that type.
+Image MakeDFloat( Image const& in ) {
+   Image out = in.QuickCopy();
+   if( out.DataType() != DT_DFLOAT ) {
+      out.Convert( DT_DFLOAT );
+   }
+   return out;
+}
+
+// Writes the `DT_DFLOAT` image `result` into `out`, which gets the properties of `in`.
+void WriteBilateralOutput( Image const& in, Image const& result, Image& out ) {
+   PixelSize pixelSize = in.PixelSize();
+   String colorSpace = in.ColorSpace();
+   Tensor tensor = in.Tensor();
+   DataType dataType = DataType::SuggestFlex( in.DataType() );
+   out.ReForge( in.Sizes(), in.TensorElements(), dataType, Option::AcceptDataTypeChange::DO_ALLOW );
+   out.ReshapeTensor( tensor );
+   out.Copy( result );
+   out.SetPixelSize( pixelSize );
+   if( !colorSpace.empty() ) {
+      out.SetColorSpace( colorSpace );
+   }
+}
+
+// Maximum number of bins along the tonal dimension of the bilateral grid
+constexpr dip::uint maxGridTonalBins = 256;
+
+// Bilateral grid for a scalar image: `in` and `estimate` are scalar `DT_DFLOAT` images, `out` is a forged
+// scalar `DT_DFLOAT` image of the same sizes.
+void ScalarGridBilateralFilter(
+      Image const& in,
+      Image const& estimate,
+      Image& out,
+      FloatArray const& spatialSigmas,
+      dfloat tonalSigma,
+      dfloat truncation
+) {
+   dip::uint nDims = in.Dimensionality();
+   dip::uint gridDims = nDims + 1;
+
+   // Determine the sampling of the grid. The grid is sampled at a distance of one sigma, and blurred with a
+   // Gaussian with a sigma of one grid cell. Dimensions with a sigma smaller than 1 are not subsampled.
+   FloatArray sampling( gridDims );
+   FloatArray gridSigmas( gridDims );
+   UnsignedArray gridSizes( gridDims );
+   for( dip::uint ii = 0; ii < nDims; ++ii ) {
+      sampling[ ii ] = std::max( spatialSigmas[ ii ], 1.0 );
+      gridSigmas[ ii ] = spatialSigmas[ ii ] / sampling[ ii ];
+      gridSizes[ ii ] = static_cast< dip::uint >( std::floor( static_cast< dfloat >( in.Size( ii ) - 1 ) / sampling[ ii ] )) + 2;
+   }
+   MinMaxAccumulator inRange = MaximumAndMinimum( in );
+   MinMaxAccumulator estRange = MaximumAndMinimum( estimate );
+   dfloat minValue = std::min( inRange.Minimum(), estRange.Minimum() );
+   dfloat maxValue = std::max( inRange.Maximum(), estRange.Maximum() );
+   DIP_THROW_IF( !std::isfinite( minValue ) || !std::isfinite( maxValue ), "The bilateral grid requires finite pixel values" );
+   // Like the spatial dimensions, the tonal dimension is not subsampled more finely than needed: it has
+   // at most `maxGridTonalBins` bins, otherwise the grid could become arbitrarily large
+   sampling[ nDims ] = std::max( tonalSigma, ( maxValue - minValue ) / static_cast< dfloat >( maxGridTonalBins ));
+   gridSigmas[ nDims ] = tonalSigma / sampling[ nDims ];
+   gridSizes[ nDims ] = static_cast< dip::uint >( std::floor(( maxValue - minValue ) / sampling[ nDims ] )) + 2;
+
+   // The grid has two tensor elements: the sum of values and the sum of weights (homogeneous coordinates)
+   Image grid( gridSizes, 2, DT_DFLOAT );
+   grid.Fill( 0 );
+   IntegerArray const& gridStrides = grid.Strides();
+   dip::sint gridTensorStride = grid.TensorStride();
+   dfloat* gridOrigin = static_cast< dfloat* >( grid.Origin() );
+
+   // Splat: nearest neighbor downsampling
+   ImageIterator< dfloat > inIt( in );
+   do {
+      UnsignedArray const& coords = inIt.Coordinates();
+      dip::sint offset = 0;
+      for( dip::uint ii = 0; ii < nDims; ++ii ) {
+         offset += static_cast< dip::sint >( std::round( static_cast< dfloat >( coords[ ii ] ) / sampling[ ii ] )) * gridStrides[ ii ];
+      }
+      dfloat value = *inIt;
+      offset += static_cast< dip::sint >( std::round(( value - minValue ) / sampling[ nDims ] )) * gridStrides[ nDims ];
+      gridOrigin[ offset ] += value;
+      gridOrigin[ offset + gridTensorStride ] += 1.0;
+   } while( ++inIt );
+
+   // Blur: the grid is small, so this is cheap irrespective of the spatial sigma. The grid sigmas are at most
+   // one cell, so the FIR implementation is used; "best" would select the FT implementation for sigmas smaller
+   // than 0.8, which is periodic and would ignore the zero padding
+   Gauss( grid, grid, gridSigmas, { 0 }, "fir", { S::ADD_ZEROS }, truncation );
+
+   // Slice: multi-linear interpolation in the grid at the position given by the estimate
+   dip::uint nCorners = 1u << gridDims;
+   std::vector< dip::sint > cornerOffsets( nCorners, 0 );
+   for( dip::uint jj = 0; jj < nCorners; ++jj ) {
+      for( dip::uint ii = 0; ii < gridDims; ++ii ) {
+         if( jj & ( 1u << ii )) {
+            cornerOffsets[ jj ] += gridStrides[ ii ];
+         }
+      }
+   }
+   FloatArray fraction( gridDims );
+   JointImageIterator< dfloat, dfloat, dfloat > it( { in, estimate, out } );
+   do {
+      UnsignedArray const& coords = it.Coordinates();
+      dip::sint offset = 0;
+      for( dip::uint ii = 0; ii <= nDims; ++ii ) {
+         dfloat pos = ii < nDims
+                      ? static_cast< dfloat >( coords[ ii ] ) / sampling[ ii ]
+                      : ( it.template Sample< 1 >() - minValue ) / sampling[ nDims ];
+         dfloat index = std::floor( pos );
+         fraction[ ii ] = pos - index;
+         offset += static_cast< dip::sint >( index ) * gridStrides[ ii ];
+      }
+      dfloat sum = 0;
+      dfloat norm = 0;
+      for( dip::uint jj = 0; jj < nCorners; ++jj ) {
+         dfloat weight = 1.0;
+         for( dip::uint ii = 0; ii < gridDims; ++ii ) {
+            weight *= ( jj & ( 1u << ii )) ? fraction[ ii ] : 1.0 - fraction[ ii ];
+         }
+         if( weight != 0.0 ) {
+            dfloat const* ptr = gridOrigin + offset + cornerOffsets[ jj ];
+            sum += weight * ptr[ 0 ];
+            norm += weight * ptr[ gridTensorStride ];
+         }
+      }
+      it.template Sample< 2 >() = norm > 0 ? sum / norm : it.template Sample< 0 >();
+   } while( ++it );
+}
+
+// A hash table that maps the integer coordinates of permutohedral lattice points to a set of values
+class PermutohedralHashTable {
+   public:
+      PermutohedralHashTable( dip::uint keySize, dip::uint valueSize ) :
+            keySize_( keySize ), valueSize_( valueSize ), table_( 1024, -1 ) {}
+
+      // Returns the index of the entry for `key`. If it doesn't exist, creates it if `create`,
+      // otherwise returns -1.
+      dip::sint Find( dip::sint const* key, bool create ) {
+         if( create && ( size_ + 1 ) * 2 > table_.size() ) {
+            Grow();
+         }
+         dip::uint mask = table_.size() - 1;
+         dip::uint hh = Hash( key ) & mask;
+         while( true ) {
+            dip::sint entry = table_[ hh ];
+            if( entry < 0 ) {
+               if( !create ) {
+                  return -1;
+               }
+               keys_.insert( keys_.end(), key, key + keySize_ );
+               values_.resize( values_.size() + valueSize_, 0.0 );
+               table_[ hh ] = static_cast< dip::sint >( size_ );
+               return static_cast< dip::sint >( size_++ );
+            }
+            if( std::equal( key, key + keySize_, keys_.data() + static_cast< dip::uint >( entry ) * keySize_ )) {
+               return entry;
+            }
+            hh = ( hh + 1 ) & mask;
+         }
+      }
+
+      dip::uint Size() const { return size_; }
+      dip::sint const* Key( dip::uint index ) const { return keys_.data() + index * keySize_; }
+      dfloat* Value( dip::uint index ) { return values_.data() + index * valueSize_; }
+      void SwapValues( std::vector< dfloat >& values ) {
+         DIP_ASSERT( values.size() == values_.size() );
+         values_.swap( values );
+      }
+
+   private:
+      dip::uint keySize_;
+      dip::uint valueSize_;
+      dip::uint size_ = 0;
+      std::vector< dip::sint > keys_;     // `keySize_` elements per entry
+      std::vector< dfloat > values_;      // `valueSize_` elements per entry
+      std::vector< dip::sint > table_;    // index into entries, -1 for empty; size is a power of 2
+
+      dip::uint Hash( dip::sint const* key ) const {
+         dip::uint hh = 0;
+         for( dip::uint ii = 0; ii < keySize_; ++ii ) {
+            hh += static_cast< dip::uint >( key[ ii ] );
+            hh *= 2531011;
+         }
+         return hh;
+      }
+
+      void Grow() {
+         table_.assign( table_.size() * 2, -1 );
+         dip::uint mask = table_.size() - 1;
+         for( dip::uint entry = 0; entry < size_; ++entry ) {
+            dip::uint hh = Hash( Key( entry )) & mask;
+            while( table_[ hh ] >= 0 ) {
+               hh = ( hh + 1 ) & mask;
+            }
+            table_[ hh ] = static_cast< dip::sint >( entry );
+         }
+      }
+};
+
+// The permutohedral lattice of Adams, Baek and Davis (2010). `positionSize` is the dimensionality of the
+// space the lattice lives in, `valueSize` the number of values stored at each lattice point.
+class PermutohedralLattice {
+   public:
+      PermutohedralLattice( dip::uint positionSize, dip::uint valueSize ) :
+            d_( positionSize ), valueSize_( valueSize ), hashTable_( positionSize, valueSize ),
+            scaleFactor_( positionSize ), canonical_(( positionSize + 1 ) * ( positionSize + 1 )),
+            elevated_( positionSize + 1 ), greedy_( positionSize + 1 ), rank_( positionSize + 1 ),
+            barycentric_( positionSize + 2 ), key_( positionSize ) {
+         dip::sint d = static_cast< dip::sint >( d_ );
+         for( dip::sint ii = 0; ii <= d; ++ii ) {
+            for( dip::sint jj = 0; jj <= d; ++jj ) {
+               canonical_[ static_cast< dip::uint >( ii * ( d + 1 ) + jj ) ] = jj <= d - ii ? ii : ii - d - 1;
+            }
+         }
+         // The blur along each of the d+1 lattice directions is a [1 2 1] kernel. Positions are scaled
+         // such that this corresponds to a Gaussian with unit variance in the input space.
+         dfloat invStdDev = std::sqrt( 2.0 / 3.0 ) * static_cast< dfloat >( d_ + 1 );
+         for( dip::uint ii = 0; ii < d_; ++ii ) {
+            scaleFactor_[ ii ] = invStdDev / std::sqrt( static_cast< dfloat >(( ii + 1 ) * ( ii + 2 )));
+         }
+      }
+
+      // Adds `value` to the vertices of the simplex enclosing `position`.
+      void Splat( dfloat const* position, dfloat const* value ) {
+         ComputeSimplex( position );
+         for( dip::uint rr = 0; rr <= d_; ++rr ) {
+            ComputeKey( rr );
+            dfloat* latticeValue = hashTable_.Value( static_cast< dip::uint >( hashTable_.Find( key_.data(), true )));
+            for( dip::uint kk = 0; kk < valueSize_; ++kk ) {
+               latticeValue[ kk ] += barycentric_[ rr ] * value[ kk ];
+            }
+         }
+      }
+
+      // Blurs the values along each of the lattice directions.
+      void Blur() {
+         dip::uint n = hashTable_.Size();
+         std::vector< dfloat > newValues( n * valueSize_ );
+         std::vector< dip::sint > neighbor1( d_ );
+         std::vector< dip::sint > neighbor2( d_ );
+         dip::sint d = static_cast< dip::sint >( d_ );
+         for( dip::uint jj = 0; jj <= d_; ++jj ) {
+            for( dip::uint ii = 0; ii < n; ++ii ) {
+               dip::sint const* key = hashTable_.Key( ii );
+               for( dip::uint kk = 0; kk < d_; ++kk ) {
+                  neighbor1[ kk ] = key[ kk ] + 1;
+                  neighbor2[ kk ] = key[ kk ] - 1;
+               }
+               if( jj < d_ ) {
+                  neighbor1[ jj ] = key[ jj ] - d;
+                  neighbor2[ jj ] = key[ jj ] + d;
+               }
+               dfloat* newValue = newValues.data() + ii * valueSize_;
+               dfloat const* value = hashTable_.Value( ii );
+               for( dip::uint kk = 0; kk < valueSize_; ++kk ) {
+                  newValue[ kk ] = 0.5 * value[ kk ];
+               }
+               for( dip::sint index : { hashTable_.Find( neighbor1.data(), false ), hashTable_.Find( neighbor2.data(), false ) } ) {
+                  if( index >= 0 ) {
+                     value = hashTable_.Value( static_cast< dip::uint >( index ));
+                     for( dip::uint kk = 0; kk < valueSize_; ++kk ) {
+                        newValue[ kk ] += 0.25 * value[ kk ];
+                     }
+                  }
+               }
+            }
+            hashTable_.SwapValues( newValues );
+         }
+      }
+
+      // Interpolates the lattice values at `position`, writes `valueSize` values to `value`.
+      void Slice( dfloat const* position, dfloat* value ) {
+         ComputeSimplex( position );
+         std::fill( value, value + valueSize_, 0.0 );
+         for( dip::uint rr = 0; rr <= d_; ++rr ) {
+            ComputeKey( rr );
+            dip::sint index = hashTable_.Find( key_.data(), false );
+            if( index >= 0 ) {
+               dfloat const* latticeValue = hashTable_.Value( static_cast< dip::uint >( index ));
+               for( dip::uint kk = 0; kk < valueSize_; ++kk ) {
+                  value[ kk ] += barycentric_[ rr ] * latticeValue[ kk ];
+               }
+            }
+         }
+      }
+
+   private:
+      dip::uint d_;
+      dip::uint valueSize_;
+      PermutohedralHashTable hashTable_;
+      std::vector< dfloat > scaleFactor_;
+      std::vector< dip::sint > canonical_;
+      // Temporary buffers used by `ComputeSimplex`
+      std::vector< dfloat > elevated_;
+      std::vector< dip::sint > greedy_;
+      std::vector< dip::sint > rank_;
+      std::vector< dfloat > barycentric_;
+      std::vector< dip::sint > key_;
+
+      // Finds the simplex enclosing `position`, and the barycentric coordinates within it.
+      void ComputeSimplex( dfloat const* position ) {
+         dip::sint d = static_cast< dip::sint >( d_ );
+         dfloat dp1 = static_cast< dfloat >( d_ + 1 );
+         // Elevate the position onto the hyperplane perpendicular to (1,1,...,1)
+         dfloat sum = 0;
+         for( dip::uint ii = d_; ii > 0; --ii ) {
+            dfloat cf = position[ ii - 1 ] * scaleFactor_[ ii - 1 ];
+            elevated_[ ii ] = sum - static_cast< dfloat >( ii ) * cf;
+            sum += cf;
+         }
+         elevated_[ 0 ] = sum;
+         // Find the closest remainder-0 lattice point
+         dip::sint greedySum = 0;
+         for( dip::uint ii = 0; ii <= d_; ++ii ) {
+            dfloat v = elevated_[ ii ] / dp1;
+            dfloat up = std::ceil( v ) * dp1;
+            dfloat down = std::floor( v ) * dp1;
+            greedy_[ ii ] = static_cast< dip::sint >( up - elevated_[ ii ] < elevated_[ ii ] - down ? up : down );
+            greedySum += greedy_[ ii ];
+         }
+         greedySum /= d + 1;
+         // Rank the differential to this point
+         std::fill( rank_.begin(), rank_.end(), 0 );
+         for( dip::uint ii = 0; ii < d_; ++ii ) {
+            for( dip::uint jj = ii + 1; jj <= d_; ++jj ) {
+               if( elevated_[ ii ] - static_cast< dfloat >( greedy_[ ii ] ) < elevated_[ jj ] - static_cast< dfloat >( greedy_[ jj ] )) {
+                  ++rank_[ ii ];
+               } else {
+                  ++rank_[ jj ];
+               }
+            }
+         }
+         // If the point doesn't lie on the plane, bring it there
+         if( greedySum > 0 ) {
+            for( dip::uint ii = 0; ii <= d_; ++ii ) {
+               if( rank_[ ii ] >= d + 1 - greedySum ) {
+                  greedy_[ ii ] -= d + 1;
+                  rank_[ ii ] += greedySum - d - 1;
+               } else {
+                  rank_[ ii ] += greedySum;
+               }
+            }
+         } else if( greedySum < 0 ) {
+            for( dip::uint ii = 0; ii <= d_; ++ii ) {
+               if( rank_[ ii ] < -greedySum ) {
+                  greedy_[ ii ] += d + 1;
+                  rank_[ ii ] += d + 1 + greedySum;
+               } else {
+                  rank_[ ii ] += greedySum;
+               }
+            }
+         }
+         // Barycentric coordinates
+         std::fill( barycentric_.begin(), barycentric_.end(), 0.0 );
+         for( dip::uint ii = 0; ii <= d_; ++ii ) {
+            dfloat delta = ( elevated_[ ii ] - static_cast< dfloat >( greedy_[ ii ] )) / dp1;
+            barycentric_[ static_cast< dip::uint >( d - rank_[ ii ] ) ] += delta;
+            barycentric_[ static_cast< dip::uint >( d + 1 - rank_[ ii ] ) ] -= delta;
+         }
+         barycentric_[ 0 ] += 1.0 + barycentric_[ d_ + 1 ];
+      }
+
+      // Computes the key for vertex `remainder` of the simplex found by `ComputeSimplex`.
+      void ComputeKey( dip::uint remainder ) {
+         for( dip::uint ii = 0; ii < d_; ++ii ) {
+            key_[ ii ] = greedy_[ ii ] + canonical_[ remainder * ( d_ + 1 ) + static_cast< dip::uint >( rank_[ ii ] ) ];
+         }
+      }
+};
+
+} // End anonymous namespace
+
+void GridBilateralFilter(
+      Image const& in,
+      Image const& optionalEstimate,
+      Image& out,
+      FloatArray spatialSigmas,
+      dfloat tonalSigma,
+      dfloat truncation
+) {
+   // Check input
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( tonalSigma <= 0, E::INVALID_PARAMETER );
+   DIP_THROW_IF( truncation <= 0, E::INVALID_PARAMETER );
+   if( optionalEstimate.IsForged() ) {
+      DIP_STACK_TRACE_THIS( optionalEstimate.CompareProperties(
+            in, Option::CmpPropEnumerator::Sizes + Option::CmpPropEnumerator::TensorElements,
+            Option::ThrowException::DO_THROW ));
+      DIP_THROW_IF( !optionalEstimate.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   }
+   DIP_STACK_TRACE_THIS( ArrayUseParameter( spatialSigmas, in.Dimensionality(), 2.0 ));
+   for( auto s : spatialSigmas ) {
+      DIP_THROW_IF( s < 0, E::INVALID_PARAMETER );
+   }
+
+   DIP_START_STACK_TRACE
+      Image inF = MakeDFloat( in );
+      Image estimate = optionalEstimate.IsForged() ? MakeDFloat( optionalEstimate ) : inF;
+      Image result( in.Sizes(), in.TensorElements(), DT_DFLOAT );
+      for( dip::uint ii = 0; ii < in.TensorElements(); ++ii ) {
+         Image resultElement = result[ ii ];
+         ScalarGridBilateralFilter( inF[ ii ], estimate[ ii ], resultElement, spatialSigmas, tonalSigma, truncation );
+      }
+      WriteBilateralOutput( in, result, out );
+   DIP_END_STACK_TRACE
+}
+
+void LatticeBilateralFilter(
+      Image const& in,
+      Image const& optionalEstimate,
+      Image& out,
+      FloatArray spatialSigmas,
+      dfloat tonalSigma
+) {
+   // Check input
+   DIP_THROW_IF( !in.IsForged(), E::IMAGE_NOT_FORGED );
+   DIP_THROW_IF( !in.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   DIP_THROW_IF( tonalSigma <= 0, E::INVALID_PARAMETER );
+   if( optionalEstimate.IsForged() ) {
+      DIP_STACK_TRACE_THIS( optionalEstimate.CompareProperties(
+            in, Option::CmpPropEnumerator::Sizes + Option::CmpPropEnumerator::TensorElements,
+            Option::ThrowException::DO_THROW ));
+      DIP_THROW_IF( !optionalEstimate.DataType().IsReal(), E::DATA_TYPE_NOT_SUPPORTED );
+   }
+   DIP_STACK_TRACE_THIS( ArrayUseParameter( spatialSigmas, in.Dimensionality(), 2.0 ));
+   for( auto s : spatialSigmas ) {
+      DIP_THROW_IF( s <= 0, E::INVALID_PARAMETER );
+   }
+
+   DIP_START_STACK_TRACE
+      Image inF = MakeDFloat( in );
+      Image estimate = optionalEstimate.IsForged() ? MakeDFloat( optionalEstimate ) : inF;
+      Image result( in.Sizes(), in.TensorElements(), DT_DFLOAT );
+      dip::uint nDims = in.Dimensionality();
+      dip::uint nTensor = in.TensorElements();
+
+      // The lattice position of each pixel is its spatial coordinates and its tensor values, each
+      // scaled by the corresponding sigma. The values stored are the tensor values plus a 1 for
+      // the weight (homogeneous coordinates).
+      PermutohedralLattice lattice( nDims + nTensor, nTensor + 1 );
+      std::vector< dfloat > position( nDims + nTensor );
+      std::vector< dfloat > value( nTensor + 1 );
+      value[ nTensor ] = 1.0;
+      ImageIterator< dfloat > inIt( inF );
+      do {
+         UnsignedArray const& coords = inIt.Coordinates();
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            position[ ii ] = static_cast< dfloat >( coords[ ii ] ) / spatialSigmas[ ii ];
+         }
+         for( dip::uint ii = 0; ii < nTensor; ++ii ) {
+            value[ ii ] = inIt[ ii ];
+            position[ nDims + ii ] = value[ ii ] / tonalSigma;
+         }
+         lattice.Splat( position.data(), value.data() );
+      } while( ++inIt );
+
+      lattice.Blur();
+
+      JointImageIterator< dfloat, dfloat, dfloat > it( { inF, estimate, result } );
+      do {
+         UnsignedArray const& coords = it.Coordinates();
+         for( dip::uint ii = 0; ii < nDims; ++ii ) {
+            position[ ii ] = static_cast< dfloat >( coords[ ii ] ) / spatialSigmas[ ii ];
+         }
+         for( dip::uint ii = 0; ii < nTensor; ++ii ) {
+            position[ nDims + ii ] = it.template Sample< 1 >( ii ) / tonalSigma;
+         }
+         lattice.Slice( position.data(), value.data() );
+         dfloat norm = value[ nTensor ];
+         for( dip::uint ii = 0; ii < nTensor; ++ii ) {
+            it.template Sample< 2 >( ii ) = norm > 0 ? value[ ii ] / norm : it.template Sample< 0 >( ii );
+         }
+      } while( ++it );
+
+      WriteBilateralOutput( in, result, out );
+   DIP_END_STACK_TRACE
+}
+
+
 void BilateralFilter(
       Image const& in,
       Image const& estimate,
@@ -417,9 +897,65 @@ void BilateralFilter(
       DIP_STACK_TRACE_THIS( QuantizedBilateralFilter( in, estimate, out, spatialSigmas, tonalSigma, {}, truncation, boundaryCondition ));
    } else if( method == "xysep" ) {
       DIP_STACK_TRACE_THIS( SeparableBilateralFilter( in, estimate, out, {}, spatialSigmas, tonalSigma, truncation, boundaryCondition ));
+   } else if( method == "grid" ) {
+      DIP_STACK_TRACE_THIS( GridBilateralFilter( in, estimate, out, spatialSigmas, tonalSigma, truncation ));
+   } else if( method == "lattice" ) {
+      DIP_STACK_TRACE_THIS( LatticeBilateralFilter( in, estimate, out, spatialSigmas, tonalSigma ));
    } else {
       DIP_THROW_INVALID_FLAG( method );
    }
 }
 
 } // namespace dip
+
+
+#ifdef DIP__ENABLE_DOCTEST
+#include "doctest.h"
+
+DOCTEST_TEST_CASE("[DIPlib] testing the grid and lattice bilateral filters") {
+   // A step edge should be preserved, and flat regions should remain flat
+   dip::Image in( { 60, 40 }, 1, dip::DT_SFLOAT );
+   in.At( dip::Range{ 0, 29 }, dip::Range{} ) = 10.0;
+   in.At( dip::Range{ 30, -1 }, dip::Range{} ) = 200.0;
+   dip::Image out = dip::GridBilateralFilter( in, {}, { 5.0 }, 20.0 );
+   DOCTEST_CHECK( out.DataType() == dip::DT_SFLOAT );
+   DOCTEST_CHECK( dip::MaximumAbsoluteError( out, in ) < 1e-3 );
+   out = dip::LatticeBilateralFilter( in, {}, { 5.0 }, 20.0 );
+   DOCTEST_CHECK( dip::MaximumAbsoluteError( out, in ) < 1e-3 );
+
+   // Small noise is smoothed, the edge is preserved
+   dip::Image noise( in.Sizes(), 1, dip::DT_SFLOAT );
+   dip::Random random( 0 );
+   dip::GaussianNoise( in, noise, random, 16.0 );
+   out = dip::GridBilateralFilter( noise, {}, { 5.0 }, 20.0 );
+   DOCTEST_CHECK( dip::StandardDeviation( out.At( dip::Range{ 5, 24 }, dip::Range{} )).As< dip::dfloat >() < 1.0 );
+   DOCTEST_CHECK( dip::Mean( out.At( dip::Range{ 0, 29 }, dip::Range{} )).As< dip::dfloat >() == doctest::Approx( 10.0 ).epsilon( 0.02 ));
+   DOCTEST_CHECK( dip::Mean( out.At( dip::Range{ 30, -1 }, dip::Range{} )).As< dip::dfloat >() == doctest::Approx( 200.0 ).epsilon( 0.02 ));
+
+   // Color image: tensor elements are used jointly
+   dip::Image color( in.Sizes(), 3, dip::DT_SFLOAT );
+   color[ 0 ] = in;
+   color[ 1 ] = 255.0 - in;
+   color[ 2 ] = 100.0;
+   dip::GaussianNoise( color, noise, random, 16.0 );
+   out = dip::LatticeBilateralFilter( noise, {}, { 5.0 }, 20.0 );
+   DOCTEST_CHECK( out.TensorElements() == 3 );
+   DOCTEST_CHECK( dip::StandardDeviation( out[ 1 ].At( dip::Range{ 5, 24 }, dip::Range{} )).As< dip::dfloat >() < 1.5 );
+   DOCTEST_CHECK( dip::Mean( out[ 1 ].At( dip::Range{ 30, -1 }, dip::Range{} )).As< dip::dfloat >() == doctest::Approx( 55.0 ).epsilon( 0.05 ));
+}
+
+DOCTEST_TEST_CASE("[DIPlib] testing the tonal range of the bilateral grid") {
+   // A range of 60000 with a tonal sigma of 2 would need 30000 tonal bins, the grid uses 256 instead
+   dip::Image in( { 60, 40 }, 1, dip::DT_UINT16 );
+   in.At( dip::Range{ 0, 29 }, dip::Range{} ) = 1000;
+   in.At( dip::Range{ 30, -1 }, dip::Range{} ) = 61000;
+   dip::Image out = dip::GridBilateralFilter( in, {}, { 5.0 }, 2.0 );
+   DOCTEST_CHECK( dip::MaximumAbsoluteError( out, in ) < 1e-3 );
+   // Infinite values cannot be placed in the grid
+   dip::Image infinite( { 20, 10 }, 1, dip::DT_SFLOAT );
+   infinite.Fill( 1.0 );
+   infinite.At( 5, 5 ) = dip::infinity;
+   DOCTEST_CHECK_THROWS( dip::GridBilateralFilter( infinite, {}, { 2.0 }, 30.0 ));
+}
+
+#endif // DIP__ENABLE_DOCTEST
@@ -25,6 +25,7 @@
 #include "diplib/framework.h"
 #include "diplib/generic_iterators.h"
 #include "diplib/pixel_table.h"
+#include "diplib/multithreading.h"
 #include "diplib/overload.h"
 
 namespace dip {
@@ -112,9 +113,7 @@ void SelectionFilter(
       StringArray const& boundaryCondition
 ) {
    // We are not using a framework here, because this is the only pixel table filter that uses two input images.
-   // So we've copied things over from Framework::Full, and changed (simplified) them a bit. There's no multi-threading
-   // here yet.
-   // TODO: add multithreading.
+   // So we've copied things over from Framework::Full, and changed (simplified) them a bit.
 
    DIP_THROW_IF( !c_in.IsForged() || !c_control.IsForged(), E::IMAGE_NOT_FORGED );
    DIP_THROW_IF( c_in.Sizes() != c_control.Sizes(), E::SIZES_DONT_MATCH );
@@ -170,31 +169,54 @@ void SelectionFilter(
    std::unique_ptr< SelectionLineFilterBase > lineFilter;
    DIP_OVL_NEW_ALL( lineFilter, SelectionLineFilter, (), in.DataType() );
 
-   // Loop over all image lines
-   SelectionLineFilterParameters params = {
-         nullptr,
-         nullptr,
-         nullptr,
-         in.Stride( processingDim ),
-         in.TensorStride(),
-         control.Stride( processingDim ),
-         out.Stride( processingDim ),
-         out.TensorStride(),
-         in.TensorElements(),
-         in.Size( processingDim ),
-         pixelTableOffsets.Offsets(),
-         pixelTableOffsets.Weights(),
-         threshold,
-         minimum
-   };
+   // Collect the start of each image line, so we can divide the lines evenly over the threads
+   std::vector< std::array< dip::sint, 3 >> lineOffsets;
+   lineOffsets.reserve( in.NumberOfPixels() / in.Size( processingDim ));
    GenericJointImageIterator< 3 > it( { in, control, out }, processingDim );
    it.OptimizeAndFlatten();
    do {
-      params.inBuffer = in.Pointer( it.Offset< 0 >() );
-      params.controlBuffer = static_cast< dfloat* >( control.Pointer( it.Offset< 1 >() ));
-      params.outBuffer = out.Pointer( it.Offset< 2 >() );
-      DIP_STACK_TRACE_THIS( lineFilter->Filter( params ));
+      lineOffsets.push_back( {{ it.Offset< 0 >(), it.Offset< 1 >(), it.Offset< 2 >() }} );
    } while( ++it );
+   dip::uint nLines = lineOffsets.size();
+
+   // Determine the number of threads we'll be using
+   dip::uint nThreads = std::min( GetNumberOfThreads(), nLines );
+   if( nThreads > 1 ) {
+      dip::uint operations = in.NumberOfPixels() * ( 4 * pixelTableOffsets.NumberOfPixels() + in.TensorElements() );
+      // Starting threads is only worth while if we'll do at least `threadingThreshold` operations
+      if( operations < threadingThreshold ) {
+         nThreads = 1;
+      }
+   }
+
+   // Loop over all image lines, each thread processes a contiguous set of lines with its own parameter struct
+   #pragma omp parallel num_threads( static_cast< int >( nThreads ))
+   {
+      SelectionLineFilterParameters params = {
+            nullptr,
+            nullptr,
+            nullptr,
+            in.Stride( processingDim ),
+            in.TensorStride(),
+            control.Stride( processingDim ),
+            out.Stride( processingDim ),
+            out.TensorStride(),
+            in.TensorElements(),
+            in.Size( processingDim ),
+            pixelTableOffsets.Offsets(),
+            pixelTableOffsets.Weights(),
+            threshold,
+            minimum
+      };
+      #pragma omp for schedule( static )
+      for( dip::sint ii = 0; ii < static_cast< dip::sint >( nLines ); ++ii ) {
+         auto const& offsets = lineOffsets[ static_cast< dip::uint >( ii ) ];
+         params.inBuffer = in.Pointer( offsets[ 0 ] );
+         params.controlBuffer = static_cast< dfloat* >( control.Pointer( offsets[ 1 ] ));
+         params.outBuffer = out.Pointer( offsets[ 2 ] );
+         lineFilter->Filter( params ); // Doesn't throw
+      }
+   }
 }
 
 void Kuwahara(
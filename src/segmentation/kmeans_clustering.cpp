@@ -23,6 +23,7 @@
 #include "diplib/framework.h"
 #include "diplib/overload.h"
 #include "diplib/random.h"
+#include "sparse_points.h"
 
 namespace dip {
 
@@ -102,6 +103,33 @@ class dip__Clustering : public Framework::ScanLineFilter {
       ClusterArray& clusters_;
 };
 
+// Moves the cluster means to the new means, returns the squared distance moved
+dfloat UpdateClusters(
+      ClusterArray& clusters
+) {
+   dfloat change = 0;
+   dfloat maxval = 0;
+   //std::cout << "Cluster means: ";
+   for( auto& c : clusters ) {
+      if( c.norm != 0.0 ) {
+         for( dip::uint jj = 0; jj < c.mean.size(); jj++ ) {
+            dfloat val = c.newMean[ jj ] / c.norm;
+            maxval = std::max( std::abs( val ), maxval );
+            dfloat dist = val - c.mean[ jj ];
+            change += dist * dist;
+            c.mean[ jj ] = val;
+            c.newMean[ jj ] = 0.0;
+         }
+      } else {
+         std::fill( c.newMean.begin(), c.newMean.end(), 0.0 );
+      }
+      c.norm = 0.0;
+      //std::cout << c.mean << " ; ";
+   }
+   //std::cout << "change = " << change << '\n';
+   return change <= 1e-10 * maxval ? 0.0 : change;
+}
+
 dfloat Clustering(
       Image const& in,
       Image& out,
@@ -137,29 +165,39 @@ dfloat Clustering(
                                           Framework::ScanOption::NeedCoordinates + Framework::ScanOption::NoMultiThreading ));
 
    // Process cluster information
-   dfloat change = 0;
-   dfloat maxval = 0;
-   if( !write ) {
-      //std::cout << "Cluster means: ";
-      for( auto& c : clusters ) {
-         if( c.norm != 0.0 ) {
-            for( dip::uint jj = 0; jj < c.mean.size(); jj++ ) {
-               dfloat val = c.newMean[ jj ] / c.norm;
-               maxval = std::max( std::abs( val ), maxval );
-               dfloat dist = val - c.mean[ jj ];
-               change += dist * dist;
-               c.mean[ jj ] = val;
-               c.newMean[ jj ] = 0.0;
-            }
-         } else {
-            std::fill( c.newMean.begin(), c.newMean.end(), 0.0 );
+   return write ? 0.0 : UpdateClusters( clusters );
+}
+
+// Same as `Clustering` with `write` set to false, but using only the non-zero pixels
+dfloat SparseClustering(
+      SparsePoints const& points,
+      ClusterArray& clusters
+) {
+   dip::uint nDims = points.nDims;
+   for( dip::uint ii = 0; ii < points.Size(); ++ii ) {
+      dip::uint const* coords = points.Coordinates( ii );
+      // Find the nearest cluster center
+      dip::uint nearest = 0;
+      dfloat nearestDist = std::numeric_limits< dfloat >::max();
+      for( dip::uint jj = 0; jj < clusters.size(); ++jj ) {
+         dfloat dist = 0.0;
+         for( dip::uint kk = 0; kk < nDims; ++kk ) {
+            dfloat d = clusters[ jj ].mean[ kk ] - static_cast< dfloat >( coords[ kk ] );
+            dist += d * d;
          }
-         c.norm = 0.0;
-         //std::cout << c.mean << " ; ";
+         if( dist < nearestDist ) {
+            nearest = jj;
+            nearestDist = dist;
+         }
+      }
+      // Update the new mean of nearest mean
+      dfloat weight = points.weights[ ii ];
+      for( dip::uint kk = 0; kk < nDims; ++kk ) {
+         clusters[ nearest ].newMean[ kk ] += weight * static_cast< dfloat >( coords[ kk ] );
       }
-      //std::cout << "change = " << change << '\n';
+      clusters[ nearest ].norm += weight;
    }
-   return change <= 1e-10 * maxval ? 0.0 : change;
+   return UpdateClusters( clusters );
 }
 
 void LabelClusters(
@@ -188,6 +226,7 @@ void LabelClusters(
 CoordinateArray KMeansClustering(
       Image const& in,
       Image& out,
+      Random& random,
       dip::uint nClusters
 ) {
    // Check the image
@@ -202,7 +241,6 @@ CoordinateArray KMeansClustering(
    ClusterArray clusters( nClusters, Cluster( nDims ));
 
    // Randomly initialise the clusters
-   Random random;
    UniformRandomGenerator generator( random );
    for( auto& cluster : clusters ) {
       for( dip::uint jj = 0; jj < nDims; ++jj ) {
@@ -210,8 +248,14 @@ CoordinateArray KMeansClustering(
       }
    }
 
-   // Do cluster iterations
-   while( Clustering( in, out, clusters, false ) > 0.0 ) {};
+   // Do cluster iterations. If most pixels are zero (e.g. for a multi-dimensional histogram), we iterate
+   // over the list of non-zero pixels instead of over the image.
+   SparsePoints points;
+   if( GatherSparsePoints( in, points )) {
+      while( SparseClustering( points, clusters ) > 0.0 ) {};
+   } else {
+      while( Clustering( in, out, clusters, false ) > 0.0 ) {};
+   }
    LabelClusters( clusters );
    Clustering( in, out, clusters, true );
 
@@ -224,4 +268,13 @@ CoordinateArray KMeansClustering(
    return coords;
 }
 
+CoordinateArray KMeansClustering(
+      Image const& in,
+      Image& out,
+      dip::uint nClusters
+) {
+   Random random;
+   return KMeansClustering( in, out, random, nClusters );
+}
+
 } // namespace dip
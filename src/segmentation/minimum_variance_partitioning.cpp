@@ -19,6 +19,7 @@
  */
 
 #include <queue>
+#include <numeric>
 
 #include "diplib.h"
 #include "diplib/segmentation.h"
@@ -27,6 +28,7 @@
 #include "diplib/framework.h"
 #include "diplib/overload.h"
 #include "diplib/random.h"
+#include "sparse_points.h"
 
 /* Algorithm:
   - Compute Sum() projections.
@@ -78,6 +80,29 @@ ProjectionArray ComputeSumProjections(
    return out;
 }
 
+// Same as `ComputeSumProjections`, but using only the non-zero pixels listed in `indices`
+ProjectionArray ComputeSparseSumProjections(
+      SparsePoints const& points,
+      std::vector< dip::uint > const& indices,
+      UnsignedArray const& leftEdges,
+      UnsignedArray const& rightEdges
+) {
+   dip::uint nDims = points.nDims;
+   ProjectionArray out( nDims );
+   for( dip::uint dim = 0; dim < nDims; ++dim ) {
+      DIP_ASSERT( leftEdges[ dim ] <= rightEdges[ dim ] );
+      out[ dim ].assign( rightEdges[ dim ] - leftEdges[ dim ] + 1, 0 );
+   }
+   for( dip::uint index : indices ) {
+      dip::uint const* coords = points.Coordinates( index );
+      ProjectionType weight = static_cast< ProjectionType >( points.weights[ index ] );
+      for( dip::uint dim = 0; dim < nDims; ++dim ) {
+         out[ dim ][ coords[ dim ] - leftEdges[ dim ]] += weight;
+      }
+   }
+   return out;
+}
+
 class KDTree {
    private:
 
@@ -92,17 +117,32 @@ class KDTree {
          dfloat splitVariances;     // sum of variances along optimalDim if split
          Image const& image;
          ComputeSumProjectionsFunction* computeSumProjections;
+         SparsePoints const* points = nullptr; // if not null, `image` is represented by these non-zero pixels
+         std::vector< dip::uint > indices;     // indices into `points` of the pixels within this partition
 
          explicit Partition( Image const& img ) : image( img ) {}
 
-         void SetRootPartition() {
+         void SetRootPartition( SparsePoints const* sparsePoints ) {
             nPixels = image.NumberOfPixels();
             dip::uint nDims = image.Dimensionality();
             leftEdges.resize( nDims, 0 );
             rightEdges = image.Sizes();
             rightEdges -= 1;
             DIP_OVL_ASSIGN_NONCOMPLEX( computeSumProjections, ComputeSumProjections, image.DataType() );
-            FindOptimalSplit( computeSumProjections( image, leftEdges, rightEdges ));
+            points = sparsePoints;
+            if( points ) {
+               indices.resize( points->Size() );
+               std::iota( indices.begin(), indices.end(), 0 );
+            }
+            FindOptimalSplit( ComputeProjections() );
+         }
+
+         // Computes the projections of the pixels within this partition
+         ProjectionArray ComputeProjections() const {
+            if( points ) {
+               return ComputeSparseSumProjections( *points, indices, leftEdges, rightEdges );
+            }
+            return computeSumProjections( image, leftEdges, rightEdges );
          }
 
          // Computes optimal split for this partition
@@ -131,8 +171,18 @@ class KDTree {
             other.rightEdges = rightEdges;
             rightEdges[ optimalDim ] = threshold;
             other.computeSumProjections = computeSumProjections;
-            FindOptimalSplit( computeSumProjections( image, leftEdges, rightEdges ));
-            other.FindOptimalSplit( computeSumProjections( other.image, other.leftEdges, other.rightEdges ));
+            other.points = points;
+            if( points ) {
+               dip::uint dim = optimalDim;
+               dip::uint thresh = threshold;
+               auto middle = std::partition( indices.begin(), indices.end(), [ & ]( dip::uint index ) {
+                  return points->Coordinates( index )[ dim ] <= thresh;
+               } );
+               other.indices.assign( middle, indices.end() );
+               indices.erase( middle, indices.end() );
+            }
+            FindOptimalSplit( ComputeProjections() );
+            other.FindOptimalSplit( other.ComputeProjections() );
          }
 
          // Computes the mean, variance, and threshold for dimension `dim`. If this split is better than the
@@ -268,13 +318,14 @@ class KDTree {
 
    public:
       // Create the tree
-      KDTree( Image const& img, dip::uint nClusters ) : image( img ) {
+      // If `points` is not null, it lists the non-zero pixels of `img`, and is used instead of `img`
+      KDTree( Image const& img, dip::uint nClusters, SparsePoints const* points = nullptr ) : image( img ) {
          DIP_ASSERT( img.IsForged() );
          DIP_ASSERT( img.IsScalar() );
          // Create root node
          nodes.emplace_back( ++lastLabel );
          nodes[ 0 ].partition = std::make_unique< Partition >( img );
-         nodes[ 0 ].partition->SetRootPartition();
+         nodes[ 0 ].partition->SetRootPartition( points );
          // Create queue
          auto ComparePartitions = [ & ]( dip::uint lhsIndex, dip::uint rhsIndex ) {
             // Implements lhs < rhs
@@ -363,7 +414,11 @@ CoordinateArray MinimumVariancePartitioning(
    DIP_THROW_IF( in.DataType().IsComplex(), E::DATA_TYPE_NOT_SUPPORTED );
    DIP_THROW_IF( nClusters < 2, "Number of clusters must be 2 or larger" );
    DIP_THROW_IF( nClusters > std::numeric_limits< LabelType >::max(), "Number of clusters is too large" );
-   KDTree clusters( in, nClusters );
+   // If most pixels are zero (e.g. for a multi-dimensional histogram), the projections are computed from
+   // the list of non-zero pixels instead of from the image.
+   SparsePoints points;
+   bool sparse = GatherSparsePoints( in, points );
+   KDTree clusters( in, nClusters, sparse ? &points : nullptr );
    out.ReForge( in, DT_LABEL );
    PaintClusters( out, clusters );
    return clusters.Centroids();
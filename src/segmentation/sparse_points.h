@@ -0,0 +1,73 @@
+/*
+ * DIPlib 3.0
+ * This file contains support for the clustering algorithms working on sparse images.
+ *
+ * (c)2026, DIPlib contributors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIP_SPARSE_POINTS_H
+#define DIP_SPARSE_POINTS_H
+
+#include "diplib.h"
+#include "diplib/iterators.h"
+#include "diplib/overload.h"
+
+namespace dip {
+namespace {
+
+// The non-zero pixels of an image, with their coordinates. The clustering algorithms use this instead of
+// the image when most pixels are zero, as is typical for multi-dimensional histograms.
+struct SparsePoints {
+   dip::uint nDims = 0;
+   std::vector< dip::uint > coordinates; // `nDims` values per point
+   std::vector< dfloat > weights;        // the pixel value at each point
+
+   dip::uint Size() const { return weights.size(); }
+   dip::uint const* Coordinates( dip::uint index ) const { return coordinates.data() + index * nDims; }
+};
+
+template< typename TPI >
+bool GatherSparsePoints( Image const& in, SparsePoints& points, dip::uint maxPoints ) {
+   ImageIterator< TPI > it( in );
+   do {
+      if( *it != TPI( 0 )) {
+         if( points.Size() >= maxPoints ) {
+            return false;
+         }
+         points.weights.push_back( static_cast< dfloat >( *it ));
+         for( auto c : it.Coordinates() ) {
+            points.coordinates.push_back( c );
+         }
+      }
+   } while( ++it );
+   return true;
+}
+
+// Fills `points` with the non-zero pixels of the scalar image `in`. Returns false if more than a quarter of
+// the pixels are non-zero, in which case `points` is incomplete, and iterating over the image is cheaper.
+inline bool GatherSparsePoints( Image const& in, SparsePoints& points ) {
+   points.nDims = in.Dimensionality();
+   points.coordinates.clear();
+   points.weights.clear();
+   dip::uint maxPoints = in.NumberOfPixels() / 4;
+   bool sparse = false;
+   DIP_OVL_CALL_ASSIGN_NONCOMPLEX( sparse, GatherSparsePoints, ( in, points, maxPoints ), in.DataType() );
+   return sparse;
+}
+
+} // namespace
+} // namespace dip
+
+#endif // DIP_SPARSE_POINTS_H
@@ -21,6 +21,7 @@
 #define DIP_VIEWER_SLICE_H
 
 #include <thread>
+#include <map>
 
 #include "diplib/color.h"
 
@@ -48,21 +49,35 @@ class DIPVIEWER_CLASS_EXPORT SliceView : public View
     dip::uint dimx_, dimy_;      ///< Indices in options.dims_.             
     unsigned int texture_;       ///< OpenGL texture identifier.
     bool dirty_;                 ///< Texture needs to be rebuilt.
+    dip::uint level_;            ///< Pyramid level of projected_.
+    dip::uint map_level_;        ///< Pyramid level of colored_.
+    dip::uint texture_level_;    ///< Pyramid level of the texture.
+    dip::UnsignedArray sizes_;   ///< Full-resolution sizes of the view.
 
   public:
-    SliceView(ViewPort *viewport, dip::uint dimx, dip::uint dimy) : View(viewport), dimx_(dimx), dimy_(dimy), texture_(0), dirty_(true) { }
+    SliceView(ViewPort *viewport, dip::uint dimx, dip::uint dimy) : View(viewport), dimx_(dimx), dimy_(dimy), texture_(0), dirty_(true), level_(0), map_level_(0), texture_level_(0) { }
 
-    DIPVIEWER_EXPORT void project();
-    DIPVIEWER_EXPORT void map();
+    /// \brief Projects the image for this view, using the given pyramid level.
+    ///
+    /// Level 0 is the full-resolution image. Views that show a 1D line are always projected at level 0.
+    DIPVIEWER_EXPORT void project(dip::uint level = 0);
+    /// \brief Maps the projection for this view to RGB.
+    ///
+    /// If `level` is coarser than the level of the projection, a subsampled view of the projection is mapped.
+    DIPVIEWER_EXPORT void map(dip::uint level = 0);
     DIPVIEWER_EXPORT void rebuild();
     DIPVIEWER_EXPORT void render();
     dip::uint size(dip::uint ii)
     {
+      if (map_level_)
+        return sizes_[ii];
       return colored_.Size(ii);
     }
     
     dip::uint dimx() { return dimx_; }
     dip::uint dimy() { return dimy_; }
+    dip::uint level() { return map_level_; }           ///< Pyramid level of the displayed view.
+    dip::uint projectionLevel() { return level_; }    ///< Pyramid level of the projection.
 };
 
 class DIPVIEWER_CLASS_EXPORT SliceViewPort : public ViewPort
@@ -114,6 +129,8 @@ class DIPVIEWER_CLASS_EXPORT SliceViewer : public Viewer
     ViewPort *drag_viewport_;
     int drag_button_;
     int refresh_seq_;
+
+    std::map<dip::uint, dip::Image> pyramid_; ///< Subsampled versions of image_, by level, built when first needed.
   
   public:
     /// \brief Construct a new SliceViewer.
@@ -157,6 +174,12 @@ class DIPVIEWER_CLASS_EXPORT SliceViewer : public Viewer
     ViewingOptions &options() override { return options_; }
     const dip::Image &image() override { return image_; }
     void setImage(const dip::Image &image) override { original_ = image; refresh_seq_++; }
+
+    /// \brief Returns the image subsampled by a factor 2^`level` along each dimension.
+    ///
+    /// Level 0 is the image itself. Other levels are computed the first time they are requested, and kept
+    /// until the image changes. Only call this from the texture calculation thread.
+    DIPVIEWER_EXPORT const dip::Image &pyramid(dip::uint level);
     
     /// \brief Update linked viewers.
     ///
@@ -175,6 +198,7 @@ class DIPVIEWER_CLASS_EXPORT SliceViewer : public Viewer
     DIPVIEWER_EXPORT void place();
     DIPVIEWER_EXPORT ViewPort *viewport(int x, int y);
     DIPVIEWER_EXPORT void calculateTextures();
+    DIPVIEWER_EXPORT dip::uint coarseLevel();
 };
 
 /// \}
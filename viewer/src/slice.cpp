@@ -36,13 +36,25 @@
 
 namespace dip { namespace viewer {
 
-void SliceView::project()
+void SliceView::project(dip::uint level)
 {
   auto &o = viewport()->viewer()->options();
-  Image image = viewport()->viewer()->image();
   
   dip::sint dx = o.dims_[dimx_], dy = o.dims_[dimy_];
   
+  // Lines are cheap to compute at full resolution
+  if (dx == -1 || dy == -1)
+    level = 0;
+  
+  // The views always live in a SliceViewer
+  Image image = static_cast<SliceViewer*>(viewport()->viewer())->pyramid(level);
+  if (dx != -1 && dy != -1)
+  {
+    Image const &full = viewport()->viewer()->image();
+    sizes_ = { full.Size((dip::uint)dx), full.Size((dip::uint)dy) };
+  }
+  level_ = level;
+  
   if (o.projection_ == ViewingOptions::Projection::None)
   {
     // Extraction
@@ -50,7 +62,7 @@ void SliceView::project()
     
     for (size_t ii=0; ii < range.size(); ++ii)
       if ((int)ii != dx && (int)ii != dy)
-        range[ii] = Range((dip::sint)o.operating_point_[ii]);
+        range[ii] = Range((dip::sint)(o.operating_point_[ii] >> level));
         
     projected_ = image.At(std::move(range));
   }
@@ -61,6 +73,17 @@ void SliceView::project()
     dip::UnsignedArray ro = o.roi_origin_;
     dip::UnsignedArray rs = o.roi_sizes_;
     
+    if (level)
+    {
+      // Map ROI onto the pyramid level, making sure it contains at least one pixel
+      for (size_t ii=0; ii < ro.size(); ++ii)
+      {
+        dip::uint end = std::min((ro[ii] + rs[ii] + (1u << level) - 1) >> level, image.Size(ii));
+        ro[ii] = std::min(ro[ii] >> level, image.Size(ii) - 1);
+        rs[ii] = std::max(end, ro[ii] + 1) - ro[ii];
+      }
+    }
+    
     if (dx != -1)
     {
       process[ (dip::uint)dx ] = false;
@@ -100,22 +123,33 @@ void SliceView::project()
   map();
 }
 
-void SliceView::map()
+void SliceView::map(dip::uint level)
 {
   auto &o = viewport()->viewer()->options();
   
   dirty_ = true;
   
-  if (projected_.Dimensionality() == 0)
+  // A projection at a finer level than requested is previewed by mapping a subsampled view of it,
+  // which is much cheaper than mapping the whole projection
+  Image projected = projected_;
+  map_level_ = level_;
+  if (level > level_ && projected_.Dimensionality() == 2)
+  {
+    dip::uint step = 1u << (level - level_);
+    projected = projected_.At(Range(0, -1, step), Range(0, -1, step));
+    map_level_ = level;
+  }
+  
+  if (projected.Dimensionality() == 0)
   {
     // Point data
-    ApplyViewerColorMap(projected_, colored_, o);
+    ApplyViewerColorMap(projected, colored_, o);
   }
-  else if (projected_.Dimensionality() == 1)
+  else if (projected.Dimensionality() == 1)
   {
     // Line data
     Image line;
-    line = Image({projected_.Size(0), 100}, 3, DT_UINT8);
+    line = Image({projected.Size(0), 100}, 3, DT_UINT8);
     line.Fill(0);
     
     dip::uint width = line.Size(0);
@@ -123,7 +157,7 @@ void SliceView::map()
     dip::uint ystride = (dip::uint)line.Stride(1);
     dip::uint8 *col = (dip::uint8*)line.Origin();
     
-    GenericImageIterator<> it(projected_);
+    GenericImageIterator<> it(projected);
     for( dip::uint ii = 0; ii < width; ++ii, ++it, col += xstride)
     {
       if (o.lut_ == ViewingOptions::LookupTable::RGB)
@@ -161,12 +195,12 @@ void SliceView::map()
     // Image data
     if (o.lut_ == ViewingOptions::LookupTable::ColorSpace)
     {
-      csm_.Convert(projected_, colored_, "RGB");
+      csm_.Convert(projected, colored_, "RGB");
       colored_.Convert(dip::DT_UINT8);
       colored_.ForceNormalStrides();
     } 
     else
-      ApplyViewerColorMap(projected_, colored_, o);
+      ApplyViewerColorMap(projected, colored_, o);
   }
 }
 
@@ -190,7 +224,10 @@ void SliceView::rebuild()
   glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
   
   if (colored_.IsForged() && colored_.HasContiguousData())
+  {
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, (GLsizei)colored_.Size(0), (GLsizei)colored_.Size(1), 0, GL_RGB, GL_UNSIGNED_BYTE, colored_.Origin());
+    texture_level_ = map_level_;
+  }
 }
 
 void SliceView::render()
@@ -210,6 +247,10 @@ void SliceView::render()
     return;
   }
   
+  // A coarse pyramid level is stretched to cover the full-resolution image
+  width <<= texture_level_;
+  height <<= texture_level_;
+  
   glBegin(GL_QUADS);
     glTexCoord2d(0.0,0.0); glVertex2i(0, 0);
     glTexCoord2d(1.0,0.0); glVertex2i(width, 0);
@@ -821,10 +862,42 @@ ViewPort *SliceViewer::viewport(int x, int y)
   return NULL;
 }
 
+const dip::Image &SliceViewer::pyramid(dip::uint level)
+{
+  if (level == 0)
+    return image_;
+    
+  auto it = pyramid_.find(level);
+  if (it != pyramid_.end())
+    return it->second;
+    
+  // Subsample the full-resolution image, the copy makes further accesses cache friendly
+  RangeArray range(image_.Dimensionality(), Range(0, -1, 1u << level));
+  Image view = image_.At(std::move(range));
+  return pyramid_[level] = view.Copy();
+}
+
+dip::uint SliceViewer::coarseLevel()
+{
+  // Images larger than this are first shown at a coarser level
+  const dip::uint maxPixels = 1u << 22;
+  
+  dip::uint level = 0;
+  dip::UnsignedArray sizes = image_.Sizes();
+  while (sizes.product() > maxPixels)
+  {
+    for (auto &sz : sizes)
+      sz = (sz + 1) / 2;
+    ++level;
+  }
+  return level;
+}
+
 void SliceViewer::calculateTextures()
 {
   ViewingOptions options, old_options;
   int seq = -1;
+  auto last_change = std::chrono::steady_clock::now();
 
   while (continue_)
   {
@@ -889,6 +962,7 @@ void SliceViewer::calculateTextures()
       lock();
       image_ = image;
       original_ = original;
+      pyramid_.clear();
       options_.range_ = range;
       options_.tensor_range_ = tensor_range;
 
@@ -905,23 +979,44 @@ void SliceViewer::calculateTextures()
       histogram_->calculate();
     }
     
+    // For large images, views are first computed from a coarse pyramid level, and refined once the
+    // options have not changed for a while. This keeps interaction responsive.
+    dip::uint level = coarseLevel();
+    SliceView *views[] = { main_->view(), left_->view(), top_->view() };
+    
     if (diff >= ViewingOptions::Diff::Projection)
     {
       // Need to reproject
-      if (old_options.needsReproject(options, main_->view()->dimx(), main_->view()->dimy()) || diff >= ViewingOptions::Diff::Complex)
-        main_->view()->project();
-      if (old_options.needsReproject(options, left_->view()->dimx(), left_->view()->dimy()) || diff >= ViewingOptions::Diff::Complex)
-        left_->view()->project();
-      if (old_options.needsReproject(options, top_->view()->dimx(), top_->view()->dimy()) || diff >= ViewingOptions::Diff::Complex)
-        top_->view()->project();
+      for (auto view : views)
+        if (old_options.needsReproject(options, view->dimx(), view->dimy()) || diff >= ViewingOptions::Diff::Complex)
+          view->project(level);
     }
     
     if (diff == ViewingOptions::Diff::Mapping)
     {
-      // Need to remap
-      main_->view()->map();
-      left_->view()->map();
-      top_->view()->map();
+      // Need to remap. The projections are kept, a full-resolution projection is first mapped at the
+      // coarse level.
+      for (auto view : views)
+        view->map(level);
+    }
+    
+    bool coarse = false;
+    for (auto view : views)
+      coarse |= view->level() > 0;
+    
+    if (diff != ViewingOptions::Diff::None)
+      last_change = std::chrono::steady_clock::now();
+    else if (coarse && std::chrono::steady_clock::now() - last_change > std::chrono::milliseconds(100))
+    {
+      // Options have been stable for a while, compute the full-resolution views. Only views whose
+      // projection itself is coarse need to be projected again, the others only need to be mapped.
+      for (auto view : views)
+        if (view->projectionLevel())
+          view->project();
+        else if (view->level())
+          view->map();
+      updated_ = true;
+      refresh();
     }
     
     if (diff >= ViewingOptions::Diff::Place)